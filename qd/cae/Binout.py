@@ -452,7 +452,7 @@ class Binout:
         else:
             return string
 
-    def save_hdf5(self, filepath, compression="gzip"):
+    def save_hdf5(self, filepath, compression="gzip", native=False, n_threads=0):
         ''' Save a binout as HDF5
 
         Parameters
@@ -461,16 +461,66 @@ class Binout:
             path where the HDF5 shall be saved
         compression : str
             compression technique (see h5py docs)
+        native : bool
+            use the C++ exporter, which is much faster. It requires the
+            C++ extension to be compiled with HDF5 and a single binout
+            file. Only "gzip" or None are supported as compression.
+        n_threads : int
+            compression threads of the C++ exporter, 0 uses all cores
+
+        Notes
+        -----
+            The C++ exporter keeps the directory tree of the binout:
+            metadata stays in a "metadata" group and the states of a
+            directory are merged into datasets of shape (nStates, length),
+            e.g. "nodout/x_displacement".
 
         Examples
         --------
             >>> binout = Binout("path/to/binout")
             >>> binout.save_hdf5("path/to/binout.h5")
+            >>> # fast export for big files
+            >>> binout.save_hdf5("path/to/binout.h5", native=True)
         '''
 
+        if native:
+            self._save_hdf5_native(filepath, compression, n_threads)
+            return
+
         with h5py.File(filepath, "w") as fh:
             self._save_all_variables(fh, compression)
 
+    def _save_hdf5_native(self, filepath, compression, n_threads):
+        ''' Save a binout as HDF5 with the C++ exporter
+
+        Parameters
+        ----------
+        filepath : str
+            path where the HDF5 shall be saved
+        compression : str
+            "gzip" or None
+        n_threads : int
+            compression threads, 0 uses all cores
+        '''
+
+        from .dyna_cpp import QD_Binout
+
+        if not hasattr(QD_Binout, "save_hdf5"):
+            raise RuntimeError(
+                "The C++ extension was compiled without HDF5.")
+        if len(self.filelist) != 1:
+            raise ValueError(
+                "The native export supports only a single binout file.")
+        if compression not in ("gzip", None):
+            raise ValueError(
+                "The native export supports only gzip compression.")
+
+        compression_level = 4 if compression == "gzip" else 0
+        binout = QD_Binout(self.filelist[0])
+        binout.save_hdf5(filepath,
+                         compression_level=compression_level,
+                         n_threads=n_threads)
+
     def _save_all_variables(self, hdf5_grp, compression, *path):
         ''' Iterates through all variables in the Binout
 
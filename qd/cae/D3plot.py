@@ -1,7 +1,7 @@
 
 
-from ._dyna_utils import plot_parts, _parse_element_result, _extract_elem_coords
-from .dyna_cpp import QD_D3plot, QD_Part
+from ._dyna_utils import plot_parts, _parse_element_result, _extract_elem_coords, _extract_elem_data
+from .dyna_cpp import QD_D3plot, QD_Part, Element
 
 import os
 import numpy as np
@@ -26,7 +26,8 @@ class D3plot(QD_D3plot):
         element_result : str or function(element)
             element results to compare. Either specify a user defined
             function or use predefined results. Available are
-            disp, plastic_strain or energy.
+            plastic_strain or energy, which are taken at the last
+            timestep for all elements of a part at once.
         pid_filter_list : list(int)
             list of pids to filter for optionally
         kMappingNeighbors : int
@@ -78,17 +79,22 @@ class D3plot(QD_D3plot):
         assert kMappingNeighbors > 0
 
         # prepare evaluation
-        read_vars_str, eval_function = _parse_element_result(element_result)
+        read_vars_str, _ = _parse_element_result(element_result)
         if read_vars_str != None:
             kwargs['read_states'] = read_vars_str
 
+        def extract(parts):
+            coords = _extract_elem_coords(parts, element_type=Element.shell)
+            results = np.concatenate(
+                [_extract_elem_data(part, -1, element_result, Element.shell)
+                 for part in parts])
+            return coords, results
+
         # base run element coords
         if not pid_filter_list:
             pid_filter_list = [part.get_id() for part in self.get_parts()]
-        base_mesh_coords, base_mesh_results = _extract_elem_coords(
-            self.get_partByID(pid_filter_list),
-            element_result=eval_function,
-            element_type="shell")
+        base_mesh_coords, base_mesh_results = extract(
+            self.get_partByID(pid_filter_list))
 
         # init vars for comparison
         element_result_max = base_mesh_results
@@ -100,11 +106,8 @@ class D3plot(QD_D3plot):
 
             # new mesh with results
             _d3plot = D3plot(_filepath, **kwargs)
-            _d3plot_elem_coords, _d3plot_elem_results = _extract_elem_coords(
-                _d3plot.get_partByID(pid_filter_list),
-                element_result=eval_function,
-                iTimestep=0,
-                element_type="shell")
+            _d3plot_elem_coords, _d3plot_elem_results = extract(
+                _d3plot.get_partByID(pid_filter_list))
             del _d3plot  # deallocate c++ stuff
 
             # compute mapping
@@ -122,9 +125,9 @@ class D3plot(QD_D3plot):
                 distances * _d3plot_elem_results[mapping_indexes], axis=1)
 
             # update min and max
-            element_result_max = np.max(
+            element_result_max = np.maximum(
                 _d3plot_elem_results, element_result_max)
-            element_result_min = np.min(
+            element_result_min = np.minimum(
                 _d3plot_elem_results, element_result_min)
 
         # compute scatter
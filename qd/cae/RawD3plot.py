@@ -85,6 +85,10 @@ class RawD3plot(QD_RawD3plot):
         data : np.ndarray or list
             data array or list
 
+        Notes
+        -----
+            Arrays share memory with the raw d3plot, no copy is made.
+
         Raises
         ------
         ValueError
@@ -204,8 +208,7 @@ class RawD3plot(QD_RawD3plot):
             if "int_data" in fh:
                 dataset_counter += 1
                 for name, data in fh["int_data"].items():
-                    data = np.array(data[:], copy=True)
-                    self._set_int_data(name, data)
+                    self._set_int_data(name, data[:])
 
             if "float_data" in fh:
                 dataset_counter += 1
@@ -86,15 +86,15 @@ def _parse_element_result(arg, iTimestep=-1):
             "Unknown result type: %s, Try plastic_strain, energy or disp." % arg)
 
 
-def _extract_elem_coords(parts, element_result=None, iTimestep=0, element_type=None):
+def _extract_elem_coords(parts, element_result=None, iTimestep=0, element_type=Element.none):
     '''Extract the coordinates of the elements
 
     Parameters
     ----------
     parts : list(Part)
         list of parts of which to extract the coordinates
-    element_result : function
-        element evaluation function
+    element_result : str or function
+        element result, see _extract_elem_data
     iTimestep : int
         timestep at which to take the coordinates
     element_type : Element.type
@@ -108,53 +108,46 @@ def _extract_elem_coords(parts, element_result=None, iTimestep=0, element_type=N
 
     # checks
     assert all(isinstance(entry, QD_Part) for entry in parts)
-    assert callable(element_result) or element_result == None
-
-    # handle possible results
-    if element_result:
-        var, eval_function = _parse_element_result(
-            element_result, iTimestep=iTimestep)
-
-        def eval_elem(_elem):
-            coords.append(_elem.get_coords()[iTimestep])
-            elem_results.append(eval_function(_elem))
-    else:
-        def eval_elem(_elem):
-            coords.append(_elem.get_coords())
+    assert isinstance(element_result, str) or callable(
+        element_result) or element_result == None
 
     # extract
-    coords = []
-    elem_results = []
-    for _part in parts:
-        for _elem in _part.get_elements(element_type):
-            eval_elem(_elem)
-    coords = np.array(coords)
-    elem_results = np.array(elem_results)
+    coords = np.array([_elem.get_coords()[iTimestep]
+                       for _part in parts
+                       for _elem in _part.get_elements(element_type)])
 
     # return
     if element_result:
+        elem_results = np.concatenate(
+            [_extract_elem_data(_part, iTimestep, element_result, element_type)
+             for _part in parts])
         return coords, elem_results
     else:
         return coords
 
 
-def _extract_elem_data(element, iTimestep=0, element_result=None):
-    '''Extract fringe data from the element
+def _extract_elem_data(part, iTimestep=0, element_result=None, element_type=Element.none):
+    '''Extract fringe data from the elements of a part
 
     Parameters
     ----------
-    element : Element
-        Element to extract the data of
+    part : Part
+        part of which to extract the element data
     iTimestep : int
         timestep at which to extract the element data
     element_result : str or function
         which type of results to use as fringe
         None means no fringe is used
+        A str may be energy, plastic_strain or stress_mises, which are
+        fetched for all elements at once.
         Function shall take elem as input and return a float value (for fringe)
+    element_type : Element.type
+        element filter type, beam, shell or solid.
 
     Returns
     -------
-    result : float
+    result : np.ndarray
+        one value per element of the part
 
     Returns None in case that no result type is desired.
     '''
@@ -164,19 +157,23 @@ def _extract_elem_data(element, iTimestep=0, element_result=None):
 
     elif isinstance(element_result, str):
 
-        if "plastic_strain" in element_result:
-            return element.get_plastic_strain()[iTimestep]
-        elif "energy" in element_result:
-            return element.get_energy()[iTimestep]
-        else:
-            raise ValueError(
-                "Unknown result type %s. Try energy or plastic_strain." % element_result)
+        for result_name in ("plastic_strain", "energy", "stress_mises"):
+            if result_name in element_result:
+                return part.get_element_results(result_name,
+                                                element_type,
+                                                [iTimestep])[:, 0]
+
+        raise ValueError(
+            "Unknown result type %s. Try energy, plastic_strain or stress_mises." % element_result)
 
     elif callable(element_result):
-        elem_result = element_result(element)
-        assert isinstance(
-            elem_result, numbers.Number), "The return from the element_result function must be a number!"
-        return elem_result
+        elem_results = []
+        for element in part.get_elements(element_type):
+            elem_result = element_result(element)
+            assert isinstance(
+                elem_result, numbers.Number), "The return from the element_result function must be a number!"
+            elem_results.append(elem_result)
+        return np.asarray(elem_results, dtype=np.float32)
 
     else:
         raise ValueError(
@@ -211,21 +208,21 @@ def _extract_mesh_from_parts(parts, iTimestep=0, element_result=None):
 
     # loop through parts elements
     for part in parts:
-        for elem in part.get_elements():
 
-            if elem.get_type() != Element.shell:
-                continue
+        # element fringe
+        elem_results = _extract_elem_data(
+            part, iTimestep, element_result, Element.shell)
 
-            elem_nodes = elem.get_nodes()
+        for iElement, elem in enumerate(part.get_elements(Element.shell)):
 
-            # element fringe
-            elem_result = _extract_elem_data(elem, iTimestep, element_result)
+            elem_nodes = elem.get_nodes()
 
             # element annotation
-            if elem_result == None:
+            if elem_results is None:
                 elem_result = 0.
                 element_texts.append("e#%d" % elem.get_id())
             else:
+                elem_result = elem_results[iElement]
                 element_texts.append("e#%d=%.5f" %
                                      (elem.get_id(), elem_result))
 
@@ -9,6 +9,7 @@
 #include "FEMFile.hpp"
 #include "Node.hpp"
 #include "Part.hpp"
+#include <dyna_cpp/utility/MathUtility.hpp>
 
 namespace qd {
 
@@ -731,6 +732,42 @@ DB_Elements::get_element_stress(Element::ElementType element_filter)
   return tensor;
 }
 
+/** Get the stress invariants of elements
+ *
+ * @param element_filter : optional element filter
+ * @param _timesteps : indexes of the timesteps, negative ones count from
+ *                     the end, all if empty
+ * @return tensor : result data array (nElems x nTimesteps x 7)
+ *
+ * The last axis holds mises, pressure, triaxiality, the three principal
+ * stresses and the lode parameter (see MathUtility::stress_invariants).
+ * Elements without stress get the invariants of a zero stress.
+ * The invariants are not stored but computed on every call, thus only
+ * the stress of the requested timesteps is gathered.
+ */
+Tensor_ptr<float>
+DB_Elements::get_element_stress_invariants(
+  Element::ElementType element_filter,
+  const std::vector<int64_t>& _timesteps)
+{
+  auto stress = collect_element_results(get_elements(element_filter),
+                                        "stress",
+                                        _timesteps,
+                                        get_femfile()->get_nTimesteps());
+
+  auto shape = stress->get_shape();
+  shape.back() = MathUtility::N_STRESS_INVARIANTS;
+
+  auto tensor = std::make_shared<Tensor<float>>();
+  tensor->resize(shape);
+
+  MathUtility::stress_invariants(stress->get_data().data(),
+                                 stress->size() / 6,
+                                 tensor->get_data().data());
+
+  return tensor;
+}
+
 /** Get the coords of elements
  *
  * @param element_filter : optional element filter
@@ -858,4 +895,196 @@ DB_Elements::get_element_history_vars(Element::ElementType element_type)
   return tensor;
 }
 
-} // namespace qd
\ No newline at end of file
+/** Get a result of some elements by their ids
+ *
+ * @param _result_name : energy, stress_mises, plastic_strain, strain,
+ *                       stress or history_vars
+ * @param _element_type : type of the elements
+ * @param _ids : ids of the elements
+ * @param _timesteps : indexes of the timesteps, negative ones count from
+ *                     the end, all if empty
+ * @return tensor : (nElements x nTimesteps) for scalar result types, else
+ *                  (nElements x nTimesteps x nComponents)
+ */
+Tensor_ptr<float>
+DB_Elements::get_element_resultsByID(const std::string& _result_name,
+                                     Element::ElementType _element_type,
+                                     const std::vector<int32_t>& _ids,
+                                     const std::vector<int64_t>& _timesteps)
+{
+  return collect_element_results(get_elementByID(_element_type, _ids),
+                                 _result_name,
+                                 _timesteps,
+                                 get_femfile()->get_nTimesteps());
+}
+
+/** Get a result of some elements by their indexes
+ *
+ * @param _result_name : energy, stress_mises, plastic_strain, strain,
+ *                       stress or history_vars
+ * @param _element_type : type of the elements
+ * @param _indexes : indexes of the elements
+ * @param _timesteps : indexes of the timesteps, negative ones count from
+ *                     the end, all if empty
+ * @return tensor : (nElements x nTimesteps) for scalar result types, else
+ *                  (nElements x nTimesteps x nComponents)
+ */
+Tensor_ptr<float>
+DB_Elements::get_element_resultsByIndex(const std::string& _result_name,
+                                        Element::ElementType _element_type,
+                                        const std::vector<size_t>& _indexes,
+                                        const std::vector<int64_t>& _timesteps)
+{
+  return collect_element_results(get_elementByIndex(_element_type, _indexes),
+                                 _result_name,
+                                 _timesteps,
+                                 get_femfile()->get_nTimesteps());
+}
+
+/** Get the result type from its name
+ *
+ * @param _result_name : energy, stress_mises, plastic_strain, strain,
+ *                       stress or history_vars
+ * @return result_type
+ */
+Element::ResultType
+DB_Elements::parse_result_type(const std::string& _result_name)
+{
+  if (_result_name == "energy")
+    return Element::ResultType::ENERGY;
+  else if (_result_name == "stress_mises")
+    return Element::ResultType::STRESS_MISES;
+  else if (_result_name == "plastic_strain")
+    return Element::ResultType::PLASTIC_STRAIN;
+  else if (_result_name == "strain")
+    return Element::ResultType::STRAIN;
+  else if (_result_name == "stress")
+    return Element::ResultType::STRESS;
+  else if (_result_name == "history_vars")
+    return Element::ResultType::HISTORY_VARS;
+
+  throw(std::invalid_argument(
+    "Unknown element result " + _result_name +
+    ", use energy, stress_mises, plastic_strain, strain, stress or "
+    "history_vars."));
+}
+
+/** Copy a result of elements into one array
+ *
+ * @param _elements : elements to take the result from
+ * @param _result_name : energy, stress_mises, plastic_strain, strain,
+ *                       stress or history_vars
+ * @param _timesteps : indexes of the timesteps, negative ones count from
+ *                     the end, all if empty
+ * @param _nTimesteps : number of timesteps of the file
+ * @return tensor : (nElements x nTimesteps) for scalar result types, else
+ *                  (nElements x nTimesteps x nComponents)
+ *
+ * The data is copied straight from the elements. Missing values are 0.
+ * Strain, stress and history vars are always 3-D, also if only one or
+ * no component is present. History vars are padded to the longest
+ * history of the elements.
+ */
+Tensor_ptr<float>
+DB_Elements::collect_element_results(
+  const std::vector<std::shared_ptr<Element>>& _elements,
+  const std::string& _result_name,
+  const std::vector<int64_t>& _timesteps,
+  size_t _nTimesteps)
+{
+  const auto result_type = parse_result_type(_result_name);
+
+  // timesteps to copy
+  std::vector<size_t> timesteps;
+  if (_timesteps.empty()) {
+    timesteps.resize(_nTimesteps);
+    for (size_t iTimestep = 0; iTimestep < _nTimesteps; ++iTimestep)
+      timesteps[iTimestep] = iTimestep;
+  } else {
+    const auto nTimesteps = static_cast<int64_t>(_nTimesteps);
+    for (auto iTimestep : _timesteps) {
+      if (iTimestep < -nTimesteps || iTimestep >= nTimesteps)
+        throw(std::invalid_argument(
+          "Timestep " + std::to_string(iTimestep) + " is out of range for " +
+          std::to_string(_nTimesteps) + " timesteps."));
+      timesteps.push_back(static_cast<size_t>(
+        iTimestep < 0 ? iTimestep + nTimesteps : iTimestep));
+    }
+  }
+
+  // the rank depends on the result type only, not on the data
+  const bool is_scalar = result_type == Element::ResultType::ENERGY ||
+                         result_type == Element::ResultType::STRESS_MISES ||
+                         result_type == Element::ResultType::PLASTIC_STRAIN;
+
+  size_t nComponents = is_scalar ? 1 : 0;
+  if (!is_scalar)
+    for (const auto& element : _elements)
+      nComponents =
+        std::max(nComponents, element->get_nResultComponents(result_type));
+
+  auto tensor = std::make_shared<Tensor<float>>();
+  if (is_scalar)
+    tensor->resize({ _elements.size(), timesteps.size() });
+  else
+    tensor->resize({ _elements.size(), timesteps.size(), nComponents });
+  auto& data = tensor->get_data();
+
+  const auto element_offset = timesteps.size() * nComponents;
+  for (size_t iElement = 0; iElement < _elements.size(); ++iElement)
+    _elements[iElement]->copy_results(result_type,
+                                      timesteps,
+                                      nComponents,
+                                      data.data() + iElement * element_offset);
+
+  return tensor;
+}
+
+/** Get the min and max of an element result over time
+ *
+ * @param _result_name : energy, stress_mises, plastic_strain, strain,
+ *                       stress or history_vars
+ * @param element_filter : optional element filter
+ * @return envelope : (nElements x nComponents) extrema and their states
+ *
+ * The states are processed one by one per element, thus no array with
+ * the entire time history is allocated. Elements without the result
+ * have the state -1.
+ */
+TimeEnvelope_ptr<float>
+DB_Elements::get_element_result_envelope(const std::string& _result_name,
+                                         Element::ElementType element_filter)
+{
+  const auto result_type = parse_result_type(_result_name);
+  auto elements = get_elements(element_filter);
+
+  size_t nComponents = 0;
+  for (const auto& element : elements)
+    nComponents =
+      std::max(nComponents, element->get_nResultComponents(result_type));
+
+  auto envelope =
+    std::make_shared<TimeEnvelope<float>>(elements.size(), nComponents);
+
+  std::vector<size_t> timesteps;
+  std::vector<float> values;
+  for (size_t iElement = 0; iElement < elements.size(); ++iElement) {
+    const auto& element = elements[iElement];
+
+    const auto nTimesteps = element->get_nResultTimesteps(result_type);
+    timesteps.resize(nTimesteps);
+    for (size_t iTimestep = 0; iTimestep < nTimesteps; ++iTimestep)
+      timesteps[iTimestep] = iTimestep;
+
+    values.resize(nTimesteps * nComponents);
+    element->copy_results(result_type, timesteps, nComponents, values.data());
+
+    for (size_t iTimestep = 0; iTimestep < nTimesteps; ++iTimestep)
+      envelope->add(
+        iElement, iTimestep, values.data() + iTimestep * nComponents);
+  }
+
+  return envelope;
+}
+
+} // namespace qd
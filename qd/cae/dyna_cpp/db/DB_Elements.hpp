@@ -13,6 +13,7 @@
 
 #include <dyna_cpp/db/Element.hpp>
 #include <dyna_cpp/db/Part.hpp>
+#include <dyna_cpp/math/TimeEnvelope.hpp>
 
 namespace qd {
 
@@ -48,6 +49,8 @@ private:
     int32_t _part_id,
     const std::vector<int32_t>& _node_ids);
 
+  static Element::ResultType parse_result_type(const std::string& _result_name);
+
 public:
   explicit DB_Elements(FEMFile* _femfile);
   virtual ~DB_Elements();
@@ -105,6 +108,9 @@ public:
     Element::ElementType element_filter = Element::ElementType::NONE);
   Tensor_ptr<float> get_element_stress(
     Element::ElementType element_filter = Element::ElementType::NONE);
+  Tensor_ptr<float> get_element_stress_invariants(
+    Element::ElementType element_filter = Element::ElementType::NONE,
+    const std::vector<int64_t>& _timesteps = std::vector<int64_t>());
   Tensor_ptr<float> get_element_coords(
     Element::ElementType element_filter = Element::ElementType::NONE);
   Tensor_ptr<float> get_element_history_vars(Element::ElementType element_type);
@@ -113,6 +119,28 @@ public:
     Element::ElementType element_filter = Element::ElementType::NONE);
   Tensor_ptr<int32_t> get_element_node_ids(Element::ElementType element_type,
                                            size_t n_nodes);
+
+  // array functions for a selection of elements and timesteps
+  Tensor_ptr<float> get_element_resultsByID(
+    const std::string& _result_name,
+    Element::ElementType _element_type,
+    const std::vector<int32_t>& _ids,
+    const std::vector<int64_t>& _timesteps = std::vector<int64_t>());
+  Tensor_ptr<float> get_element_resultsByIndex(
+    const std::string& _result_name,
+    Element::ElementType _element_type,
+    const std::vector<size_t>& _indexes,
+    const std::vector<int64_t>& _timesteps = std::vector<int64_t>());
+  static Tensor_ptr<float> collect_element_results(
+    const std::vector<std::shared_ptr<Element>>& _elements,
+    const std::string& _result_name,
+    const std::vector<int64_t>& _timesteps,
+    size_t _nTimesteps);
+
+  // reductions over time
+  TimeEnvelope_ptr<float> get_element_result_envelope(
+    const std::string& _result_name,
+    Element::ElementType element_filter = Element::ElementType::NONE);
 };
 
 /** Get the element idnex from an id
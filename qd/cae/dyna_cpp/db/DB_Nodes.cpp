@@ -4,6 +4,9 @@
 #include "FEMFile.hpp"
 #include "Node.hpp"
 
+#include <algorithm>
+#include <cmath>
+#include <numeric>
 #include <stdexcept>
 #include <string>
 
@@ -14,6 +17,7 @@ namespace qd {
  */
 DB_Nodes::DB_Nodes(FEMFile* _femfile)
   : femfile(_femfile)
+  , revision(0)
 {}
 
 /*
@@ -177,13 +181,18 @@ DB_Nodes::get_nodes()
   return this->nodes;
 }
 
-/** Get nodal data as arrays
+/** Get the coordinates of all nodes over time
  *
- * @param name : name of the field
- * @return tensor : data as tensor
+ * @param _states : indexes of the states to get, all if empty
+ * @return tensor : (nNodes x nStates x 3)
+ *
+ * If the positions were read as one block, e.g. with
+ * read_states("coords") in a D3plot, they are taken from there.
+ * Otherwise position and displacement of every node are summed up.
+ * Without displacements there is only the initial position.
  */
 Tensor_ptr<float>
-DB_Nodes::get_node_coords()
+DB_Nodes::get_node_coords(const std::vector<size_t>& _states)
 {
   auto tensor = std::make_shared<Tensor<float>>();
 
@@ -191,32 +200,128 @@ DB_Nodes::get_node_coords()
   if (nodes.size() == 0)
     return tensor;
 
-  // do the thing
-  const auto& first_node_data = nodes[0]->get_coords();
+  const size_t nNodes = nodes.size();
+  const size_t nDims = 3;
+  const size_t nTimesteps =
+    this->has_node_positions()
+      ? node_positions->get_shape()[0]
+      : std::max(nodes[0]->get_disp().size(), static_cast<size_t>(1));
+
+  // state selection
+  std::vector<size_t> states(_states);
+  if (states.empty()) {
+    states.resize(nTimesteps);
+    std::iota(states.begin(), states.end(), static_cast<size_t>(0));
+  }
+  for (auto iState : states)
+    if (iState >= nTimesteps)
+      throw(std::invalid_argument("State index " + std::to_string(iState) +
+                                  " exceeds the number of states " +
+                                  std::to_string(nTimesteps) + "."));
+  const size_t nStates = states.size();
+
+  tensor->resize({ nNodes, nStates, nDims });
+  float* tensor_data = tensor->get_data().data();
+
+  // positions block: gather the states for every node, FLOAT32 directly
+  // from the storage, compact types widened one state at a time
+  if (this->has_node_positions()) {
+    const size_t nBlockNodes = node_positions->get_shape()[1];
+    if (nBlockNodes != nNodes)
+      throw(std::runtime_error(
+        "The coordinate block holds " + std::to_string(nBlockNodes) +
+        " nodes, but there are " + std::to_string(nNodes) + " nodes."));
+
+    std::vector<float> state_positions;
+    for (size_t iState = 0; iState < nStates; ++iState) {
+      const float* positions = node_positions->get_float_slice(states[iState]);
+      if (positions == nullptr) {
+        state_positions.resize(nNodes * nDims);
+        node_positions->get_slice(states[iState], state_positions.data());
+        positions = state_positions.data();
+      }
+
+#pragma omp parallel for schedule(static)
+      for (int64_t iNode = 0; iNode < static_cast<int64_t>(nNodes); ++iNode) {
+        const float* position = positions + iNode * nDims;
+        float* out = tensor_data + (iNode * nStates + iState) * nDims;
+        out[0] = position[0];
+        out[1] = position[1];
+        out[2] = position[2];
+      }
+    }
 
-  if (first_node_data.size() == 0)
     return tensor;
+  }
 
-  const auto nTimesteps = first_node_data.size();
-  const auto nDims = first_node_data[0].size();
-
-  tensor->resize({ nodes.size(), nTimesteps, nDims });
-  auto& tensor_data = tensor->get_data();
-
-  for (size_t iNode = 0; iNode < nodes.size(); ++iNode) {
-    const auto& series = nodes[iNode]->get_coords();
-    const auto offset = iNode * nTimesteps * nDims;
-    for (size_t iStep = 0; iStep < series.size(); ++iStep) {
-      const auto offset2 = offset + iStep * nDims;
-      tensor_data[offset2] = series[iStep][0];
-      tensor_data[offset2 + 1] = series[iStep][1];
-      tensor_data[offset2 + 2] = series[iStep][2];
+  // position + displacement is written directly, Node::get_coords
+  // would allocate the time series of every node first
+#pragma omp parallel for schedule(static)
+  for (int64_t iNode = 0; iNode < static_cast<int64_t>(nNodes); ++iNode) {
+    const auto& position = nodes[iNode]->get_position();
+    const auto& disp = nodes[iNode]->get_disp();
+    float* out = tensor_data + iNode * nStates * nDims;
+
+    for (size_t iState = 0; iState < nStates; ++iState) {
+      const size_t iTimestep = states[iState];
+      for (size_t iDim = 0; iDim < nDims; ++iDim)
+        out[iState * nDims + iDim] =
+          iTimestep < disp.size() ? position[iDim] + disp[iTimestep][iDim]
+                                  : position[iDim];
     }
   }
 
   return tensor;
 }
 
+/** Set the coordinates of all nodes in a state
+ *
+ * @param _iState : index of the state
+ * @param _positions : coordinates (nNodes x 3)
+ * @param _precision : storage type, used when the block is created
+ *
+ * The coordinates of all states are kept in one block, the
+ * nodes themselves do not receive displacements.
+ */
+void
+DB_Nodes::set_node_positions(size_t _iState,
+                             const std::vector<float>& _positions,
+                             Precision _precision)
+{
+  const size_t nNodes = nodes.size();
+  if (_positions.size() != nNodes * 3)
+    throw(std::invalid_argument(
+      "Expected " + std::to_string(nNodes * 3) + " node coordinates, got " +
+      std::to_string(_positions.size()) + "."));
+
+  if (node_positions == nullptr)
+    node_positions = std::make_shared<CompactTensor>(_precision);
+  if (node_positions->get_shape().empty() ||
+      node_positions->get_shape()[0] <= _iState)
+    node_positions->resize({ _iState + 1, nNodes, 3 });
+
+  node_positions->set_slice(_iState, _positions.data());
+}
+
+/** Delete the block of node coordinates
+ *
+ */
+void
+DB_Nodes::clear_node_positions()
+{
+  node_positions = nullptr;
+}
+
+/** Tells whether the node coordinates are stored as one block
+ *
+ * @return has_node_positions
+ */
+bool
+DB_Nodes::has_node_positions() const
+{
+  return node_positions != nullptr && !node_positions->get_shape().empty();
+}
+
 Tensor_ptr<float>
 DB_Nodes::get_node_velocity()
 {
@@ -309,4 +414,41 @@ DB_Nodes::get_node_ids()
   return tensor;
 }
 
-} // namespace qd
\ No newline at end of file
+/** Get the min and max of the resultant of a node result over time
+ *
+ * @param _result_name : disp, vel or accel
+ * @return envelope : (nNodes x 1) extrema of the vector length and
+ *                    their states
+ *
+ * The displacement is taken relative to the initial position. The
+ * states are processed one by one, no time history array is allocated.
+ */
+TimeEnvelope_ptr<float>
+DB_Nodes::get_node_result_envelope(const std::string& _result_name)
+{
+  auto envelope = std::make_shared<TimeEnvelope<float>>(nodes.size(), 1);
+
+  for (size_t iNode = 0; iNode < nodes.size(); ++iNode) {
+    const std::vector<std::vector<float>>* series = nullptr;
+    if (_result_name == "disp")
+      series = &nodes[iNode]->get_disp();
+    else if (_result_name == "vel")
+      series = &nodes[iNode]->get_vel();
+    else if (_result_name == "accel")
+      series = &nodes[iNode]->get_accel();
+    else
+      throw(std::invalid_argument("Unknown node result " + _result_name +
+                                  ", use disp, vel or accel."));
+
+    for (size_t iStep = 0; iStep < series->size(); ++iStep) {
+      const auto& vec = (*series)[iStep];
+      const float resultant =
+        std::sqrt(vec[0] * vec[0] + vec[1] * vec[1] + vec[2] * vec[2]);
+      envelope->add(iNode, iStep, &resultant);
+    }
+  }
+
+  return envelope;
+}
+
+} // namespace qd
@@ -3,6 +3,7 @@
 #define DB_NODES_HPP
 
 // includes
+#include <atomic>
 #include <cstdint>
 #include <iostream>
 #include <memory>
@@ -13,7 +14,9 @@
 #include <vector>
 
 #include <dyna_cpp/db/Node.hpp>
+#include <dyna_cpp/math/CompactTensor.hpp>
 #include <dyna_cpp/math/Tensor.hpp>
+#include <dyna_cpp/math/TimeEnvelope.hpp>
 #include <dyna_cpp/utility/containers.hpp>
 
 namespace qd {
@@ -36,6 +39,8 @@ private:
   std::unordered_map<std::string, size_t> field_name_to_index;
   std::vector<Tensor_ptr<float>> fields;
   Tensor_ptr<int32_t> node_ids;
+  CompactTensor_ptr node_positions; // coords per state (nStates x nNodes x 3)
+  std::atomic<uint64_t> revision;   // counts node modifications
 
 public:
   explicit DB_Nodes(FEMFile* _femfile);
@@ -51,6 +56,10 @@ public:
                                            float _y,
                                            float _z);
 
+  // modification tracking
+  inline uint64_t get_revision() const;
+  inline uint64_t increment_revision();
+
   template<typename T>
   T get_id_from_index(size_t _id);
   template<typename T>
@@ -70,12 +79,44 @@ public:
   std::shared_ptr<Node> get_nodeByIndex_nothrow(T _index);
 
   // array data
-  Tensor_ptr<float> get_node_coords();
+  Tensor_ptr<float> get_node_coords(
+    const std::vector<size_t>& _states = std::vector<size_t>());
   Tensor_ptr<float> get_node_velocity();
   Tensor_ptr<float> get_node_acceleration();
   Tensor_ptr<int32_t> get_node_ids();
+
+  // node coordinates over time stored in one block
+  void set_node_positions(size_t _iState,
+                          const std::vector<float>& _positions,
+                          Precision _precision = Precision::FLOAT32);
+  void clear_node_positions();
+  bool has_node_positions() const;
+
+  // reductions over time
+  TimeEnvelope_ptr<float> get_node_result_envelope(
+    const std::string& _result_name);
 };
 
+/** Get the current modification revision of the database
+ *
+ * @return revision : number of node modifications so far
+ */
+uint64_t
+DB_Nodes::get_revision() const
+{
+  return revision.load();
+}
+
+/** Advance the modification revision
+ *
+ * @return revision : the new revision
+ */
+uint64_t
+DB_Nodes::increment_revision()
+{
+  return ++revision;
+}
+
 /** Get the node index from it's id
  *
  * @param T _id : node id
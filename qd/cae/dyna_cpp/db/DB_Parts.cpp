@@ -10,6 +10,7 @@ namespace qd {
  */
 DB_Parts::DB_Parts(FEMFile* _femfile)
   : femfile(_femfile)
+  , revision(0)
 {}
 
 /**
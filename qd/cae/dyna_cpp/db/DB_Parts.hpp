@@ -4,6 +4,7 @@
 
 #include <dyna_cpp/db/Part.hpp>
 
+#include <atomic>
 #include <cstdint>
 #include <memory>
 #include <stdexcept>
@@ -23,6 +24,7 @@ private:
   FEMFile* femfile;
   std::vector<std::shared_ptr<Part>> parts;
   std::unordered_map<int32_t, size_t> id2index_parts;
+  std::atomic<uint64_t> revision; // counts part modifications
 
 public:
   explicit DB_Parts(FEMFile* _femfile);
@@ -33,6 +35,10 @@ public:
   template<typename T>
   T get_part_id_from_index(size_t _index);
 
+  // modification tracking
+  inline uint64_t get_revision() const;
+  inline uint64_t increment_revision();
+
   size_t get_nParts() const;
   void print_parts() const;
   std::shared_ptr<Part> add_partByID(int32_t _partID,
@@ -49,6 +55,26 @@ public:
   std::vector<std::shared_ptr<Part>> get_partByIndex(std::vector<T> _indexes);
 };
 
+/** Get the current modification revision of the database
+ *
+ * @return revision : number of part modifications so far
+ */
+uint64_t
+DB_Parts::get_revision() const
+{
+  return revision.load();
+}
+
+/** Advance the modification revision
+ *
+ * @return revision : the new revision
+ */
+uint64_t
+DB_Parts::increment_revision()
+{
+  return ++revision;
+}
+
 template<typename T>
 inline size_t
 DB_Parts::get_part_index_from_id(T _id)
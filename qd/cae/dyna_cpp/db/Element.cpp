@@ -270,6 +270,16 @@ Element::get_part_id() const
   return part_id;
 }
 
+/** Get the database owning the element
+ *
+ * @return db_elements
+ */
+DB_Elements*
+Element::get_db_elements() const
+{
+  return db_elements;
+}
+
 /*
  * Get the coordinates of the element, which is
  * the average of all nodes.
@@ -444,6 +454,108 @@ Element::get_stress_mises() const
   return this->stress_mises;
 }
 
+/** Get the number of components of a result per timestep
+ *
+ * @param _type : type of the result
+ * @return nComponents : 0 if there are no history vars
+ */
+size_t
+Element::get_nResultComponents(ResultType _type) const
+{
+  switch (_type) {
+    case ENERGY:
+    case STRESS_MISES:
+    case PLASTIC_STRAIN:
+      return 1;
+    case STRAIN:
+    case STRESS:
+      return 6;
+    case HISTORY_VARS:
+      return history_vars.empty() ? 0 : history_vars[0].size();
+  }
+  return 0;
+}
+
+/** Get the number of timesteps stored for a result
+ *
+ * @param _type : type of the result
+ * @return nTimesteps : 0 if the result was not read
+ */
+size_t
+Element::get_nResultTimesteps(ResultType _type) const
+{
+  switch (_type) {
+    case ENERGY:
+      return energy.size();
+    case STRESS_MISES:
+      return stress_mises.size();
+    case PLASTIC_STRAIN:
+      return plastic_strain.size();
+    case STRAIN:
+      return strain.size();
+    case STRESS:
+      return stress.size();
+    case HISTORY_VARS:
+      return history_vars.size();
+  }
+  return 0;
+}
+
+/** Copy a result of some timesteps into a buffer
+ *
+ * @param _type : type of the result
+ * @param _timesteps : indexes of the timesteps to copy
+ * @param _nComponents : number of components per timestep in the buffer
+ * @param _buffer : destination of size _timesteps.size() * _nComponents
+ *
+ * Missing values are set to 0, as in the DB_Elements array getters.
+ */
+void
+Element::copy_results(ResultType _type,
+                      const std::vector<size_t>& _timesteps,
+                      size_t _nComponents,
+                      float* _buffer) const
+{
+  const std::vector<float>* scalars = nullptr;
+  const std::vector<std::vector<float>>* vectors = nullptr;
+  switch (_type) {
+    case ENERGY:
+      scalars = &energy;
+      break;
+    case STRESS_MISES:
+      scalars = &stress_mises;
+      break;
+    case PLASTIC_STRAIN:
+      scalars = &plastic_strain;
+      break;
+    case STRAIN:
+      vectors = &strain;
+      break;
+    case STRESS:
+      vectors = &stress;
+      break;
+    case HISTORY_VARS:
+      vectors = &history_vars;
+      break;
+  }
+
+  for (size_t iTimestep = 0; iTimestep < _timesteps.size(); ++iTimestep) {
+    const auto timestep = _timesteps[iTimestep];
+    auto dest = _buffer + iTimestep * _nComponents;
+
+    size_t nCopied = 0;
+    if (scalars != nullptr && timestep < scalars->size() && _nComponents > 0) {
+      dest[0] = (*scalars)[timestep];
+      nCopied = 1;
+    } else if (vectors != nullptr && timestep < vectors->size()) {
+      const auto& values = (*vectors)[timestep];
+      nCopied = std::min(values.size(), _nComponents);
+      std::copy_n(values.begin(), nCopied, dest);
+    }
+    std::fill(dest + nCopied, dest + _nComponents, 0.f);
+  }
+}
+
 /*
  * Get the series of history variables.
  */
@@ -31,6 +31,16 @@ public:
     TSHELL
   };
 
+  enum ResultType
+  {
+    ENERGY,
+    STRESS_MISES,
+    PLASTIC_STRAIN,
+    STRAIN,
+    STRESS,
+    HISTORY_VARS
+  };
+
 private:
   int32_t elementID;
   int32_t part_id;
@@ -68,6 +78,7 @@ public:
   ElementType get_elementType() const;
   int32_t get_elementID() const;
   int32_t get_part_id() const;
+  DB_Elements* get_db_elements() const;
   bool get_is_rigid() const;
   float get_estimated_element_size() const; // fast
   size_t get_nNodes() const;
@@ -81,6 +92,12 @@ public:
   std::vector<std::vector<float>> get_strain() const;
   std::vector<std::vector<float>> get_stress() const;
   std::vector<std::vector<float>> get_history_vars() const;
+  size_t get_nResultComponents(ResultType _type) const;
+  size_t get_nResultTimesteps(ResultType _type) const;
+  void copy_results(ResultType _type,
+                    const std::vector<size_t>& _timesteps,
+                    size_t _nComponents,
+                    float* _buffer) const;
 
   // setter
   void set_is_rigid(bool _is_rigid);
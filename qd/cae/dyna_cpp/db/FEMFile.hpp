@@ -6,6 +6,7 @@
 #include <dyna_cpp/db/DB_Elements.hpp>
 #include <dyna_cpp/db/DB_Nodes.hpp>
 #include <dyna_cpp/db/DB_Parts.hpp>
+#include <mutex>
 #include <string>
 
 namespace qd {
@@ -21,6 +22,9 @@ class FEMFile
 private:
   std::string filepath;
 
+protected:
+  std::recursive_mutex state_mutex; // reading and clearing states
+
 public:
   explicit FEMFile();
   explicit FEMFile(const std::string& filepath);
@@ -35,6 +39,9 @@ public:
   {
     return static_cast<DB_Elements*>(this);
   }
+
+  // results may only be accessed while holding this lock
+  inline std::recursive_mutex& get_state_mutex() { return state_mutex; }
 };
 
 } // namespace qd
@@ -26,6 +26,7 @@ Node::Node(int32_t _nodeID,
   : nodeID(_nodeID)
   , coords(_coords)
   , db_nodes(_db_nodes)
+  , revision(0)
 {}
 
 /** Constructor of a node
@@ -38,6 +39,7 @@ Node::Node(int32_t _nodeID, float _x, float _y, float _z, DB_Nodes* _db_nodes)
   : nodeID(_nodeID)
   , coords({ _x, _y, _z })
   , db_nodes(_db_nodes)
+  , revision(0)
 {}
 
 /** Destructor
@@ -146,13 +148,18 @@ Node::add_accel(std::vector<float> _new_accel)
  * @param _x
  * @param _y
  * @param _z
+ *
+ * The change is stamped with a new database revision, so that
+ * keywords owning the node know they need to be rewritten.
  */
 void
 Node::set_coords(float _x, float _y, float _z)
 {
+  std::lock_guard<std::mutex> lock(_node_mutex);
   coords[0] = _x;
   coords[1] = _y;
   coords[2] = _z;
+  revision = db_nodes != nullptr ? db_nodes->increment_revision() : 1;
 }
 
 /** Remove an element from the node
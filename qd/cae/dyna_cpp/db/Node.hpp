@@ -3,6 +3,7 @@
 #define NODE_HPP
 
 // includes
+#include <cstdint>
 #include <memory>
 #include <mutex>
 #include <string>
@@ -27,6 +28,7 @@ private:
   std::vector<std::vector<float>> vel;
   std::vector<std::vector<float>> accel;
   DB_Nodes* db_nodes;
+  uint64_t revision; // db revision of the last coordinate change
 
   std::mutex _node_mutex;
 
@@ -60,6 +62,8 @@ public:
 
   // Getter
   inline int32_t get_nodeID() const;
+  inline DB_Nodes* get_db_nodes() const;
+  inline uint64_t get_revision() const;
   inline std::vector<std::shared_ptr<Element>> get_elements();
 
   inline const std::vector<float>& get_position() const;
@@ -109,6 +113,26 @@ Node::get_nodeID() const
   return this->nodeID;
 }
 
+/** Get the database owning the node
+ *
+ * @return db_nodes
+ */
+DB_Nodes*
+Node::get_db_nodes() const
+{
+  return this->db_nodes;
+}
+
+/** Get the database revision at which the coordinates were last changed
+ *
+ * @return revision : 0 if the node was never modified
+ */
+uint64_t
+Node::get_revision() const
+{
+  return this->revision;
+}
+
 /** Get all elements of the node
  *
  * @return elements
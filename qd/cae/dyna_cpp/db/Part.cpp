@@ -1,5 +1,7 @@
 
+#include <dyna_cpp/db/DB_Elements.hpp>
 #include <dyna_cpp/db/DB_Nodes.hpp>
+#include <dyna_cpp/db/DB_Parts.hpp>
 #include <dyna_cpp/db/FEMFile.hpp>
 #include <dyna_cpp/db/Node.hpp>
 #include <dyna_cpp/db/Part.hpp>
@@ -17,16 +19,42 @@ Part::Part(int32_t _partID, const std::string& _partName, FEMFile* _femfile)
   : partID(_partID)
   , femfile(_femfile)
   , partName(trim_copy(_partName))
+  , revision(0)
 {}
 
 /**
  * Assign a part name.
+ *
+ * The change is stamped with a new database revision, so that
+ * keywords owning the part know they need to be rewritten.
  */
 void
 Part::set_name(const std::string& _name)
 {
   std::lock_guard<std::mutex> lock(_part_mutex);
   this->partName = trim_copy(_name);
+  revision =
+    femfile != nullptr ? femfile->get_db_parts()->increment_revision() : 1;
+}
+
+/** Get the file owning the part
+ *
+ * @return femfile
+ */
+FEMFile*
+Part::get_femfile() const
+{
+  return this->femfile;
+}
+
+/** Get the database revision at which the part was last changed
+ *
+ * @return revision : 0 if the part was never modified
+ */
+uint64_t
+Part::get_revision() const
+{
+  return this->revision;
 }
 
 /**
@@ -315,4 +343,25 @@ Part::get_element_ids(Element::ElementType element_filter)
   return tensor;
 }
 
+/** Get a result of the elements of the part
+ *
+ * @param _result_name : energy, stress_mises, plastic_strain, strain,
+ *                       stress or history_vars
+ * @param _element_filter : optional element type
+ * @param _timesteps : indexes of the timesteps, negative ones count from
+ *                     the end, all if empty
+ * @return tensor : (nElements x nTimesteps) for scalar result types, else
+ *                  (nElements x nTimesteps x nComponents)
+ */
+Tensor_ptr<float>
+Part::get_element_results(const std::string& _result_name,
+                          Element::ElementType _element_filter,
+                          const std::vector<int64_t>& _timesteps)
+{
+  return DB_Elements::collect_element_results(get_elements(_element_filter),
+                                              _result_name,
+                                              _timesteps,
+                                              femfile->get_nTimesteps());
+}
+
 } // namespace qd
\ No newline at end of file
@@ -27,6 +27,7 @@ private:
   FEMFile* femfile;
   std::string partName;
   std::vector<std::shared_ptr<Element>> elements;
+  uint64_t revision; // db revision of the last name change
 
   std::mutex _part_mutex;
 
@@ -40,6 +41,8 @@ public:
   void add_element(std::shared_ptr<Element> _element);
 
   int32_t get_partID() const;
+  FEMFile* get_femfile() const;
+  uint64_t get_revision() const;
   std::string get_name() const;
   size_t get_nElements() const;
   size_t get_nNodes() const;
@@ -54,6 +57,10 @@ public:
   Tensor_ptr<size_t> get_node_indexes();
   Tensor_ptr<int32_t> get_element_ids(
     Element::ElementType etype = Element::ElementType::NONE);
+  Tensor_ptr<float> get_element_results(
+    const std::string& _result_name,
+    Element::ElementType _element_filter = Element::ElementType::NONE,
+    const std::vector<int64_t>& _timesteps = std::vector<int64_t>());
 };
 
 } // namespace qd
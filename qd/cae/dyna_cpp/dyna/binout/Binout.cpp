@@ -1,11 +1,41 @@
 
 #include <algorithm>
+#include <cerrno>
+#include <cstring>
 #include <iostream>
 #include <iterator>
 #include <stdexcept>
 #include <string>
 
 #include <dyna_cpp/dyna/binout/Binout.hpp>
+#include <dyna_cpp/utility/TextUtility.hpp>
+
+#ifdef _WIN32
+#include <fstream>
+#include <io.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#ifdef QD_USE_HDF5
+#include <deque>
+#include <future>
+#include <thread>
+
+#include <H5Cpp.h>
+#include <zlib.h>
+
+#include <dyna_cpp/parallel/WorkQueue.hpp>
+#include <dyna_cpp/utility/HDF5_Utility.hpp>
+
+// precompressed chunks are written with H5Dwrite_chunk
+#if !H5_VERSION_GE(1, 10, 2)
+#error "The binout HDF5 export requires HDF5 1.10.2 or newer."
+#endif
+#endif
 
 extern "C" {
 #include <dyna_cpp/dyna/binout/lsda/lsda.h>
@@ -17,14 +47,33 @@ namespace qd {
 /**
  * @brief Constructor of a Binout
  * @param string filepath
+ * @param _use_index : whether to keep the symbol table in an index file
+ *                     next to the binout ("filepath.qdidx")
+ *
+ * Opening a binout family requires reading the symbol tables of all its
+ * files. With an index, this is done only once. The index is rewritten
+ * whenever files of the family changed.
  */
-Binout::Binout(const std::string& _filepath)
-  : filepath(_filepath)
+Binout::Binout(const std::string& _filepath, bool _use_index)
+  : fhandle(-1)
+  , filepath(_filepath)
 {
 
-  this->fhandle = lsda_open((char*)&filepath[0], LSDA_READONLY);
+  std::lock_guard<std::recursive_mutex> lock(get_lsda_mutex());
+
+  const auto index_filepath = filepath + ".qdidx";
+  if (_use_index)
+    this->fhandle = _open_index(index_filepath);
+
   if (this->fhandle == -1) {
-    throw(std::invalid_argument("Error while opening Binout."));
+    this->fhandle = lsda_open((char*)&filepath[0], LSDA_READONLY);
+    if (this->fhandle == -1) {
+      throw(std::invalid_argument("Error while opening Binout."));
+    }
+
+    // a missing index is no error, e.g. in read-only directories
+    if (_use_index)
+      lsda_write_index(this->fhandle, (char*)&index_filepath[0]);
   }
 }
 
@@ -33,7 +82,366 @@ Binout::Binout(const std::string& _filepath)
  */
 Binout::~Binout()
 {
+  std::lock_guard<std::recursive_mutex> lock(get_lsda_mutex());
   lsda_close(this->fhandle);
+
+#ifndef _WIN32
+  for (auto& data_file : data_files) {
+    if (!data_file)
+      continue;
+    if (data_file->mapping != nullptr)
+      munmap(const_cast<char*>(data_file->mapping), data_file->mapping_size);
+    if (data_file->fd >= 0)
+      close(data_file->fd);
+  }
+#endif
+}
+
+/** Get the lock for calls into the LSDA library
+ *
+ * @return mutex
+ *
+ * The library has global state (e.g. the table of open files),
+ * therefore one lock is shared by all binouts.
+ */
+std::recursive_mutex&
+Binout::get_lsda_mutex()
+{
+  static std::recursive_mutex lsda_mutex;
+  return lsda_mutex;
+}
+
+/** Open the binout from an index file
+ *
+ * @param _index_filepath : path to the index file
+ * @return handle : lsda handle or -1 if the index is missing or outdated
+ *
+ * Must be called with the LSDA lock held.
+ */
+int
+Binout::_open_index(const std::string& _index_filepath)
+{
+#ifdef _WIN32
+  std::ifstream index_file(_index_filepath, std::ios::binary);
+  if (!index_file)
+    return -1;
+  std::vector<char> index((std::istreambuf_iterator<char>(index_file)),
+                          std::istreambuf_iterator<char>());
+  return lsda_open_index((char*)&filepath[0], index.data(), index.size());
+#else
+  int fd = open(_index_filepath.c_str(), O_RDONLY);
+  if (fd < 0)
+    return -1;
+
+  int handle = -1;
+  struct stat file_stat;
+  if (fstat(fd, &file_stat) == 0 && file_stat.st_size > 0) {
+    const auto size = static_cast<size_t>(file_stat.st_size);
+    void* mapping = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    if (mapping != MAP_FAILED) {
+      madvise(mapping, size, MADV_SEQUENTIAL);
+      handle = lsda_open_index(
+        (char*)&filepath[0], static_cast<const char*>(mapping), size);
+      munmap(mapping, size);
+    }
+  }
+  close(fd);
+  return handle;
+#endif
+}
+
+/** Get the file containing the raw data of a variable
+ *
+ * @param _info : variable looked up with _query_variable
+ * @return data_file : file containing the data, nullptr if the data must
+ *                     be read through the library
+ *
+ * Must be called with the LSDA lock held. Files are opened and mapped
+ * into memory on first use and stay open until the binout is closed.
+ */
+const Binout::DataFile*
+Binout::_locate_data(const LSDA_VarInfo& _info)
+{
+#ifdef _WIN32
+  return nullptr;
+#else
+  if (!_info.native || _info.file_number < 0)
+    return nullptr;
+
+  const auto file_number = static_cast<size_t>(_info.file_number);
+  if (file_number >= data_files.size())
+    data_files.resize(file_number + 1);
+
+  auto& data_file = data_files[file_number];
+  if (!data_file) {
+
+    char data_filepath[4096];
+    if (lsda_filename(this->fhandle,
+                      _info.file_number,
+                      data_filepath,
+                      sizeof(data_filepath)) != 0)
+      return nullptr;
+
+    data_file.reset(new DataFile{ open(data_filepath, O_RDONLY), nullptr, 0 });
+
+    // mapping is optional, we fall back to pread
+    struct stat file_stat;
+    if (data_file->fd >= 0 && fstat(data_file->fd, &file_stat) == 0 &&
+        file_stat.st_size > 0) {
+      void* mapping = mmap(nullptr,
+                           static_cast<size_t>(file_stat.st_size),
+                           PROT_READ,
+                           MAP_SHARED,
+                           data_file->fd,
+                           0);
+      if (mapping != MAP_FAILED) {
+        // many small variables all over the file
+        madvise(mapping, static_cast<size_t>(file_stat.st_size), MADV_RANDOM);
+        data_file->mapping = static_cast<const char*>(mapping);
+        data_file->mapping_size = static_cast<size_t>(file_stat.st_size);
+      }
+    }
+  }
+
+  if (data_file->fd < 0)
+    return nullptr;
+
+  return data_file.get();
+#endif
+}
+
+/** Read raw data from a file at an offset
+ *
+ * @param _file : file to read from
+ * @param _offset : position in the file
+ * @param _data : destination
+ * @param _nBytes : number of bytes to read
+ *
+ * The data is copied from the memory mapping. Data behind the mapping
+ * (e.g. the file grew) is read with pread. Neither moves a file
+ * cursor, thus it can be called in parallel.
+ */
+void
+Binout::_read_raw(const DataFile& _file,
+                  size_t _offset,
+                  void* _data,
+                  size_t _nBytes)
+{
+#ifdef _WIN32
+  throw(std::runtime_error("Raw binout reads are not supported on Windows."));
+#else
+  if (_file.mapping != nullptr && _offset <= _file.mapping_size &&
+      _nBytes <= _file.mapping_size - _offset) {
+    std::memcpy(_data, _file.mapping + _offset, _nBytes);
+    return;
+  }
+
+  auto dest = static_cast<char*>(_data);
+  while (_nBytes > 0) {
+    auto nRead = pread(_file.fd, dest, _nBytes, static_cast<off_t>(_offset));
+    if (nRead < 0 && errno == EINTR)
+      continue;
+    if (nRead <= 0)
+      throw(std::runtime_error("Error while reading binout data: " +
+                               std::string(nRead == 0 ? "unexpected end of file"
+                                                      : std::strerror(errno))));
+    dest += nRead;
+    _offset += static_cast<size_t>(nRead);
+    _nBytes -= static_cast<size_t>(nRead);
+  }
+#endif
+}
+
+/** Look up a variable and check that it can be read
+ *
+ * @param _path : path to the variable
+ * @param _info : type, length and location of the data
+ * @return entry_type : type of the variable
+ *
+ * Must be called with the LSDA lock held. One symbol table lookup
+ * serves all checks and the read itself.
+ */
+Binout::EntryType
+Binout::_query_variable(const std::string& _path, LSDA_VarInfo& _info)
+{
+  constexpr int follow = 1;
+  lsda_lookup(this->fhandle, (char*)&_path[0], follow, &_info);
+
+  if (_info.type_id < 0)
+    throw(std::invalid_argument("Path " + _path + " does not exist."));
+
+  if (_info.type_id == 0 || _info.length == 0)
+    throw(std::invalid_argument("Path " + _path +
+                                " does not point to a variable."));
+
+  auto entry_type = _to_entry_type(_info.type_id);
+  if (entry_type == EntryType::UNKNOWN)
+    throw(std::runtime_error("Path " + _path +
+                             " caused an error in Binout.read_variable. This "
+                             "should never happen ..."));
+  else if (entry_type == EntryType::LINK)
+    throw(std::invalid_argument(
+      "Path " + _path + " does point to a LINK and not to a variable."));
+
+  return entry_type;
+}
+
+/** Read the data of a variable in its stored type
+ *
+ * @param _lock : LSDA lock, released for raw reads
+ * @param _path : path to the variable
+ * @param _info : variable looked up with _query_variable
+ * @param _item_size : size of an item in bytes
+ * @param _data : destination
+ */
+void
+Binout::_read_variable_data(std::unique_lock<std::recursive_mutex>& _lock,
+                            const std::string& _path,
+                            const LSDA_VarInfo& _info,
+                            size_t _item_size,
+                            void* _data)
+{
+  // plain data is read without the library, thus in parallel
+  if (auto data_file = _locate_data(_info)) {
+    _lock.unlock();
+    _read_raw(*data_file, _info.data_offset, _data, _info.length * _item_size);
+    return;
+  }
+
+  size_t ret = lsda_lread(this->fhandle,
+                          _info.type_id,
+                          (char*)&_path[0], // path
+                          0,                // offset
+                          _info.length,     // length
+                          _data);           // data
+
+  // I know this is dumb, but dyna defines an unsigned type with -1 in case of
+  // an error. Really need to fix this sometime ...
+  if (ret == (size_t)-1) {
+    throw(std::runtime_error(
+      "Error during lsda_realread and I have no clue what happened. Sry."));
+  }
+}
+
+/** Look up a variable in several directories
+ *
+ * @param _dir : parent directory, e.g. "/nodout"
+ * @param _subdirs : directories in _dir containing the variable
+ * @param _var_name : name of the variable
+ * @return entries : location of the variable in every directory
+ *
+ * Must be called with the LSDA lock held. The directory is resolved
+ * once. Missing variables have a type id of -1.
+ */
+std::vector<Binout::SeriesEntry>
+Binout::_locate_series(const std::string& _dir,
+                       const std::vector<std::string>& _subdirs,
+                       const std::string& _var_name)
+{
+  auto dir = _dir.empty() ? std::string("/") : _dir;
+  auto var_name = _var_name;
+  auto subdirs = _subdirs;
+
+  std::vector<char*> subdir_names(subdirs.size());
+  for (size_t iSubdir = 0; iSubdir < subdirs.size(); ++iSubdir)
+    subdir_names[iSubdir] = &subdirs[iSubdir][0];
+
+  std::vector<LSDA_VarInfo> infos(subdirs.size());
+  if (lsda_lookup_series(this->fhandle,
+                         &dir[0],
+                         subdir_names.data(),
+                         subdir_names.size(),
+                         &var_name[0],
+                         infos.data()) != 0)
+    throw(std::invalid_argument("Path " + dir + " is not a directory."));
+
+  const auto dir_prefix = dir.back() == '/' ? dir : dir + '/';
+  std::vector<SeriesEntry> entries(subdirs.size());
+  for (size_t iSubdir = 0; iSubdir < subdirs.size(); ++iSubdir) {
+    auto& entry = entries[iSubdir];
+    entry.path = dir_prefix + subdirs[iSubdir] + "/" + var_name;
+    entry.info = infos[iSubdir];
+    entry.data_file = entry.info.type_id > 0 ? _locate_data(entry.info)
+                                             : nullptr;
+  }
+
+  return entries;
+}
+
+/** Read a part of a variable of a series in its stored type
+ *
+ * @param _entry : variable located with _locate_series
+ * @param _offset : index of the first item
+ * @param _length : number of items
+ * @param _item_size : size of an item in bytes
+ * @param _data : destination
+ *
+ * The LSDA lock must be held, unless the entry has a data file.
+ */
+void
+Binout::_read_entry_range(const SeriesEntry& _entry,
+                          size_t _offset,
+                          size_t _length,
+                          size_t _item_size,
+                          void* _data)
+{
+  if (_length == 0)
+    return;
+
+  if (_entry.data_file) {
+    _read_raw(*_entry.data_file,
+              _entry.info.data_offset + _offset * _item_size,
+              _data,
+              _length * _item_size);
+    return;
+  }
+
+  if (lsda_lread(this->fhandle,
+                 _entry.info.type_id,
+                 (char*)&_entry.path[0],
+                 _offset,
+                 _length,
+                 _data) != _length)
+    throw(std::runtime_error("Error while reading " + _entry.path));
+}
+
+/** Find the entries of entity ids
+ *
+ * @param _ids_path : path to the ids variable, e.g. "/nodout/metadata/ids"
+ * @param _ids : ids to look up
+ * @param _nEntities : number of entities in the ids variable
+ * @return indexes : entry of each id
+ */
+std::vector<size_t>
+Binout::_resolve_ids(const std::string& _ids_path,
+                     const std::vector<int64_t>& _ids,
+                     size_t& _nEntities)
+{
+  if (_ids.empty())
+    throw(std::invalid_argument("No ids given."));
+
+  LSDA_VarInfo info;
+  _query_variable(_ids_path, info);
+  _nEntities = info.length;
+
+  std::vector<int64_t> all_ids(_nEntities);
+  read_variable<int64_t>(_ids_path, all_ids.data(), all_ids.size());
+
+  std::unordered_map<int64_t, size_t> id_to_index;
+  id_to_index.reserve(all_ids.size());
+  for (size_t iEntity = 0; iEntity < all_ids.size(); ++iEntity)
+    id_to_index.insert(std::make_pair(all_ids[iEntity], iEntity));
+
+  std::vector<size_t> indexes(_ids.size());
+  for (size_t iId = 0; iId < _ids.size(); ++iId) {
+    auto it = id_to_index.find(_ids[iId]);
+    if (it == id_to_index.end())
+      throw(std::invalid_argument("Id " + std::to_string(_ids[iId]) +
+                                  " not found in " + _ids_path));
+    indexes[iId] = it->second;
+  }
+
+  return indexes;
 }
 
 /** Perform a cd in the binout.
@@ -43,6 +451,7 @@ Binout::~Binout()
 void
 Binout::cd(const std::string& _path)
 {
+  std::lock_guard<std::recursive_mutex> lock(get_lsda_mutex());
 
   if (lsda_cd(this->fhandle, (char*)&_path[0]) == -1)
     throw(std::invalid_argument("Unexpected error during lsda_cd: " + _path));
@@ -56,6 +465,7 @@ Binout::cd(const std::string& _path)
 bool
 Binout::exists(const std::string& _path)
 {
+  std::lock_guard<std::recursive_mutex> lock(get_lsda_mutex());
   size_t length;
   int32_t type_id = 0;
   int32_t filenum = 0;
@@ -76,6 +486,7 @@ Binout::exists(const std::string& _path)
 bool
 Binout::has_children(const std::string& _path)
 {
+  std::lock_guard<std::recursive_mutex> lock(get_lsda_mutex());
   size_t length = 0;
   int32_t type_id = -1;
   int32_t filenum = -1;
@@ -99,6 +510,7 @@ Binout::has_children(const std::string& _path)
 bool
 Binout::is_variable(const std::string& _path)
 {
+  std::lock_guard<std::recursive_mutex> lock(get_lsda_mutex());
   size_t length = 0;
   int32_t type_id = -1;
   int32_t filenum = -1;
@@ -122,16 +534,28 @@ Binout::is_variable(const std::string& _path)
 Binout::EntryType
 Binout::get_type_id(std::string path)
 {
-
-  if (!this->exists(path))
-    throw(std::invalid_argument("path " + path + " does not exist."));
+  std::lock_guard<std::recursive_mutex> lock(get_lsda_mutex());
 
   size_t length = 0;
   int32_t type_id = -1;
   int32_t filenum = -1;
   lsda_queryvar(this->fhandle, &path[0], &type_id, &length, &filenum);
 
-  switch (type_id) {
+  if (type_id < 0)
+    throw(std::invalid_argument("path " + path + " does not exist."));
+
+  return _to_entry_type(type_id);
+}
+
+/** Convert an LSDA type id
+ *
+ * @param _type_id : LSDA type id
+ * @return entry_type
+ */
+Binout::EntryType
+Binout::_to_entry_type(int32_t _type_id)
+{
+  switch (_type_id) {
     case 0:
       return EntryType::DIRECTORY;
     case 1:
@@ -163,32 +587,554 @@ Binout::get_type_id(std::string path)
 
 /** get the labels in a directory in the binout
  * @param _path
- * @return list : list of names
+ * @return list : list of names (sorted)
+ *
+ * The list is cached per directory and stays valid as long as the binout.
  */
-std::vector<std::string>
+const std::vector<std::string>&
 Binout::get_children(const std::string& _path)
 {
-  LSDA_Length nChildren = 0; // == size_t
-  constexpr int follow = 0;
+  std::lock_guard<std::recursive_mutex> lock(get_lsda_mutex());
+
+  // relative paths depend on the current directory
+  auto key = !_path.empty() && _path[0] == '/'
+               ? _path
+               : std::string(lsda_getpwd(this->fhandle)) + '/' + _path;
+
+  auto it = children_cache.find(key);
+  if (it != children_cache.end())
+    return it->second;
+
+  std::vector<std::string> children;
+  visit_children(_path, [&children](const char* _name) {
+    children.emplace_back(_name);
+  });
+
+  return children_cache.emplace(key, std::move(children)).first->second;
+}
+
+/** Find the directories of a variable series
+ *
+ * @param _path_pattern : e.g. "/nodout/d*" + "/x_displacement"
+ * @param _dir : directory containing the matching directories
+ * @param _var_name : name of the variable in each directory
+ * @return subdirs : names of the matching directories (sorted)
+ *
+ * Throws if the pattern is malformed or nothing matches.
+ */
+std::vector<std::string>
+Binout::_match_series(const std::string& _path_pattern,
+                      std::string& _dir,
+                      std::string& _var_name)
+{
+  auto var_start = _path_pattern.rfind('/');
+  auto subdir_start = var_start == std::string::npos || var_start == 0
+                        ? std::string::npos
+                        : _path_pattern.rfind('/', var_start - 1);
+
+  if (subdir_start == std::string::npos)
+    throw(std::invalid_argument(
+      "Path pattern " + _path_pattern +
+      " must look like directory/pattern/variable, e.g. /nodout/d*/x"));
+
+  _dir = subdir_start == 0 ? "/" : _path_pattern.substr(0, subdir_start);
+  auto subdir_pattern =
+    _path_pattern.substr(subdir_start + 1, var_start - subdir_start - 1);
+  _var_name = _path_pattern.substr(var_start + 1);
+
+  if (_var_name.empty() || subdir_pattern.empty() ||
+      _dir.find_first_of("*?") != std::string::npos ||
+      _var_name.find_first_of("*?") != std::string::npos)
+    throw(std::invalid_argument(
+      "Path pattern " + _path_pattern +
+      " may only contain wildcards in the directory above the variable."));
+
+  std::vector<std::string> subdirs;
+  for (auto& child : this->get_children(_dir))
+    if (glob_match(child, subdir_pattern))
+      subdirs.push_back(child);
+
+  if (subdirs.empty())
+    throw(std::invalid_argument("No directory matches " + _path_pattern));
+
+  return subdirs;
+}
+
+/** Get the variable paths matching a series pattern
+ *
+ * @param _path_pattern : e.g. "/nodout/d*" + "/x_displacement"
+ * @return paths : paths of the variables (sorted)
+ *
+ * These are the variables read by read_variable_series.
+ */
+std::vector<std::string>
+Binout::get_series_paths(const std::string& _path_pattern)
+{
+  std::lock_guard<std::recursive_mutex> lock(get_lsda_mutex());
+  std::string dir;
+  std::string var_name;
+  auto subdirs = _match_series(_path_pattern, dir, var_name);
+
+  const auto dir_prefix = dir.back() == '/' ? dir : dir + '/';
+  for (auto& subdir : subdirs)
+    subdir = dir_prefix + subdir + "/" + var_name;
+
+  return subdirs;
+}
+
+#ifdef QD_USE_HDF5
+
+namespace {
+
+// chunks of 1 MiB fit into the default chunk cache of HDF5
+constexpr size_t hdf5_chunk_bytes = 1 << 20;
+// entities per chunk, so that time histories are read in few chunks
+constexpr size_t hdf5_chunk_cols = 1024;
+// smaller datasets are written without chunks and compression
+constexpr size_t hdf5_min_chunked_bytes = 4096;
+// compressed data waiting to be written
+constexpr size_t hdf5_max_pending_bytes = 256 << 20;
+
+// the HDF5 library is not thread-safe, thus exports run one at a time
+std::mutex hdf5_mutex;
+
+struct HDF5Chunk
+{
+  std::vector<char> bytes;
+  uint32_t filter_mask; // 1 if stored without deflate
+};
+
+/** Copy a chunk of a row major matrix and deflate it
+ *
+ * @param _data : matrix data
+ * @param _nRows : rows of the matrix
+ * @param _nCols : columns of the matrix
+ * @param _iRow : first row of the chunk
+ * @param _iCol : first column of the chunk
+ * @param _chunk_rows : rows of a chunk
+ * @param _chunk_cols : columns of a chunk
+ * @param _level : zlib compression level
+ * @return chunk : chunk as stored by the HDF5 deflate filter
+ *
+ * Chunks at the border are padded, HDF5 always stores full chunks.
+ */
+template<typename T>
+HDF5Chunk
+compress_chunk(const T* _data,
+               size_t _nRows,
+               size_t _nCols,
+               size_t _iRow,
+               size_t _iCol,
+               size_t _chunk_rows,
+               size_t _chunk_cols,
+               int _level)
+{
+  std::vector<char> raw(_chunk_rows * _chunk_cols * sizeof(T), 0);
+  const auto nChunkRows = std::min(_chunk_rows, _nRows - _iRow);
+  const auto nChunkCols = std::min(_chunk_cols, _nCols - _iCol);
+  for (size_t iRow = 0; iRow < nChunkRows; ++iRow)
+    std::memcpy(&raw[iRow * _chunk_cols * sizeof(T)],
+                _data + (_iRow + iRow) * _nCols + _iCol,
+                nChunkCols * sizeof(T));
+
+  HDF5Chunk chunk;
+  uLongf nCompressed = compressBound(static_cast<uLong>(raw.size()));
+  chunk.bytes.resize(nCompressed);
+  if (compress2(reinterpret_cast<Bytef*>(chunk.bytes.data()),
+                &nCompressed,
+                reinterpret_cast<const Bytef*>(raw.data()),
+                static_cast<uLong>(raw.size()),
+                _level) == Z_OK &&
+      nCompressed < raw.size()) {
+    chunk.bytes.resize(nCompressed);
+    chunk.filter_mask = 0;
+  } else {
+    chunk.bytes = std::move(raw);
+    chunk.filter_mask = 1;
+  }
+  return chunk;
+}
+
+/** Writes datasets whose chunks are compressed on a thread pool
+ *
+ * HDF5 is not thread-safe, thus datasets are created and chunks are
+ * written by the calling thread in order, only deflate runs in parallel.
+ */
+class HDF5ChunkWriter
+{
+private:
+  struct PendingDataset
+  {
+    H5::DataSet dataset;
+    std::vector<std::vector<hsize_t>> offsets;
+    std::vector<std::future<HDF5Chunk>> chunks;
+    size_t nBytes;
+  };
+
+  int compression_level;
+  std::deque<PendingDataset> pending;
+  size_t pending_bytes;
+  WorkQueue work_queue;
+
+  void _write_front();
+
+public:
+  HDF5ChunkWriter(int _compression_level, size_t _n_threads);
+  template<typename T>
+  void write(H5::Group& _group,
+             const std::string& _name,
+             Tensor_ptr<T> _tensor);
+  void flush();
+};
+
+/** Create a chunk writer
+ *
+ * @param _compression_level : zlib level, 0 disables compression
+ * @param _n_threads : compression threads, 0 uses all cores
+ */
+HDF5ChunkWriter::HDF5ChunkWriter(int _compression_level, size_t _n_threads)
+  : compression_level(_compression_level)
+  , pending_bytes(0)
+{
+  if (_n_threads == 0)
+    _n_threads = std::max(1u, std::thread::hardware_concurrency());
+  work_queue.init_workers(_n_threads);
+}
+
+/** Write a tensor as dataset
+ *
+ * @param _group : group to create the dataset in
+ * @param _name : name of the dataset
+ * @param _tensor : tensor with one or two dimensions
+ *
+ * The chunks are compressed in the background. The data is written
+ * once too much compressed data piled up or on flush.
+ */
+template<typename T>
+void
+HDF5ChunkWriter::write(H5::Group& _group,
+                       const std::string& _name,
+                       Tensor_ptr<T> _tensor)
+{
+  const auto& shape = _tensor->get_shape();
+  const auto& data = _tensor->get_data();
+  const auto rank = static_cast<int>(shape.size());
+  const auto type = get_hdf5_type<T>();
+
+  std::vector<hsize_t> dims(shape.begin(), shape.end());
+  H5::DataSpace dataspace(rank, dims.data());
+
+  const size_t nBytes = data.size() * sizeof(T);
+  if (compression_level <= 0 || nBytes < hdf5_min_chunked_bytes) {
+    auto dataset = _group.createDataSet(_name, type, dataspace);
+    if (!data.empty())
+      dataset.write(data.data(), type);
+    return;
+  }
+
+  // a vector is a matrix with a single row
+  const size_t nCols = shape.back();
+  const size_t nRows = data.size() / nCols;
+  const size_t chunk_cols =
+    rank == 1 ? std::min(nCols, hdf5_chunk_bytes / sizeof(T))
+              : std::min(nCols, hdf5_chunk_cols);
+  const size_t chunk_rows =
+    std::min(nRows,
+             std::max<size_t>(1, hdf5_chunk_bytes / sizeof(T) / chunk_cols));
+
+  std::vector<hsize_t> chunk_dims = { chunk_rows, chunk_cols };
+  if (rank == 1)
+    chunk_dims.erase(chunk_dims.begin());
+
+  H5::DSetCreatPropList plist;
+  plist.setChunk(rank, chunk_dims.data());
+  plist.setDeflate(compression_level);
+
+  PendingDataset entry;
+  entry.dataset = _group.createDataSet(_name, type, dataspace, plist);
+  entry.nBytes = nBytes;
+
+  const auto level = compression_level;
+  for (size_t iRow = 0; iRow < nRows; iRow += chunk_rows) {
+    for (size_t iCol = 0; iCol < nCols; iCol += chunk_cols) {
+      if (rank == 1)
+        entry.offsets.push_back({ iCol });
+      else
+        entry.offsets.push_back({ iRow, iCol });
+      entry.chunks.push_back(work_queue.submit([=]() {
+        return compress_chunk(_tensor->get_data().data(),
+                              nRows,
+                              nCols,
+                              iRow,
+                              iCol,
+                              chunk_rows,
+                              chunk_cols,
+                              level);
+      }));
+    }
+  }
+
+  pending_bytes += nBytes;
+  pending.push_back(std::move(entry));
+  while (pending_bytes > hdf5_max_pending_bytes)
+    _write_front();
+}
+
+/** Write the chunks of the oldest pending dataset
+ */
+void
+HDF5ChunkWriter::_write_front()
+{
+  auto& entry = pending.front();
+  for (size_t iChunk = 0; iChunk < entry.chunks.size(); ++iChunk) {
+    auto chunk = entry.chunks[iChunk].get();
+    if (H5Dwrite_chunk(entry.dataset.getId(),
+                       H5P_DEFAULT,
+                       chunk.filter_mask,
+                       entry.offsets[iChunk].data(),
+                       chunk.bytes.size(),
+                       chunk.bytes.data()) < 0)
+      throw(std::runtime_error("Error while writing an HDF5 chunk."));
+  }
+  pending_bytes -= entry.nBytes;
+  pending.pop_front();
+}
+
+/** Write all pending datasets
+ */
+void
+HDF5ChunkWriter::flush()
+{
+  while (!pending.empty())
+    _write_front();
+}
+
+/** Join a binout directory and an entry name
+ */
+std::string
+join_binout_path(const std::string& _dir, const std::string& _name)
+{
+  return _dir.back() == '/' ? _dir + _name : _dir + '/' + _name;
+}
+
+/** Check whether a directory holds a state, e.g. d000001
+ */
+bool
+is_state_name(const std::string& _name)
+{
+  return _name.size() > 1 && _name[0] == 'd' &&
+         std::all_of(_name.begin() + 1, _name.end(), [](char c) {
+           return c >= '0' && c <= '9';
+         });
+}
+
+/** Export a variable or a variable over all states
+ *
+ * @param _states : states of the directory or empty for a single variable
+ * @return success : false if the variable is not the same in all states
+ */
+template<typename T>
+bool
+hdf5_export_variable(Binout& _binout,
+                     HDF5ChunkWriter& _writer,
+                     H5::Group& _group,
+                     const std::string& _dir,
+                     const std::vector<std::string>& _states,
+                     const std::string& _name)
+{
+  if (_states.empty()) {
+    _writer.write(
+      _group, _name, _binout.read_variable<T>(join_binout_path(_dir, _name)));
+    return true;
+  }
+
+  Tensor_ptr<T> tensor;
+  try {
+    tensor = _binout.read_variable_series<T>(_dir, _states, _name);
+  } catch (const std::exception&) {
+    return false;
+  }
+  _writer.write(_group, _name, tensor);
+  return true;
+}
+
+/** Export a variable of any type, see hdf5_export_variable
+ *
+ * Links and unknown entries are skipped.
+ */
+bool
+hdf5_export_entry(Binout::EntryType _type,
+                  Binout& _binout,
+                  HDF5ChunkWriter& _writer,
+                  H5::Group& _group,
+                  const std::string& _dir,
+                  const std::vector<std::string>& _states,
+                  const std::string& _name)
+{
+  switch (_type) {
+    case Binout::EntryType::INT8:
+      return hdf5_export_variable<int8_t>(
+        _binout, _writer, _group, _dir, _states, _name);
+    case Binout::EntryType::INT16:
+      return hdf5_export_variable<int16_t>(
+        _binout, _writer, _group, _dir, _states, _name);
+    case Binout::EntryType::INT32:
+      return hdf5_export_variable<int32_t>(
+        _binout, _writer, _group, _dir, _states, _name);
+    case Binout::EntryType::INT64:
+      return hdf5_export_variable<int64_t>(
+        _binout, _writer, _group, _dir, _states, _name);
+    case Binout::EntryType::UINT8:
+      return hdf5_export_variable<uint8_t>(
+        _binout, _writer, _group, _dir, _states, _name);
+    case Binout::EntryType::UINT16:
+      return hdf5_export_variable<uint16_t>(
+        _binout, _writer, _group, _dir, _states, _name);
+    case Binout::EntryType::UINT32:
+      return hdf5_export_variable<uint32_t>(
+        _binout, _writer, _group, _dir, _states, _name);
+    case Binout::EntryType::UINT64:
+      return hdf5_export_variable<uint64_t>(
+        _binout, _writer, _group, _dir, _states, _name);
+    case Binout::EntryType::FLOAT32:
+      return hdf5_export_variable<float>(
+        _binout, _writer, _group, _dir, _states, _name);
+    case Binout::EntryType::FLOAT64:
+      return hdf5_export_variable<double>(
+        _binout, _writer, _group, _dir, _states, _name);
+    default:
+      return true;
+  }
+}
+
+/** Export a binout directory into an HDF5 group
+ *
+ * @param _binout : binout to export
+ * @param _writer : writer for the datasets
+ * @param _group : group corresponding to the directory
+ * @param _dir : binout directory
+ *
+ * The state directories (d000001, ...) are merged: every variable
+ * becomes one dataset of shape (nStates, length). Variables which are
+ * missing in some states or change their length stay per state.
+ */
+void
+hdf5_export_directory(Binout& _binout,
+                      HDF5ChunkWriter& _writer,
+                      H5::Group& _group,
+                      const std::string& _dir)
+{
+  const std::vector<std::string> no_states;
+  std::vector<std::string> states;
+
+  for (const auto& child : _binout.get_children(_dir)) {
+    if (is_state_name(child)) {
+      states.push_back(child);
+      continue;
+    }
+
+    const auto path = join_binout_path(_dir, child);
+    const auto type = _binout.get_type_id(path);
+    if (type == Binout::EntryType::DIRECTORY) {
+      auto subgroup = _group.createGroup(child);
+      hdf5_export_directory(_binout, _writer, subgroup, path);
+    } else {
+      hdf5_export_entry(type, _binout, _writer, _group, _dir, no_states, child);
+    }
+  }
+
+  if (states.empty())
+    return;
+
+  // variables of all states
+  std::vector<std::string> names;
+  for (const auto& state : states) {
+    auto state_names = _binout.get_children(join_binout_path(_dir, state));
+    names.insert(names.end(), state_names.begin(), state_names.end());
+  }
+  std::sort(names.begin(), names.end());
+  names.erase(std::unique(names.begin(), names.end()), names.end());
 
-  char** names = lsda_get_children_names(
-    this->fhandle, (char*)&_path[0], follow, &nChildren);
+  std::vector<std::string> irregular_names;
+  const auto first_state = join_binout_path(_dir, states[0]);
+  for (const auto& name : names) {
+    const auto path = join_binout_path(first_state, name);
+    if (!_binout.exists(path) ||
+        H5Lexists(_group.getId(), name.c_str(), H5P_DEFAULT) > 0) {
+      irregular_names.push_back(name);
+      continue;
+    }
 
-  // bad stuff happened
-  if (names == nullptr || nChildren == 0) {
-    return std::vector<std::string>();
+    const auto type = _binout.get_type_id(path);
+    if (type == Binout::EntryType::DIRECTORY ||
+        !hdf5_export_entry(type, _binout, _writer, _group, _dir, states, name))
+      irregular_names.push_back(name);
   }
 
-  // copy
-  auto ret = std::vector<std::string>(names, names + nChildren);
+  if (irregular_names.empty())
+    return;
 
-  // delete ... I don't like C
-  for (LSDA_Length iChild = 0; iChild < nChildren; ++iChild)
-    delete[] names[iChild];
-  delete[] names;
+  for (const auto& state : states) {
+    const auto state_dir = join_binout_path(_dir, state);
+    auto state_group = _group.createGroup(state);
+    for (const auto& name : irregular_names) {
+      const auto path = join_binout_path(state_dir, name);
+      if (!_binout.exists(path))
+        continue;
 
-  // return
-  return ret;
+      const auto type = _binout.get_type_id(path);
+      if (type == Binout::EntryType::DIRECTORY) {
+        auto subgroup = state_group.createGroup(name);
+        hdf5_export_directory(_binout, _writer, subgroup, path);
+      } else {
+        hdf5_export_entry(
+          type, _binout, _writer, state_group, state_dir, no_states, name);
+      }
+    }
+  }
+}
+
+} // namespace
+
+/** Save the binout as HDF5 file
+ *
+ * @param _filepath : path of the HDF5 file, an existing file is replaced
+ * @param _compression_level : deflate level from 0 (off) to 9
+ * @param _n_threads : threads for compression, 0 uses all cores
+ *
+ * The directory tree is kept, but the states of a directory are merged
+ * into datasets of shape (nStates, length), e.g. "/nodout/x_displacement".
+ * These are chunked by time and entity, so that both a single state and
+ * the time history of some entities read only a few chunks.
+ *
+ * The LSDA lock is only taken per read variable, thus other threads
+ * may read from binouts while the export compresses and writes.
+ */
+void
+Binout::save_hdf5(const std::string& _filepath,
+                  int _compression_level,
+                  size_t _n_threads)
+{
+  if (_compression_level < 0 || _compression_level > 9)
+    throw(std::invalid_argument(
+      "The compression level must be between 0 and 9."));
+
+  std::lock_guard<std::mutex> lock(hdf5_mutex);
+  try {
+    H5::Exception::dontPrint();
+
+    auto file = open_hdf5(_filepath, true);
+    auto root = file.openGroup("/");
+    HDF5ChunkWriter writer(_compression_level, _n_threads);
+    hdf5_export_directory(*this, writer, root, "/");
+    writer.flush();
+
+  } catch (const H5::Exception& error) {
+    throw(std::runtime_error("Error while writing HDF5 file " + _filepath +
+                             ": " + error.getDetailMsg()));
+  }
 }
 
+#endif // QD_USE_HDF5
+
 } // namespace qd
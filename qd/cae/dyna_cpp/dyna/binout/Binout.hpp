@@ -2,9 +2,14 @@
 #ifndef BINOUT_HPP
 #define BINOUT_HPP
 
+#include <algorithm>
 #include <cstdint>
+#include <exception>
 #include <memory>
+#include <mutex>
 #include <string>
+#include <type_traits>
+#include <unordered_map>
 #include <vector>
 
 extern "C"
@@ -16,6 +21,13 @@ extern "C"
 
 namespace qd {
 
+/** Reader for binout files
+ *
+ * All functions may be called from several threads. The LSDA library
+ * keeps global state, thus its calls are serialized by one lock for all
+ * binouts. Plain variable data is copied from memory mapped files
+ * outside of the lock.
+ */
 class Binout
 {
 public:
@@ -40,22 +52,148 @@ private:
   int fhandle;
   std::string filepath;
 
+  // files of the binout family opened for raw reads
+  struct DataFile
+  {
+    int fd;
+    const char* mapping; // whole file mapped into memory (if possible)
+    size_t mapping_size;
+  };
+  std::vector<std::unique_ptr<DataFile>> data_files; // by file number
+
+  // sorted children per directory (the file is read only)
+  std::unordered_map<std::string, std::vector<std::string>> children_cache;
+
+  static std::recursive_mutex& get_lsda_mutex();
+  int _open_index(const std::string& _index_filepath);
+  const DataFile* _locate_data(const LSDA_VarInfo& _info);
+  static void _read_raw(const DataFile& _file,
+                        size_t _offset,
+                        void* _data,
+                        size_t _nBytes);
+  EntryType _query_variable(const std::string& _path, LSDA_VarInfo& _info);
+  void _read_variable_data(std::unique_lock<std::recursive_mutex>& _lock,
+                           const std::string& _path,
+                           const LSDA_VarInfo& _info,
+                           size_t _item_size,
+                           void* _data);
+  // a variable of a series, located under the lock and read without it
+  struct SeriesEntry
+  {
+    std::string path;
+    LSDA_VarInfo info;
+    const DataFile* data_file; // nullptr if read through the library
+  };
+  std::vector<SeriesEntry> _locate_series(
+    const std::string& _dir,
+    const std::vector<std::string>& _subdirs,
+    const std::string& _var_name);
+  template<typename T>
+  void _check_series(const std::vector<SeriesEntry>& _entries);
+  template<typename F>
+  void _read_series(std::unique_lock<std::recursive_mutex>& _lock,
+                    const std::vector<SeriesEntry>& _entries,
+                    F _read_entry);
+  void _read_entry_range(const SeriesEntry& _entry,
+                         size_t _offset,
+                         size_t _length,
+                         size_t _item_size,
+                         void* _data);
+  std::vector<size_t> _resolve_ids(const std::string& _ids_path,
+                                   const std::vector<int64_t>& _ids,
+                                   size_t& _nEntities);
+  template<typename S, typename T>
+  void _read_converted(std::unique_lock<std::recursive_mutex>& _lock,
+                       const std::string& _path,
+                       const LSDA_VarInfo& _info,
+                       T* _buffer);
+
   template<typename T>
   bool _type_is_same(EntryType entry_type);
+  static EntryType _to_entry_type(int32_t _type_id);
+  std::vector<std::string> _match_series(const std::string& _path_pattern,
+                                         std::string& _dir,
+                                         std::string& _var_name);
 
 public:
-  Binout(const std::string& filepath);
+  Binout(const std::string& filepath, bool _use_index = false);
   ~Binout();
   void cd(const std::string& _path);
   bool exists(const std::string& _path);
   bool has_children(const std::string& _path);
   bool is_variable(const std::string& _path);
   EntryType get_type_id(std::string path);
-  std::vector<std::string> get_children(const std::string& _folder_name = ".");
+  template<typename F>
+  bool visit_children(const std::string& _path, F _visitor);
+  const std::vector<std::string>& get_children(
+    const std::string& _folder_name = ".");
+  std::vector<std::string> get_series_paths(const std::string& _path_pattern);
   template<typename T>
   Tensor_ptr<T> read_variable(const std::string& _path);
+  template<typename T>
+  size_t read_variable(const std::string& _path,
+                       T* _buffer,
+                       size_t _buffer_size);
+  template<typename T>
+  Tensor_ptr<T> read_variable_series(const std::string& _path_pattern);
+  template<typename T>
+  Tensor_ptr<T> read_variable_series(const std::string& _dir,
+                                     const std::vector<std::string>& _subdirs,
+                                     const std::string& _var_name);
+  template<typename T>
+  Tensor_ptr<T> read_variable_series(const std::string& _path_pattern,
+                                     const std::vector<int64_t>& _ids);
+#ifdef QD_USE_HDF5
+  void save_hdf5(const std::string& _filepath,
+                 int _compression_level = 4,
+                 size_t _n_threads = 0);
+#endif
 };
 
+/** Call a visitor with the name of each child of a directory
+ *
+ * @param _path : path of the directory
+ * @param _visitor : called with each name as const char*
+ * @return is_dir : false if the path is no directory
+ *
+ * The names are visited in ascending order straight from the symbol
+ * table and are only valid during the call. The visitor runs under the
+ * LSDA lock, thus it must not call into other binouts from other
+ * threads. Exceptions are passed on after the iteration stopped.
+ */
+template<typename F>
+bool
+Binout::visit_children(const std::string& _path, F _visitor)
+{
+  struct Visit
+  {
+    F& visitor;
+    std::exception_ptr error;
+  };
+  Visit visit{ _visitor, nullptr };
+
+  // no exceptions through the C library
+  auto callback = [](const char* _name, void* _user) -> int {
+    auto& visit = *static_cast<Visit*>(_user);
+    try {
+      visit.visitor(_name);
+    } catch (...) {
+      visit.error = std::current_exception();
+      return 1;
+    }
+    return 0;
+  };
+
+  std::lock_guard<std::recursive_mutex> lock(get_lsda_mutex());
+  int ret = lsda_visit_children(
+    this->fhandle, (char*)&_path[0], 0, callback, &visit);
+
+  if (visit.error)
+    std::rethrow_exception(visit.error);
+
+  return ret >= 0;
+}
+
 /** Check if LSDA type matches the C++ type
  *
  *  @param entry_type
@@ -92,63 +230,367 @@ Binout::_type_is_same(EntryType entry_type)
  *
  * @param path : path to the variable
  * @return tensor_ptr : tensor instance
+ *
+ * Thread-safe. Only the symbol table lookup is serialized, the data
+ * itself is read in parallel if possible.
  */
 template<typename T>
 Tensor_ptr<T>
 Binout::read_variable(const std::string& path)
 {
 
-  if (!this->exists(path))
-    throw(std::invalid_argument("Path " + path + " does not exist."));
-
-  if (!this->is_variable(path))
-    throw(
-      std::invalid_argument("Path " + path + " does not point to a variable."));
-
-  auto entry_type = this->get_type_id(path);
-  if (entry_type == EntryType::UNKNOWN)
-    throw(std::runtime_error("Path " + path +
-                             " caused an error in Binout.read_variable. This "
-                             "should never happen ..."));
-  else if (entry_type == EntryType::DIRECTORY)
-    throw(std::invalid_argument(
-      "Path " + path + " does point to a DIRECTORY and not to a variable."));
-  else if (entry_type == EntryType::LINK)
-    throw(std::invalid_argument(
-      "Path " + path + " does point to a LINK and not to a variable."));
-  else if (!this->_type_is_same<T>(entry_type))
+  std::unique_lock<std::recursive_mutex> lock(get_lsda_mutex());
+
+  LSDA_VarInfo info;
+  auto entry_type = _query_variable(path, info);
+  if (!this->_type_is_same<T>(entry_type))
     throw(std::runtime_error(
       "C++ Tensor type does not match Binout variable type."));
 
-  size_t length = 0;
-  int32_t type_id = -1;
-  int32_t filenum = -1;
-  lsda_queryvar(this->fhandle, (char*)&path[0], &type_id, &length, &filenum);
-  if (type_id < 0)
-    throw(std::invalid_argument(
-      "Binout.read_variable encountered an error on: " + path));
-
   auto tensor_ptr = std::make_shared<Tensor<T>>();
-  tensor_ptr->resize({ length });
+  tensor_ptr->resize({ info.length });
   auto& data = tensor_ptr->get_data();
+  _read_variable_data(lock, path, info, sizeof(T), &data[0]);
 
-  size_t ret = lsda_lread(this->fhandle,
-                          static_cast<int32_t>(type_id),
-                          (char*)&path[0],  // path
-                          0,                // offset
-                          length,           // length
-                          (void*)&data[0]); // data
+  return tensor_ptr;
+}
 
-  // I know this is dumb, but dyna defines an unsigned type with -1 in case of
-  // an error. Really need to fix this sometime ...
-  if (ret == (size_t)-1) {
-    throw(std::runtime_error(
-      "Error during lsda_realread and I have no clue what happened. Sry."));
+/** Read the variable data into a buffer
+ *
+ * @param _path : path to the variable
+ * @param _buffer : destination, e.g. a row of a bigger matrix
+ * @param _buffer_size : number of items fitting into the buffer
+ * @return length : number of items written
+ *
+ * Other numeric types than T are converted while reading, e.g. int32
+ * ids into doubles or doubles into floats. No memory is allocated.
+ */
+template<typename T>
+size_t
+Binout::read_variable(const std::string& _path, T* _buffer, size_t _buffer_size)
+{
+  static_assert(std::is_arithmetic<T>::value,
+                "Binout variables can only be read as numbers.");
+
+  std::unique_lock<std::recursive_mutex> lock(get_lsda_mutex());
+
+  LSDA_VarInfo info;
+  auto entry_type = _query_variable(_path, info);
+  const size_t length = info.length;
+  if (length > _buffer_size)
+    throw(std::invalid_argument("Buffer with " + std::to_string(_buffer_size) +
+                                " entries is too small for " + _path +
+                                " with " + std::to_string(length) +
+                                " entries."));
+
+  if (this->_type_is_same<T>(entry_type)) {
+    _read_variable_data(lock, _path, info, sizeof(T), _buffer);
+    return length;
+  }
+
+  switch (entry_type) {
+    case EntryType::INT8:
+      _read_converted<int8_t>(lock, _path, info, _buffer);
+      break;
+    case EntryType::INT16:
+      _read_converted<int16_t>(lock, _path, info, _buffer);
+      break;
+    case EntryType::INT32:
+      _read_converted<int32_t>(lock, _path, info, _buffer);
+      break;
+    case EntryType::INT64:
+      _read_converted<int64_t>(lock, _path, info, _buffer);
+      break;
+    case EntryType::UINT8:
+      _read_converted<uint8_t>(lock, _path, info, _buffer);
+      break;
+    case EntryType::UINT16:
+      _read_converted<uint16_t>(lock, _path, info, _buffer);
+      break;
+    case EntryType::UINT32:
+      _read_converted<uint32_t>(lock, _path, info, _buffer);
+      break;
+    case EntryType::UINT64:
+      _read_converted<uint64_t>(lock, _path, info, _buffer);
+      break;
+    case EntryType::FLOAT32:
+      _read_converted<float>(lock, _path, info, _buffer);
+      break;
+    case EntryType::FLOAT64:
+      _read_converted<double>(lock, _path, info, _buffer);
+      break;
+    default:
+      throw(std::runtime_error("Path " + _path +
+                               " has a type which can not be converted."));
+  }
+
+  return length;
+}
+
+/** Read a variable stored as S and convert it to T
+ *
+ * @param _lock : LSDA lock, released for raw reads
+ * @param _path : path to the variable
+ * @param _info : variable of type S looked up with _query_variable
+ * @param _buffer : destination
+ *
+ * The data is read in small blocks, which are converted right away.
+ */
+template<typename S, typename T>
+void
+Binout::_read_converted(std::unique_lock<std::recursive_mutex>& _lock,
+                        const std::string& _path,
+                        const LSDA_VarInfo& _info,
+                        T* _buffer)
+{
+  constexpr size_t block_size = 1024;
+  S block[block_size];
+
+  auto data_file = _locate_data(_info);
+  if (data_file)
+    _lock.unlock();
+
+  for (size_t iStart = 0; iStart < _info.length; iStart += block_size) {
+    const auto nItems = std::min(block_size, _info.length - iStart);
+
+    if (data_file) {
+      _read_raw(*data_file,
+                _info.data_offset + iStart * sizeof(S),
+                block,
+                nItems * sizeof(S));
+    } else if (lsda_lread(this->fhandle,
+                          _info.type_id,
+                          (char*)&_path[0],
+                          iStart,
+                          nItems,
+                          (void*)block) != nItems) {
+      throw(std::runtime_error("Error while reading " + _path));
+    }
+
+    for (size_t iItem = 0; iItem < nItems; ++iItem)
+      _buffer[iStart + iItem] = static_cast<T>(block[iItem]);
+  }
+}
+
+/** Read a variable from many directories at once, e.g. all states
+ *
+ * @param _path_pattern : path with a wildcard in the directory above the
+ *                        variable, e.g. "/nodout/d*" + "/x_displacement"
+ * @return tensor_ptr : tensor of shape (nDirectories, length)
+ *
+ * The directories are sorted by name. The symbol table is searched only
+ * once and the data is read in the order in which it lies in the file.
+ * All matching variables must have the same length.
+ */
+template<typename T>
+Tensor_ptr<T>
+Binout::read_variable_series(const std::string& _path_pattern)
+{
+
+  std::string dir;
+  std::string var_name;
+  std::vector<std::string> subdirs;
+  {
+    std::lock_guard<std::recursive_mutex> lock(get_lsda_mutex());
+    subdirs = _match_series(_path_pattern, dir, var_name);
   }
 
+  return read_variable_series<T>(dir, subdirs, var_name);
+}
+
+/** Read a variable from the given directories at once
+ *
+ * @param _dir : parent directory, e.g. "/nodout"
+ * @param _subdirs : directories in _dir containing the variable
+ * @param _var_name : name of the variable
+ * @return tensor_ptr : tensor of shape (nSubdirs, length)
+ *
+ * All variables must have the same length. Only the lookup of the
+ * variables is serialized, plain data is copied without the LSDA lock.
+ */
+template<typename T>
+Tensor_ptr<T>
+Binout::read_variable_series(const std::string& _dir,
+                             const std::vector<std::string>& _subdirs,
+                             const std::string& _var_name)
+{
+
+  std::unique_lock<std::recursive_mutex> lock(get_lsda_mutex());
+
+  if (_subdirs.empty())
+    throw(std::invalid_argument("No directories given to read " + _var_name +
+                                " from."));
+
+  auto entries = _locate_series(_dir, _subdirs, _var_name);
+  _check_series<T>(entries);
+
+  const size_t length = entries[0].info.length;
+  for (const auto& entry : entries)
+    if (entry.info.length != length)
+      throw(std::runtime_error("The length of " + entry.path +
+                               " differs from " + entries[0].path + "."));
+
+  auto tensor_ptr = std::make_shared<Tensor<T>>();
+  tensor_ptr->resize({ entries.size(), length });
+
+  T* data = tensor_ptr->get_data().data();
+  _read_series(lock, entries, [&](size_t iEntry) {
+    _read_entry_range(
+      entries[iEntry], 0, length, sizeof(T), data + iEntry * length);
+  });
+
   return tensor_ptr;
 }
 
+/** Read a variable from many directories only for some entities
+ *
+ * @param _path_pattern : e.g. "/nodout/d*" + "/x_displacement"
+ * @param _ids : ids of the entities, e.g. nodes
+ * @return tensor_ptr : tensor of shape (nDirectories, nIds) or
+ *                      (nDirectories, nIds, nValues) if the variable has
+ *                      several values per entity, e.g. integration points
+ *
+ * The ids are looked up once in "metadata/ids" next to the directories.
+ * Only the entries of the requested entities are read, thus neighbouring
+ * entities are cheaper than scattered ones.
+ */
+template<typename T>
+Tensor_ptr<T>
+Binout::read_variable_series(const std::string& _path_pattern,
+                             const std::vector<int64_t>& _ids)
+{
+
+  std::unique_lock<std::recursive_mutex> lock(get_lsda_mutex());
+
+  std::string dir;
+  std::string var_name;
+  auto subdirs = _match_series(_path_pattern, dir, var_name);
+  const auto dir_prefix = dir.empty() || dir.back() != '/' ? dir + '/' : dir;
+
+  size_t nEntities = 0;
+  auto indexes = _resolve_ids(dir_prefix + "metadata/ids", _ids, nEntities);
+
+  auto entries = _locate_series(dir, subdirs, var_name);
+  _check_series<T>(entries);
+
+  const size_t length = entries[0].info.length;
+  if (length == 0 || length % nEntities != 0)
+    throw(std::runtime_error("The length " + std::to_string(length) + " of " +
+                             entries[0].path +
+                             " does not fit to the number of ids " +
+                             std::to_string(nEntities) + "."));
+  for (const auto& entry : entries)
+    if (entry.info.length != length)
+      throw(std::runtime_error("The length of " + entry.path +
+                               " differs from the other directories."));
+  const size_t nValues = length / nEntities;
+
+  // requested entities in file order, each read once
+  auto entities = indexes;
+  std::sort(entities.begin(), entities.end());
+  entities.erase(std::unique(entities.begin(), entities.end()),
+                 entities.end());
+
+  std::vector<size_t> slots(indexes.size());
+  for (size_t iId = 0; iId < indexes.size(); ++iId)
+    slots[iId] = static_cast<size_t>(
+      std::lower_bound(entities.begin(), entities.end(), indexes[iId]) -
+      entities.begin());
+
+  auto tensor_ptr = std::make_shared<Tensor<T>>();
+  if (nValues == 1)
+    tensor_ptr->resize({ subdirs.size(), _ids.size() });
+  else
+    tensor_ptr->resize({ subdirs.size(), _ids.size(), nValues });
+
+  T* data = tensor_ptr->get_data().data();
+  std::vector<T> values(entities.size() * nValues);
+  _read_series(lock, entries, [&](size_t iEntry) {
+    // consecutive entities are read at once
+    for (size_t iStart = 0; iStart < entities.size();) {
+      size_t iEnd = iStart + 1;
+      while (iEnd < entities.size() &&
+             entities[iEnd] == entities[iEnd - 1] + 1)
+        ++iEnd;
+
+      _read_entry_range(entries[iEntry],
+                        entities[iStart] * nValues,
+                        (iEnd - iStart) * nValues,
+                        sizeof(T),
+                        &values[iStart * nValues]);
+      iStart = iEnd;
+    }
+
+    auto entry_data = data + iEntry * _ids.size() * nValues;
+    for (size_t iId = 0; iId < slots.size(); ++iId)
+      std::copy_n(
+        &values[slots[iId] * nValues], nValues, entry_data + iId * nValues);
+  });
+
+  return tensor_ptr;
+}
+
+/** Check that the variables of a series can be read as T
+ *
+ * @param _entries : variables located with _locate_series
+ */
+template<typename T>
+void
+Binout::_check_series(const std::vector<SeriesEntry>& _entries)
+{
+  for (const auto& entry : _entries) {
+    if (entry.info.type_id < 0)
+      throw(std::invalid_argument("Path " + entry.path + " does not exist."));
+    if (entry.info.type_id == 0)
+      throw(std::invalid_argument("Path " + entry.path +
+                                  " does not point to a variable."));
+    if (!this->_type_is_same<T>(_to_entry_type(entry.info.type_id)))
+      throw(std::runtime_error(
+        "C++ Tensor type does not match Binout variable type."));
+  }
+}
+
+/** Read the variables of a series
+ *
+ * @param _lock : LSDA lock, released for the plain data
+ * @param _entries : variables located with _locate_series
+ * @param _read_entry : called with the index of each entry to read it
+ *
+ * Entries which can not be copied as they are go through the library
+ * first, still under the lock. The plain data is read afterwards in
+ * file order without the lock, thus series of several threads or
+ * binouts are read in parallel.
+ */
+template<typename F>
+void
+Binout::_read_series(std::unique_lock<std::recursive_mutex>& _lock,
+                     const std::vector<SeriesEntry>& _entries,
+                     F _read_entry)
+{
+  std::vector<size_t> plain_entries;
+  plain_entries.reserve(_entries.size());
+  for (size_t iEntry = 0; iEntry < _entries.size(); ++iEntry) {
+    if (_entries[iEntry].data_file)
+      plain_entries.push_back(iEntry);
+    else
+      _read_entry(iEntry);
+  }
+
+  std::sort(plain_entries.begin(),
+            plain_entries.end(),
+            [&_entries](size_t _iEntry1, size_t _iEntry2) {
+              const auto& info1 = _entries[_iEntry1].info;
+              const auto& info2 = _entries[_iEntry2].info;
+              return info1.file_number != info2.file_number
+                       ? info1.file_number < info2.file_number
+                       : info1.data_offset < info2.data_offset;
+            });
+
+  _lock.unlock();
+  for (auto iEntry : plain_entries)
+    _read_entry(iEntry);
+}
+
 } // namespace qd
 
 #endif // Binout
@@ -714,6 +714,31 @@ next:
   return ret;
 }
 
+int BT_visit(void *bti, BT_VisitFunc *func, void *user)
+{
+/*
+  Call func for each entry of the tree in ascending sort order, without
+  allocating anything and without touching the enumeration state.  Stops
+  early if func returns nonzero, and returns that value (else 0).
+*/
+  BTREE *bt = (BTREE *) bti;
+  NODE *stack[STACK_SIZE];
+  NODE *node;
+  int top=0,ret;
+
+  node = bt->head;
+  while(node || top > 0) {
+    while(node) {
+      stack[top++] = node;
+      node = node->left;
+    }
+    node = stack[--top];
+    if((ret = func(node->data,user)) != 0) return ret;
+    node = node->right;
+  }
+  return 0;
+}
+
 STATIC void BT_free_node(BTREE *bt, NODE *node)
 {
 /*
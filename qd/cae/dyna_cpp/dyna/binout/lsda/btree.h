@@ -2,6 +2,7 @@
 extern "C"{
 #endif
 typedef int BT_CompFunc(void *,void *);
+typedef int BT_VisitFunc(void *,void *);
 void *BT_new(BT_CompFunc *compare);
 #define BT_store(a,b) BT_lookup((a),(b),1)
 void BT_delete(void *bt, void *key);
@@ -11,6 +12,7 @@ void *BT_enumerate(void *bt, int *cont);
 void BT_flush(void *bt);
 void BT_free(void *bt);
 void **BT_list(void *bt);
+int BT_visit(void *bt, BT_VisitFunc *func, void *user);
 #ifdef __cplusplus
 }
 #endif
@@ -23,6 +23,7 @@ pass in a series of distinct base file names, and you want to open EVERYTHING
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <sys/stat.h>
 #include <sys/types.h>
 #if !defined _WIN32 && !defined WIN64 && !defined MPPWIN
 #include <dirent.h>
@@ -1316,6 +1317,50 @@ CreateTypeAlias(LSDAFile* daf, char* alias, char* oldtype)
   otype = daf->FindType(daf, oldtype);
   ntype->alias = otype;
 }
+/*
+  Set up the sizes and conversion functions of a file from its header
+*/
+static void
+init_ifile(LSDAFile* daf, IFile* ifile, unsigned char* header)
+{
+  char tname[8];
+  LSDAType *type1, *type2;
+
+  ifile->FileLengthSize = header[1];
+  ifile->FileOffsetSize = header[2];
+  ifile->FileCommandSize = header[3];
+  ifile->FileTypeIDSize = header[4];
+  ifile->bigendian = header[5];
+  ifile->fp_format = header[6];
+  lsda_createbasictypes(daf);
+  /*
+    Set conversion functions for length, offset, etc
+  */
+  sprintf(tname, "I*%d", ifile->FileLengthSize);
+  type1 = daf->FindType(daf, tname);
+  sprintf(tname, "I*%d", (int)sizeof(Length));
+  type2 = daf->FindType(daf, tname);
+  ifile->ConvertLength = GetConversionFunction(ifile, type1, type2);
+
+  sprintf(tname, "I*%d", ifile->FileOffsetSize);
+  type1 = daf->FindType(daf, tname);
+  sprintf(tname, "I*%d", (int)sizeof(Offset));
+  type2 = daf->FindType(daf, tname);
+  ifile->ConvertOffset = GetConversionFunction(ifile, type1, type2);
+
+  sprintf(tname, "I*%d", ifile->FileCommandSize);
+  type1 = daf->FindType(daf, tname);
+  sprintf(tname, "I*%d", (int)sizeof(Command));
+  type2 = daf->FindType(daf, tname);
+  ifile->ConvertCommand = GetConversionFunction(ifile, type1, type2);
+
+  sprintf(tname, "I*%d", ifile->FileTypeIDSize);
+  type1 = daf->FindType(daf, tname);
+  sprintf(tname, "I*%d", (int)sizeof(TypeID));
+  type2 = daf->FindType(daf, tname);
+  ifile->ConvertTypeID = GetConversionFunction(ifile, type1, type2);
+}
+
 STATIC int
 read_initialize(LSDAFile* daf, int keepst)
 {
@@ -1325,9 +1370,7 @@ read_initialize(LSDAFile* daf, int keepst)
     sure the file is valid.
   */
   unsigned char header[8];
-  char tname[8];
   Command cmd;
-  LSDAType *type1, *type2;
   char *name, fullname[1024];
   char base_directory[2048];
   IFile* ifile;
@@ -1424,39 +1467,7 @@ read_initialize(LSDAFile* daf, int keepst)
         continue;
       }
 
-      ifile->FileLengthSize = header[1];
-      ifile->FileOffsetSize = header[2];
-      ifile->FileCommandSize = header[3];
-      ifile->FileTypeIDSize = header[4];
-      ifile->bigendian = header[5];
-      ifile->fp_format = header[6];
-      lsda_createbasictypes(daf);
-      /*
-        Set conversion functions for length, offset, etc
-      */
-      sprintf(tname, "I*%d", ifile->FileLengthSize);
-      type1 = daf->FindType(daf, tname);
-      sprintf(tname, "I*%d", (int)sizeof(Length));
-      type2 = daf->FindType(daf, tname);
-      ifile->ConvertLength = GetConversionFunction(ifile, type1, type2);
-
-      sprintf(tname, "I*%d", ifile->FileOffsetSize);
-      type1 = daf->FindType(daf, tname);
-      sprintf(tname, "I*%d", (int)sizeof(Offset));
-      type2 = daf->FindType(daf, tname);
-      ifile->ConvertOffset = GetConversionFunction(ifile, type1, type2);
-
-      sprintf(tname, "I*%d", ifile->FileCommandSize);
-      type1 = daf->FindType(daf, tname);
-      sprintf(tname, "I*%d", (int)sizeof(Command));
-      type2 = daf->FindType(daf, tname);
-      ifile->ConvertCommand = GetConversionFunction(ifile, type1, type2);
-
-      sprintf(tname, "I*%d", ifile->FileTypeIDSize);
-      type1 = daf->FindType(daf, tname);
-      sprintf(tname, "I*%d", (int)sizeof(TypeID));
-      type2 = daf->FindType(daf, tname);
-      ifile->ConvertTypeID = GetConversionFunction(ifile, type1, type2);
+      init_ifile(daf, ifile, header);
 
       /*
         Read in symbol table
@@ -2576,73 +2587,27 @@ LSDAresolve_link(LSDAFile* daf, LSDATable* varin)
   }
 }
 
+/*
+  Read data of a variable whose symbol table entry is already known.
+  Shared by lsda_realread and the qd additions.
+*/
 static Length
-lsda_realread(int handle,
-              int type_id,
-              char* name,
-              Length offset,
-              Length number,
-              void* data,
-              int follow)
+lsda_readvar(LSDAFile* daf,
+             LSDAType* type,
+             LSDATable* var,
+             Length offset,
+             Length number,
+             void* data)
 {
-  LSDAFile* daf;
-  LSDAType* type;
   _CF Convert;
   int tsize;
   Offset foffset;
   Length ret;
   char buf[BUFSIZE], *cp;
-  LSDATable* var;
   int tsizedisk;
   int k, kk, perbuf;
   Offset doff;
 
-  if (handle < 0 || handle >= num_daf) {
-    _errno = ERR_NOFILE;
-    if (report_level > 0)
-      fprintf(stderr, "lsda_read: invalid handle %d", handle);
-    return -1;
-  }
-  if (number == 0)
-    return 0;
-  daf = da_store + handle;
-  type = daf->FindTypeByID(daf, type_id);
-
-  if (type == NULL) {
-    _errno = ERR_DATATYPE;
-    if (report_level > 0) {
-      fprintf(stderr, "lsda_read: unrecognized data type %d", type_id);
-      fprintf(stderr,
-              " while reading file %s\n",
-              daf->ifr ? daf->ifr->filename : NULL);
-    }
-    return -1;
-  }
-  /*
-    If file is write/read mode, flush stuff out to the file before we do a seek.
-  */
-  if (daf->npend)
-    WriteData(NULL, 1, 0, daf, 1);
-  if (daf->continued) {
-    if (closeout_var(daf) < 0)
-      return -1;
-  }
-  /*
-    get var info from symbol table: size of each item, starting offset
-  */
-  var = daf->FindVar(daf, name, 0, follow);
-  if (var == NULL) {
-    _errno = ERR_NOVAR;
-    if (report_level > 0)
-      fprintf(
-        stderr,
-        "lsda_read: variable %s not found while reading file %s\n CWD=%s\n",
-        name,
-        daf->ifr ? daf->ifr->filename : NULL,
-        daf->GetCWD(daf));
-    return -1;
-  }
-
   if (offset >= var->length)
     return 0;
   if (offset + number > var->length)
@@ -2657,7 +2622,7 @@ lsda_realread(int handle,
     fprintf(stderr,
             "Error: reading varaible %s/%s from LSDA file %s:",
             daf->GetCWD(daf),
-            name,
+            var->name,
             daf->ifr->filename);
     fprintf(stderr,
             "       File is encrypted and variable size does not divide 16\n");
@@ -2815,6 +2780,69 @@ lsda_realread(int handle,
   }
   return ret;
 }
+
+static Length
+lsda_realread(int handle,
+              int type_id,
+              char* name,
+              Length offset,
+              Length number,
+              void* data,
+              int follow)
+{
+  LSDAFile* daf;
+  LSDAType* type;
+  LSDATable* var;
+
+  if (handle < 0 || handle >= num_daf) {
+    _errno = ERR_NOFILE;
+    if (report_level > 0)
+      fprintf(stderr, "lsda_read: invalid handle %d", handle);
+    return -1;
+  }
+  if (number == 0)
+    return 0;
+  daf = da_store + handle;
+  type = daf->FindTypeByID(daf, type_id);
+
+  if (type == NULL) {
+    _errno = ERR_DATATYPE;
+    if (report_level > 0) {
+      fprintf(stderr, "lsda_read: unrecognized data type %d", type_id);
+      fprintf(stderr,
+              " while reading file %s\n",
+              daf->ifr ? daf->ifr->filename : NULL);
+    }
+    return -1;
+  }
+  /*
+    If file is write/read mode, flush stuff out to the file before we do a seek.
+  */
+  if (daf->npend)
+    WriteData(NULL, 1, 0, daf, 1);
+  if (daf->continued) {
+    if (closeout_var(daf) < 0)
+      return -1;
+  }
+  /*
+    get var info from symbol table: size of each item, starting offset
+  */
+  var = daf->FindVar(daf, name, 0, follow);
+  if (var == NULL) {
+    _errno = ERR_NOVAR;
+    if (report_level > 0)
+      fprintf(
+        stderr,
+        "lsda_read: variable %s not found while reading file %s\n CWD=%s\n",
+        name,
+        daf->ifr ? daf->ifr->filename : NULL,
+        daf->GetCWD(daf));
+    return -1;
+  }
+
+  return lsda_readvar(daf, type, var, offset, number, data);
+}
+
 Length
 lsda_lread(int handle,
            int type_id,
@@ -4229,72 +4257,648 @@ free_all_lsda(void)
 }
 
 // qd additions
+typedef struct
+{
+  LSDA_ChildVisitor* visitor;
+  void* user_data;
+} ChildVisit;
+
+static int
+visit_child(void* data, void* user)
+{
+  ChildVisit* visit = (ChildVisit*)user;
+  return visit->visitor(((LSDATable*)data)->name, visit->user_data);
+}
+
+/*
+  Call the visitor with the name of each child of a directory, in
+  ascending (strcmp) order. The names point into the symbol table and
+  are only valid during the call. Returns -1 if the name is not a
+  directory, otherwise the first nonzero visitor result (which stops
+  the iteration) or 0.
+*/
+int
+lsda_visit_children(int handle,
+                    char* name,
+                    int follow,
+                    LSDA_ChildVisitor* visitor,
+                    void* user_data)
+{
+  LSDAFile* daf;
+  LSDATable* t;
+  ChildVisit visit;
+
+  if (handle < 0 || handle >= num_daf) {
+    _errno = ERR_NOFILE;
+    if (report_level > 0)
+      fprintf(stderr, "lsda_visit_children: invalid handle %d", handle);
+    return -1;
+  }
+  daf = da_store + handle;
+
+  t = daf->FindVar(daf, name, 0, follow);
+  if (!t || t->type != 0)
+    return -1;
+  if (!t->children)
+    return 0;
+
+  visit.visitor = visitor;
+  visit.user_data = user_data;
+  return BT_visit(t->children, visit_child, &visit);
+}
+
+typedef struct
+{
+  char** names;
+  Length iChild;
+} ChildNames;
+
+static int
+copy_child_name(const char* name, void* user)
+{
+  ChildNames* names = (ChildNames*)user;
+  char* entry = (char*)malloc(strlen(name) + 1);
+  strcpy(entry, name);
+  names->names[names->iChild++] = entry;
+  return 0;
+}
+
+/*
+  Get a malloc'd list of malloc'd child names of a directory. Prefer
+  lsda_visit_children, which does not copy anything.
+*/
 char**
 lsda_get_children_names(int handle, char* name, int follow, Length* length)
 {
-  *length = 0;
   LSDAFile* daf;
   LSDATable* t;
-  LSDATable* current_table;
+  ChildNames names;
 
-  // get file
+  *length = 0;
   if (handle < 0 || handle >= num_daf) {
     _errno = ERR_NOFILE;
-    //*type_id = -1;
-    *length = 0;
     if (report_level > 0)
-      fprintf(stderr, "lsda_query: invalid handle %d", handle);
+      fprintf(stderr, "lsda_get_children_names: invalid handle %d", handle);
     return 0;
   }
   daf = da_store + handle;
 
-  // find symbol
   t = daf->FindVar(daf, name, 0, follow);
-  // check for error
-  if (t) {
-    if (t->type == 0) {
-      // yay im a dir
-      *length = BT_numentries(t->children);
-    } else {
-      // do something coz im a var, not a dir
-      return 0; // return empty
-    }
-  } else {
-    // do someting because i failed
+  if (!t) {
     fprintf(stderr, "lsda_get_children_names: path %s does not exist.", name);
     return 0;
   }
+  if (t->type != 0 || !t->children || BT_numentries(t->children) < 1)
+    return 0;
+
+  names.names = (char**)malloc(BT_numentries(t->children) * sizeof(char*));
+  names.iChild = 0;
+  lsda_visit_children(handle, name, follow, copy_child_name, &names);
+  *length = names.iChild;
+
+  return names.names;
+}
 
-  // no children
-  if ((*length) < 1)
+/* describe the variable table "var" in "info", see lsda_lookup */
+static void
+lookup_table(LSDAFile* daf, LSDATable* var, LSDA_VarInfo* info)
+{
+  LSDAType* type;
+  int i;
+
+  info->type_id = -1;
+  info->length = 0;
+  info->file_number = -1;
+  info->data_offset = 0;
+  info->native = 0;
+
+  if (var == NULL)
+    return;
+
+  if (var->type == NULL) {
+    info->type_id = 0;
+    info->length = var->children ? BT_numentries(var->children) : 0;
+    return;
+  }
+
+  info->type_id = LSDAId(var->type);
+  info->length = var->length;
+  if (var->ifile == NULL || info->type_id == LSDA_LINK || daf->encrypted)
+    return;
+
+  for (i = 0; i < daf->num_list; i++)
+    if (daf->ifile[i] == var->ifile)
+      break;
+  if (i == daf->num_list)
+    return;
+
+  type = daf->FindTypeByID(daf, info->type_id);
+  info->file_number = i;
+  info->data_offset = var->offset + var->ifile->FileLengthSize +
+                      var->ifile->FileCommandSize +
+                      var->ifile->FileTypeIDSize + strlen(var->name) + 1;
+  info->native =
+    type != NULL && GetConversionFunction(var->ifile, var->type, type) == NULL;
+}
+
+/*
+  qd addition: everything needed to read a variable in one symbol table
+  lookup. Reading a binout means millions of tiny variables, for which
+  lsda_queryvar plus lsda_read (type lookup, write state checks, second
+  symbol lookup, conversion setup, fseek and fread) costs more than
+  copying the data itself.
+
+  The data of a variable is native if it can be copied as it lies in
+  file number "file_number" (see lsda_filename) at "data_offset": no
+  link, no encryption and no conversion to the type "type_id".
+
+  Returns 0 on success and -1 if the name does not exist. Directories
+  have a type_id of 0 and their number of children as length.
+*/
+int
+lsda_lookup(int handle, char* name, int follow, LSDA_VarInfo* info)
+{
+  LSDAFile* daf;
+  LSDATable* var;
+
+  lookup_table(NULL, NULL, info);
+
+  if (handle < 0 || handle >= num_daf) {
+    _errno = ERR_NOFILE;
+    return -1;
+  }
+  daf = da_store + handle;
+
+  var = daf->FindVar(daf, name, 0, follow);
+  if (var == NULL)
+    return -1;
+
+  lookup_table(daf, var, info);
+  return 0;
+}
+
+/*
+  qd addition: lsda_lookup of the variable "var_name" in several
+  subdirectories of directory "name" (e.g. all states "d000001" ... of
+  "/nodout"). The directory is resolved only once, the subdirectories
+  and variables are looked up in its children directly. Links are
+  followed.
+
+  infos[i] describes the variable of subdirectory i, a missing variable
+  has a type_id of -1. Returns 0 on success and -1 if the directory
+  does not exist.
+*/
+int
+lsda_lookup_series(int handle,
+                   char* name,
+                   char** subdir_names,
+                   Length nSubdirs,
+                   char* var_name,
+                   LSDA_VarInfo* infos)
+{
+  LSDAFile* daf;
+  LSDATable *dir, *subdir, *var, dummy;
+  Length iEntry;
+
+  for (iEntry = 0; iEntry < nSubdirs; ++iEntry)
+    lookup_table(NULL, NULL, infos + iEntry);
+
+  if (handle < 0 || handle >= num_daf) {
+    _errno = ERR_NOFILE;
+    return -1;
+  }
+  daf = da_store + handle;
+
+  dir = daf->FindVar(daf, name, 0, 1);
+  if (dir == NULL || dir->type || !dir->children) {
+    _errno = ERR_NOVAR;
+    return -1;
+  }
+
+  for (iEntry = 0; iEntry < nSubdirs; ++iEntry) {
+
+    strncpy(dummy.name, subdir_names[iEntry], MAXNAME - 1);
+    dummy.name[MAXNAME - 1] = '\0';
+    subdir = (LSDATable*)BT_lookup(dir->children, &dummy, 0);
+    if (subdir && subdir->type && subdir->type->id == LSDA_LINK)
+      subdir = LSDAresolve_link(daf, subdir);
+
+    var = NULL;
+    if (subdir && !subdir->type && subdir->children) {
+      strncpy(dummy.name, var_name, MAXNAME - 1);
+      dummy.name[MAXNAME - 1] = '\0';
+      var = (LSDATable*)BT_lookup(subdir->children, &dummy, 0);
+      if (var && var->type && var->type->id == LSDA_LINK)
+        var = LSDAresolve_link(daf, var);
+    }
+
+    lookup_table(daf, var, infos + iEntry);
+  }
+
+  return 0;
+}
+
+/*
+  qd addition: path of a file of the family, as numbered by lsda_lookup.
+  Returns 0 on success and -1 otherwise.
+*/
+int
+lsda_filename(int handle,
+              int file_number,
+              char* filepath,
+              size_t filepath_size)
+{
+  LSDAFile* daf;
+  IFile* ifile;
+
+  if (handle < 0 || handle >= num_daf) {
+    _errno = ERR_NOFILE;
+    return -1;
+  }
+  daf = da_store + handle;
+  if (file_number < 0 || file_number >= daf->num_list)
+    return -1;
+
+  ifile = daf->ifile[file_number];
+  if (snprintf(filepath,
+               filepath_size,
+               "%s%c%s",
+               ifile->dirname,
+               DIR_SEP,
+               ifile->filename) >= (int)filepath_size)
+    return -1;
+  return 0;
+}
+
+/*
+  qd addition: locate the data of a variable on disk, so that it can be
+  read without going through the library, e.g. by several threads at
+  once with pread.
+
+  On success the number of items is written to "length", the path of
+  the file containing the data to "filepath" and the position of the
+  first data byte to "data_offset".
+
+  Returns 0 on success, -1 if the variable does not exist and 1 if the
+  data can not be read as raw bytes (link, encryption, conversion).
+*/
+int
+lsda_locate(int handle,
+            int type_id,
+            char* name,
+            Length* length,
+            char* filepath,
+            size_t filepath_size,
+            Offset* data_offset)
+{
+  LSDA_VarInfo info;
+
+  if (lsda_lookup(handle, name, 0, &info) < 0 || info.type_id == 0) {
+    _errno = ERR_NOVAR;
+    return -1;
+  }
+
+  if (info.type_id != type_id || !info.native ||
+      lsda_filename(handle, info.file_number, filepath, filepath_size) < 0)
+    return 1;
+
+  *length = info.length;
+  *data_offset = info.data_offset;
+  return 0;
+}
+
+/*
+  qd addition: a persistent copy of the symbol table of a file family.
+
+  Reading the symbol tables of a big binout family means seeking through
+  all of its files. lsda_write_index stores the final symbol table in one
+  compact file and lsda_open_index rebuilds it from there without touching
+  the data files. An index is only used if the family still consists of
+  exactly the same files with the same sizes and modification times.
+
+  Layout (native byte order):
+    "QDLSDAX1", int 1 (byte order check), int nFiles
+    nFiles x { int name length, name, int64 size, int64 mtime, header[8] }
+    int64 nEntries
+    nEntries x { int path length, path, int type id (0 = directory),
+                 int file number, int64 offset, int64 length }
+  Entries are stored parents first.
+*/
+#define LSDA_INDEX_MAGIC "QDLSDAX1"
+
+typedef struct
+{
+  const char* pos;
+  const char* end;
+} IndexCursor;
+
+static int
+index_get(IndexCursor* cursor, void* dest, size_t nBytes)
+{
+  if ((size_t)(cursor->end - cursor->pos) < nBytes)
     return 0;
+  memcpy(dest, cursor->pos, nBytes);
+  cursor->pos += nBytes;
+  return 1;
+}
 
-  int count = 0;
-  LSDATable* child = 0;
-  char** ret = (char**)malloc((*length) * sizeof(char*));
+static int
+is_family_member(char* base, char* name)
+{
+  size_t len = strlen(base);
+  if (strncmp(base, name, len))
+    return 0;
+  if (name[len] == 0)
+    return 1;
+  if (name[len] != '%' || !name[len + 1])
+    return 0;
+  for (name += len + 1; *name; name++)
+    if (!isdigit((unsigned char)*name))
+      return 0;
+  return 1;
+}
 
-  /*
-  int l = (int) strlen(t->name);
-  strcpy(q, t->name);
-  if (!t->type) {
-    // let string finish correctly
-    if (t->name[l - 1] != '/') {
-      q[l++] = '/';
-      q[l] = '\0';
+static int
+stat_file(char* dirname, char* filename, int64_t* size, int64_t* mtime)
+{
+  char fullname[MAXPATHLEN];
+  struct stat file_stat;
+
+  if (snprintf(fullname, sizeof(fullname), "%s%c%s", dirname, DIR_SEP, filename) >=
+        (int)sizeof(fullname) ||
+      stat(fullname, &file_stat) != 0)
+    return 0;
+  *size = (int64_t)file_stat.st_size;
+  *mtime = (int64_t)file_stat.st_mtime;
+  return 1;
+}
+
+static int
+write_index_entries(LSDAFile* daf, LSDATable* symbol, FILE* fp, int64_t* count)
+{
+  LSDATable* child;
+  char* path;
+  int cont, len, type_id, ifile_index;
+  int64_t offset, length;
+
+  if (symbol != daf->top) {
+    path = daf->GetPath(daf, symbol);
+    if (path == NULL)
+      return 0;
+    len = (int)strlen(path);
+    type_id = symbol->type ? LSDAId(symbol->type) : 0;
+    for (ifile_index = 0; ifile_index < daf->num_list; ifile_index++)
+      if (daf->ifile[ifile_index] == symbol->ifile)
+        break;
+    if (symbol->type && ifile_index == daf->num_list)
+      return 0;
+    offset = (int64_t)symbol->offset;
+    length = (int64_t)symbol->length;
+    if (fwrite(&len, sizeof(int), 1, fp) != 1 ||
+        fwrite(path, 1, len, fp) != (size_t)len ||
+        fwrite(&type_id, sizeof(int), 1, fp) != 1 ||
+        fwrite(&ifile_index, sizeof(int), 1, fp) != 1 ||
+        fwrite(&offset, sizeof(int64_t), 1, fp) != 1 ||
+        fwrite(&length, sizeof(int64_t), 1, fp) != 1)
+      return 0;
+    (*count)++;
+  }
+  if (symbol->children) {
+    for (cont = 0;;) {
+      child = (LSDATable*)BT_enumerate(symbol->children, &cont);
+      if (!child)
+        break;
+      if (!write_index_entries(daf, child, fp, count))
+        return 0;
     }
   }
-  */
+  return 1;
+}
 
-  int iChild = 0;
-  while (1) {
-    child = (LSDATable*)BT_enumerate(t->children, &count);
-    if (!child)
+/*
+  Write the symbol table of a file opened read only to "index_filen".
+  Returns 1 on success and -1 on error.
+*/
+int
+lsda_write_index(int handle, char* index_filen)
+{
+  LSDAFile* daf;
+  IFile* ifile;
+  FILE* fp;
+  char tmp_filen[MAXPATHLEN];
+  unsigned char header[8];
+  int i, len, one = 1;
+  int64_t size, mtime, count = 0;
+  long count_pos;
+
+  if (handle < 0 || handle >= num_daf) {
+    _errno = ERR_NOFILE;
+    return -1;
+  }
+  daf = da_store + handle;
+  if (daf->openmode != LSDA_READONLY || daf->encrypted)
+    return -1;
+
+  /* write to a temporary file first, so readers never see half an index */
+  if (snprintf(tmp_filen, sizeof(tmp_filen), "%s.tmp", index_filen) >=
+        (int)sizeof(tmp_filen) ||
+      (fp = fopen(tmp_filen, "wb")) == NULL) {
+    _errno = ERR_OPENFILE;
+    return -1;
+  }
+
+  if (fwrite(LSDA_INDEX_MAGIC, 1, 8, fp) != 8 ||
+      fwrite(&one, sizeof(int), 1, fp) != 1 ||
+      fwrite(&daf->num_list, sizeof(int), 1, fp) != 1)
+    goto cleanup;
+  for (i = 0; i < daf->num_list; i++) {
+    ifile = daf->ifile[i];
+    if (!stat_file(ifile->dirname, ifile->filename, &size, &mtime))
+      goto cleanup;
+    memset(header, 0, sizeof(header));
+    header[1] = (unsigned char)ifile->FileLengthSize;
+    header[2] = (unsigned char)ifile->FileOffsetSize;
+    header[3] = (unsigned char)ifile->FileCommandSize;
+    header[4] = (unsigned char)ifile->FileTypeIDSize;
+    header[5] = (unsigned char)ifile->bigendian;
+    header[6] = (unsigned char)ifile->fp_format;
+    len = (int)strlen(ifile->filename);
+    if (fwrite(&len, sizeof(int), 1, fp) != 1 ||
+        fwrite(ifile->filename, 1, len, fp) != (size_t)len ||
+        fwrite(&size, sizeof(int64_t), 1, fp) != 1 ||
+        fwrite(&mtime, sizeof(int64_t), 1, fp) != 1 ||
+        fwrite(header, 1, 8, fp) != 8)
+      goto cleanup;
+  }
+
+  count_pos = ftell(fp);
+  if (fwrite(&count, sizeof(int64_t), 1, fp) != 1 ||
+      !write_index_entries(daf, daf->top, fp, &count) ||
+      fseek(fp, count_pos, SEEK_SET) != 0 ||
+      fwrite(&count, sizeof(int64_t), 1, fp) != 1)
+    goto cleanup;
+
+  if (fclose(fp) != 0) {
+    remove(tmp_filen);
+    _errno = ERR_WRITE;
+    return -1;
+  }
+#if defined _WIN32 || defined MPPWIN
+  remove(index_filen);
+#endif
+  if (rename(tmp_filen, index_filen) != 0) {
+    remove(tmp_filen);
+    _errno = ERR_WRITE;
+    return -1;
+  }
+  return 1;
+
+cleanup:
+  fclose(fp);
+  remove(tmp_filen);
+  _errno = ERR_WRITE;
+  return -1;
+}
+
+/*
+  Open the file family "filen" read only from the index data previously
+  written by lsda_write_index. Returns the handle or -1 if the index is
+  invalid or out of date, in which case the family has to be opened with
+  lsda_open.
+*/
+int
+lsda_open_index(char* filen, const char* index, size_t index_size)
+{
+  IndexCursor cursor;
+  LSDAFile* daf;
+  LSDAType* type;
+  LSDATable* symbol;
+  IFile* ifile;
+  DIR* dp;
+  char magic[8], path[MAXPATH], *copy, *dirname, *base_name, *name, *sep;
+  unsigned char header[8];
+  int i, len, one, nFiles, nFamily, handle, type_id, ifile_index;
+  int64_t iEntry, nEntries, size, mtime, disk_size, disk_mtime, offset,
+    length;
+
+  _errno = ERR_NONE;
+  cursor.pos = index;
+  cursor.end = index + index_size;
+  if (!index_get(&cursor, magic, 8) ||
+      memcmp(magic, LSDA_INDEX_MAGIC, 8) != 0 ||
+      !index_get(&cursor, &one, sizeof(int)) || one != 1 ||
+      !index_get(&cursor, &nFiles, sizeof(int)) || nFiles < 1)
+    return -1;
+
+  /* split into directory and base name like lsda_open */
+  copy = strdup(filen);
+  if (copy == NULL)
+    return -1;
+  len = (int)strlen(copy);
+  if (len > 1 && copy[len - 1] == DIR_SEP)
+    copy[--len] = 0;
+  sep = strrchr(copy, DIR_SEP);
+  if (sep != NULL && sep != copy) {
+    *sep = 0;
+    dirname = copy;
+    base_name = strdup(sep + 1);
+  } else {
+    dirname = strdup(".");
+    base_name = copy;
+  }
+  if (dirname == NULL || base_name == NULL)
+    goto invalid;
+
+  /* the family on disk must not have gained or lost files */
+#if defined _WIN32 || defined MPPWIN
+  dp = opendir(dirname, base_name);
+#else
+  dp = opendir(dirname);
+#endif
+  nFamily = 0;
+  if (dp != NULL) {
+    while ((name = finddirmatch(base_name, dp)))
+      if (is_family_member(base_name, name))
+        nFamily++;
+    closedir(dp);
+  }
+  if (nFamily != nFiles)
+    goto invalid;
+
+  /*
+    Get next available handle
+  */
+  for (handle = 0; handle < num_daf; handle++) {
+    if (da_store[handle].free)
       break;
+  }
+  if (handle == num_daf && alloc_more_daf(10) < 0)
+    goto invalid;
+  daf = da_store + handle;
+  InitLSDAFile(daf);
+  daf->maxsize = DEF_MAX_SIZE;
+  daf->openmode = LSDA_READONLY;
+  daf->ifile = (IFile**)malloc(nFiles * sizeof(IFile*));
+  daf->num_list = 0;
+
+  for (i = 0; i < nFiles; i++) {
+    if (!index_get(&cursor, &len, sizeof(int)) || len < 1 ||
+        len >= (int)sizeof(path) || !index_get(&cursor, path, len) ||
+        !index_get(&cursor, &size, sizeof(int64_t)) ||
+        !index_get(&cursor, &mtime, sizeof(int64_t)) ||
+        !index_get(&cursor, header, 8))
+      goto cleanup;
+    path[len] = 0;
+    if (!is_family_member(base_name, path) ||
+        !stat_file(dirname, path, &disk_size, &disk_mtime) ||
+        disk_size != size || disk_mtime != mtime)
+      goto cleanup;
 
-    char* entry = (char*)malloc(strlen(child->name) * sizeof(char));
-    strcpy(entry, child->name);
-    ret[iChild++] = entry;
+    ifile = newIFile();
+    ifile->dirname = strdup(dirname);
+    ifile->filename = strdup(path);
+    daf->ifile[daf->num_list++] = ifile;
+    init_ifile(daf, ifile, header);
   }
 
-  return ret;
-}
\ No newline at end of file
+  if (!index_get(&cursor, &nEntries, sizeof(int64_t)) || nEntries < 0)
+    goto cleanup;
+  for (iEntry = 0; iEntry < nEntries; iEntry++) {
+    if (!index_get(&cursor, &len, sizeof(int)) || len < 1 ||
+        len >= (int)sizeof(path) || !index_get(&cursor, path, len) ||
+        !index_get(&cursor, &type_id, sizeof(int)) ||
+        !index_get(&cursor, &ifile_index, sizeof(int)) ||
+        !index_get(&cursor, &offset, sizeof(int64_t)) ||
+        !index_get(&cursor, &length, sizeof(int64_t)))
+      goto cleanup;
+    path[len] = 0;
+
+    if (type_id == 0) {
+      if (daf->CreateDir(daf, path) == NULL)
+        goto cleanup;
+      continue;
+    }
+    type = daf->FindTypeByID(daf, type_id);
+    if (type == NULL || ifile_index < 0 || ifile_index >= nFiles)
+      goto cleanup;
+    symbol = daf->CreateVar(daf, type, path);
+    if (symbol == NULL)
+      goto cleanup;
+    symbol->offset = (size_t)offset;
+    symbol->length = (size_t)length;
+    symbol->ifile = daf->ifile[ifile_index];
+  }
+
+  daf->cwd = daf->top;
+  free(dirname);
+  free(base_name);
+  return handle;
+
+cleanup:
+  lsda_close(handle);
+invalid:
+  free(dirname);
+  free(base_name);
+  _errno = ERR_OPENFILE;
+  return -1;
+}
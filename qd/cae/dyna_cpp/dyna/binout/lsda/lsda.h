@@ -100,11 +100,52 @@ EXTERN void
 free_all_lsda(void);
 
 // qd additions
+typedef int LSDA_ChildVisitor(const char* name, void* user_data);
+EXTERN int
+lsda_visit_children(int handle,
+                    char* name,
+                    int follow,
+                    LSDA_ChildVisitor* visitor,
+                    void* user_data);
 EXTERN char**
 lsda_get_children_names(int handle,
                         char* name,
                         int follow,
                         LSDA_Length* length);
+typedef struct
+{
+  int type_id; /* 0 for directories, -1 if missing */
+  LSDA_Length length;
+  int file_number;         /* file of the family containing the data */
+  LSDA_Offset data_offset; /* position of the first item in that file */
+  int native;              /* data can be copied as it is on disk */
+} LSDA_VarInfo;
+EXTERN int
+lsda_lookup(int handle, char* name, int follow, LSDA_VarInfo* info);
+EXTERN int
+lsda_lookup_series(int handle,
+                   char* name,
+                   char** subdir_names,
+                   LSDA_Length nSubdirs,
+                   char* var_name,
+                   LSDA_VarInfo* infos);
+EXTERN int
+lsda_filename(int handle,
+              int file_number,
+              char* filepath,
+              size_t filepath_size);
+EXTERN int
+lsda_locate(int handle,
+            int type_id,
+            char* name,
+            LSDA_Length* length,
+            char* filepath,
+            size_t filepath_size,
+            LSDA_Offset* data_offset);
+EXTERN int
+lsda_write_index(int handle, char* index_filen);
+EXTERN int
+lsda_open_index(char* filen, const char* index, size_t index_size);
 
 #define LSDA_READONLY 0
 #define LSDA_WRITEONLY 1
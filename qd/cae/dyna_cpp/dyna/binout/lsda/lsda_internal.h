@@ -121,6 +121,7 @@ typedef struct _LSDAFile
   unsigned char pending[16]; /* data pending for encrypted output */
   int npend;                 /* # bytes of pending data */
   aes_ctx ctx[1];            /* encryption context */
+  void* path_index;          /* full path hash index (read only files) */
 } LSDAFile;
 extern LSDAFile*
 NewLSDAFile(void);
@@ -107,6 +107,160 @@ my_compfunc(void* p1, void* p2)
   return strcmp(d1->name, d2->name);
 }
 
+/*
+  Hash index of all full paths of a file, so that absolute lookups do
+  not have to walk the directory trees component by component. It is
+  only used for files opened read only, built on the first lookup and
+  dropped whenever the symbol table changes.
+*/
+typedef struct _LSDAPathIndex
+{
+  size_t capacity;     /* number of slots, a power of two */
+  char* strings;       /* all paths, zero terminated, back to back */
+  size_t* keys;        /* offset of the path of a slot in strings */
+  LSDATable** values;  /* NULL for empty slots */
+} LSDAPathIndex;
+
+static size_t
+LSDAHashPath(const char* s)
+{
+  size_t h = 2166136261u; /* FNV-1a */
+  for (; *s; s++) {
+    h ^= (unsigned char)*s;
+    h *= 16777619u;
+  }
+  return h;
+}
+
+static void
+LSDACountPaths(LSDATable* t, size_t len, size_t* n, size_t* nchars)
+{
+  LSDATable* child;
+  int cont;
+
+  if (len >= MAXPATH)
+    return;
+  (*n)++;
+  *nchars += len + 1;
+  if (t->children) {
+    for (cont = 0;;) {
+      child = (LSDATable*)BT_enumerate(t->children, &cont);
+      if (!child)
+        break;
+      LSDACountPaths(child,
+                     len + strlen(child->name) + (t->parent ? 1 : 0),
+                     n,
+                     nchars);
+    }
+  }
+}
+
+static void
+LSDAIndexPaths(LSDAPathIndex* index,
+               LSDATable* t,
+               char* path,
+               size_t len,
+               size_t* used)
+{
+  LSDATable* child;
+  int cont;
+  size_t slot, l;
+
+  if (len >= MAXPATH)
+    return;
+  memcpy(index->strings + *used, path, len + 1);
+  slot = LSDAHashPath(path) & (index->capacity - 1);
+  while (index->values[slot])
+    slot = (slot + 1) & (index->capacity - 1);
+  index->keys[slot] = *used;
+  index->values[slot] = t;
+  *used += len + 1;
+
+  if (t->children) {
+    for (cont = 0;;) {
+      child = (LSDATable*)BT_enumerate(t->children, &cont);
+      if (!child)
+        break;
+      l = len;
+      if (t->parent)
+        path[l++] = '/';
+      if (l + strlen(child->name) < MAXPATH) {
+        strcpy(path + l, child->name);
+        LSDAIndexPaths(index, child, path, l + strlen(child->name), used);
+      }
+      path[len] = '\0';
+    }
+  }
+}
+
+static LSDAPathIndex*
+LSDABuildIndex(LSDAFile* file)
+{
+  LSDAPathIndex* index;
+  char path[MAXPATH];
+  size_t n = 0, nchars = 0, used = 0;
+
+  LSDACountPaths(file->top, 1, &n, &nchars);
+  index = (LSDAPathIndex*)malloc(sizeof(LSDAPathIndex));
+  if (!index)
+    return NULL;
+  for (index->capacity = 16; index->capacity < 2 * n; index->capacity *= 2)
+    ;
+  index->strings = (char*)malloc(nchars);
+  index->keys = (size_t*)malloc(index->capacity * sizeof(size_t));
+  index->values =
+    (LSDATable**)calloc(index->capacity, sizeof(LSDATable*));
+  if (!index->strings || !index->keys || !index->values) {
+    free(index->strings);
+    free(index->keys);
+    free(index->values);
+    free(index);
+    return NULL;
+  }
+  strcpy(path, "/");
+  LSDAIndexPaths(index, file->top, path, 1, &used);
+  return index;
+}
+
+static void
+LSDADropIndex(LSDAFile* file)
+{
+  LSDAPathIndex* index = (LSDAPathIndex*)file->path_index;
+
+  if (!index)
+    return;
+  free(index->strings);
+  free(index->keys);
+  free(index->values);
+  free(index);
+  file->path_index = NULL;
+}
+
+static LSDATable*
+LSDAIndexLookup(LSDAFile* file, char* name)
+/*
+ * Looks up an absolute path in the index. A miss only
+ * means that the path is not in its canonical form or
+ * not in the file, the caller has to walk the tree then.
+ */
+{
+  LSDAPathIndex* index;
+  size_t slot;
+
+  if (!file->path_index)
+    file->path_index = LSDABuildIndex(file);
+  index = (LSDAPathIndex*)file->path_index;
+  if (!index)
+    return NULL;
+  slot = LSDAHashPath(name) & (index->capacity - 1);
+  while (index->values[slot]) {
+    if (!strcmp(index->strings + index->keys[slot], name))
+      return index->values[slot];
+    slot = (slot + 1) & (index->capacity - 1);
+  }
+  return NULL;
+}
+
 static LSDATable*
 LSDAFind(LSDAFile* file, char* name, void* type, int create, int follow)
 /*
@@ -133,6 +287,16 @@ LSDAFind(LSDAFile* file, char* name, void* type, int create, int follow)
     return (NULL);
   }
 
+  /* Absolute paths of read only files are looked up directly */
+  if (!create && *name == '/' && file->openmode == LSDA_READONLY) {
+    t = LSDAIndexLookup(file, name);
+    if (t) {
+      if (follow && t->type && t->type->id == LSDA_LINK)
+        t = LSDAresolve_link(file, t);
+      return t;
+    }
+  }
+
   /* Split the path into components and treat "/" carefully */
   strcpy(s, name);
   args = LSDASplitPath(s, c);
@@ -185,6 +349,7 @@ LSDAFind(LSDAFile* file, char* name, void* type, int create, int follow)
         */
         return (NULL);
       }
+      LSDADropIndex(file);
       start->children = BT_new(my_compfunc);
       child = NewLSDATable();
       strcpy(child->name, args[0]);
@@ -216,6 +381,7 @@ LSDAFind(LSDAFile* file, char* name, void* type, int create, int follow)
       */
       return (NULL);
     }
+    LSDADropIndex(file);
     child = NewLSDATable();
     strcpy(child->name, args[0]);
     child->parent = start;
@@ -457,6 +623,7 @@ LSDATableFree(LSDAFile* file, LSDATable* t)
 {
   if (!t)
     return;
+  LSDADropIndex(file);
   if (t->parent && t->parent->children)
     BT_delete(t->parent->children, t);
   _LSDATableFree(t);
@@ -114,6 +114,13 @@ D3plot::D3plot(std::string _filename,
   , acc_read(0)
   , vel_is_read(false)
   , vel_read(0)
+  , coords_is_read(false)
+  , coords_read(false)
+  , coords_precision(Precision::FLOAT32)
+  , shell_layers_is_read(false)
+  , shell_layers_read(false)
+  , shell_layers(nullptr)
+  , shell_layers_precision(Precision::FLOAT32)
   , buffer(nullptr)
 {
 // check for femzip
@@ -1308,6 +1315,9 @@ D3plot::read_states_parse(std::vector<std::string> _variables)
   this->strain_read = 0;
   this->energy_read = 0;
   this->plastic_strain_read = 0;
+  this->coords_read = false;
+  this->shell_layers_read = false;
+  this->envelope_read.clear();
 
   this->history_shell_read.clear();
   this->history_shell_mode.clear();
@@ -1316,14 +1326,50 @@ D3plot::read_states_parse(std::vector<std::string> _variables)
   this->history_solid_mode.clear();
 
   for (size_t ii = 0; ii < _variables.size(); ++ii) {
-    // Displacement
-    if (_variables[ii].find("disp") != std::string::npos) {
+    // envelope contains "vel", thus it is cut off before matching
+    const std::string envelope_keyword = "envelope";
+    const auto envelope_pos = _variables[ii].find(envelope_keyword);
+    const bool is_envelope = envelope_pos != std::string::npos;
+    if (is_envelope)
+      _variables[ii].erase(envelope_pos, envelope_keyword.size());
+
+    // Raw shell layers
+    if (_variables[ii].find("shell_layers") != std::string::npos) {
+      this->shell_layers_read = !this->shell_layers_is_read;
+      if (this->shell_layers_read)
+        this->shell_layers_precision =
+          parse_precision(_variables[ii], "shell_layers");
+
+#ifdef QD_DEBUG
+      if (this->shell_layers_is_read)
+        std::cout << "shell_layers already loaded." << std::endl;
+#endif
+      // Node coordinates as one block
+    } else if (_variables[ii].find("coords") != std::string::npos) {
+      if (dyna_iu == 0)
+        throw(std::invalid_argument(
+          "Unable to read coordinates, since there are no displacements."));
+      if (dyna_ndim != 3)
+        throw(std::invalid_argument(
+          "Unable to read coordinates as block, since the model has " +
+          std::to_string(dyna_ndim) + " instead of 3 dimensions."));
+      this->coords_read = !this->coords_is_read;
+      if (this->coords_read)
+        this->coords_precision = parse_precision(_variables[ii], "coords");
+
+#ifdef QD_DEBUG
+      if (this->coords_is_read)
+        std::cout << "coords already loaded." << std::endl;
+#endif
+      // Displacement
+    } else if (_variables[ii].find("disp") != std::string::npos) {
       if (dyna_iu == 0)
         throw(std::invalid_argument(
           "Unable to read displacements, since there are none."));
       this->disp_read = read_states_parse_readMode(_variables[ii]);
 
-      if (this->disp_is_read) {
+      if (!read_states_parse_envelope(is_envelope, "disp", this->disp_read) &&
+          this->disp_is_read) {
 #ifdef QD_DEBUG
         std::cout << "disp already loaded." << std::endl;
 #endif
@@ -1336,7 +1382,8 @@ D3plot::read_states_parse(std::vector<std::string> _variables)
           "Unable to read velocities, since there are none."));
       this->vel_read = read_states_parse_readMode(_variables[ii]);
 
-      if (this->vel_is_read) {
+      if (!read_states_parse_envelope(is_envelope, "vel", this->vel_read) &&
+          this->vel_is_read) {
 #ifdef QD_DEBUG
         std::cout << "vel already loaded." << std::endl;
 #endif
@@ -1349,7 +1396,8 @@ D3plot::read_states_parse(std::vector<std::string> _variables)
           "Unable to read accelerations, since there are none."));
       this->acc_read = read_states_parse_readMode(_variables[ii]);
 
-      if (this->acc_is_read) {
+      if (!read_states_parse_envelope(is_envelope, "accel", this->acc_read) &&
+          this->acc_is_read) {
 #ifdef QD_DEBUG
         std::cout << "accel already loaded." << std::endl;
 #endif
@@ -1364,7 +1412,9 @@ D3plot::read_states_parse(std::vector<std::string> _variables)
 #endif
       this->stress_mises_read = read_states_parse_readMode(_variables[ii]);
 
-      if (this->stress_mises_is_read) {
+      if (!read_states_parse_envelope(
+            is_envelope, "stress_mises", this->stress_mises_read) &&
+          this->stress_mises_is_read) {
 #ifdef QD_DEBUG
         std::cout << "stress_mises already loaded." << std::endl;
 #endif
@@ -1380,7 +1430,9 @@ D3plot::read_states_parse(std::vector<std::string> _variables)
 #endif
       this->stress_read = read_states_parse_readMode(_variables[ii]);
 
-      if (this->stress_is_read) {
+      if (!read_states_parse_envelope(
+            is_envelope, "stress", this->stress_read) &&
+          this->stress_is_read) {
 #ifdef QD_DEBUG
         std::cout << "stress already loaded." << std::endl;
 #endif
@@ -1396,7 +1448,9 @@ D3plot::read_states_parse(std::vector<std::string> _variables)
 #endif
       this->plastic_strain_read = read_states_parse_readMode(_variables[ii]);
 
-      if (this->plastic_strain_is_read) {
+      if (!read_states_parse_envelope(
+            is_envelope, "plastic_strain", this->plastic_strain_read) &&
+          this->plastic_strain_is_read) {
 #ifdef QD_DEBUG
         std::cout << "plastic strain already loaded." << std::endl;
 #endif
@@ -1409,7 +1463,9 @@ D3plot::read_states_parse(std::vector<std::string> _variables)
           "Unable to read strains, since there are none."));
       this->strain_read = read_states_parse_readMode(_variables[ii]);
 
-      if (this->strain_is_read) {
+      if (!read_states_parse_envelope(
+            is_envelope, "strain", this->strain_read) &&
+          this->strain_is_read) {
 #ifdef QD_DEBUG
         std::cout << "strain already loaded." << std::endl;
 #endif
@@ -1422,7 +1478,9 @@ D3plot::read_states_parse(std::vector<std::string> _variables)
           "Unable to read energies, since there are none."));
       this->energy_read = read_states_parse_readMode(_variables[ii]);
 
-      if (this->energy_is_read) {
+      if (!read_states_parse_envelope(
+            is_envelope, "energy", this->energy_read) &&
+          this->energy_is_read) {
 #ifdef QD_DEBUG
         std::cout << "energy already loaded." << std::endl;
 #endif
@@ -1578,6 +1636,74 @@ D3plot::read_states_parse_readMode(const std::string& _variable) const
   }
 }
 
+/** Check whether a variable shall be reduced over time while reading
+ *
+ * @param _is_envelope : whether the user requested an envelope
+ * @param _result_name : name of the result
+ * @param _read_mode : read mode of the result, set to 0 if the envelope
+ *                     was computed before
+ * @return is_envelope : true if an envelope instead of the time history
+ *                       was requested
+ */
+bool
+D3plot::read_states_parse_envelope(bool _is_envelope,
+                                   const std::string& _result_name,
+                                   int32_t& _read_mode)
+{
+  if (!_is_envelope)
+    return false;
+
+  for (const auto& entry : this->envelopes) {
+    if (entry.first.first == _result_name) {
+#ifdef QD_DEBUG
+      std::cout << _result_name << " envelope already loaded." << std::endl;
+#endif
+      _read_mode = 0;
+      return true;
+    }
+  }
+
+  this->envelope_read.push_back(_result_name);
+  return true;
+}
+
+/** Check whether a result is reduced over time in the current read
+ *
+ * @param _result_name : name of the result
+ * @return is_envelope
+ */
+bool
+D3plot::read_states_is_envelope(const std::string& _result_name) const
+{
+  return std::find(this->envelope_read.begin(),
+                   this->envelope_read.end(),
+                   _result_name) != this->envelope_read.end();
+}
+
+/** Get the envelope a result is reduced into during reading
+ *
+ * @param _result_name : name of the result
+ * @param _element_type : type of the elements, NONE for nodes
+ * @param _nEntities : number of nodes or elements
+ * @param _nComponents : number of components of the result
+ * @return envelope : nullptr if the time history shall be stored
+ */
+TimeEnvelope_ptr<float>
+D3plot::read_states_get_envelope(const std::string& _result_name,
+                                 Element::ElementType _element_type,
+                                 size_t _nEntities,
+                                 size_t _nComponents)
+{
+  if (!read_states_is_envelope(_result_name))
+    return nullptr;
+
+  auto& envelope = this->envelopes[std::make_pair(_result_name, _element_type)];
+  if (envelope == nullptr)
+    envelope = std::make_shared<TimeEnvelope<float>>(_nEntities, _nComponents);
+
+  return envelope;
+}
+
 /** Read the state data.
  *
  * @param _variable variable to load
@@ -1596,6 +1722,8 @@ D3plot::read_states(const std::string& _variable)
 void
 D3plot::read_states(std::vector<std::string> _variables)
 {
+  std::lock_guard<std::recursive_mutex> lock(state_mutex);
+
 #ifdef QD_DEBUG
   std::cout << "> STATES" << std::endl;
   for (size_t ii = 0; ii < _variables.size(); ++ii)
@@ -1614,8 +1742,9 @@ D3plot::read_states(std::vector<std::string> _variables)
   // Will not work first time :P since we must run through at least once
   if ((this->disp_read + this->vel_read + this->acc_read +
          this->plastic_strain_read + this->energy_read + this->strain_read +
-         this->stress_read + this->stress_mises_read +
-         this->history_shell_read.size() + this->history_solid_read.size() ==
+         this->stress_read + this->stress_mises_read + this->shell_layers_read +
+         this->coords_read + this->history_shell_read.size() +
+         this->history_solid_read.size() ==
        0) &&
       (this->timesteps.size() != 0))
     return;
@@ -1708,23 +1837,29 @@ D3plot::read_states(std::vector<std::string> _variables)
 
       // NODE - DISP
       if (dyna_iu && (this->disp_read != 0)) {
-        read_states_displacement();
+        read_states_displacement(iState);
+      }
+
+      // NODE - COORDS
+      if (dyna_iu && this->coords_read) {
+        read_states_coords(iState);
       }
 
       // NODE - VEL
       if (dyna_iv && (this->vel_read != 0)) {
-        read_states_velocity();
+        read_states_velocity(iState);
       }
 
       // NODE - ACCEL
       if (dyna_ia && (this->acc_read != 0)) {
-        read_states_acceleration();
+        read_states_acceleration(iState);
       }
 
       // ELEMENT - STRESS, STRAIN, ENERGY, PLASTIC STRAIN
       if (this->stress_read || this->stress_mises_read || this->strain_read ||
           this->energy_read || this->plastic_strain_read ||
-          this->history_shell_read.size() || this->history_solid_read.size()) {
+          this->shell_layers_read || this->history_shell_read.size() ||
+          this->history_solid_read.size()) {
 
         // solids
         read_states_elem8(iState);
@@ -1750,27 +1885,38 @@ D3plot::read_states(std::vector<std::string> _variables)
   this->buffer->end_nextState();
 
   // Set, which variables were read
-  if (this->disp_read != 0) {
+  if (this->disp_read != 0 && !read_states_is_envelope("disp")) {
     this->disp_is_read = true;
   }
-  if (this->vel_read != 0) {
+  if (this->vel_read != 0 && !read_states_is_envelope("vel")) {
     this->vel_is_read = true;
   }
-  if (this->plastic_strain_read != 0) {
+  if (this->acc_read != 0 && !read_states_is_envelope("accel")) {
+    this->acc_is_read = true;
+  }
+  if (this->plastic_strain_read != 0 &&
+      !read_states_is_envelope("plastic_strain")) {
     this->plastic_strain_is_read = true;
   }
-  if (this->energy_read != 0) {
+  if (this->energy_read != 0 && !read_states_is_envelope("energy")) {
     this->energy_is_read = true;
   }
-  if (this->strain_read != 0) {
+  if (this->strain_read != 0 && !read_states_is_envelope("strain")) {
     this->strain_is_read = true;
   }
-  if (this->stress_read != 0) {
+  if (this->stress_read != 0 && !read_states_is_envelope("stress")) {
     this->stress_is_read = true;
   }
-  if (this->stress_mises_read != 0) {
+  if (this->stress_mises_read != 0 &&
+      !read_states_is_envelope("stress_mises")) {
     this->stress_mises_is_read = true;
   }
+  if (this->shell_layers_read) {
+    this->shell_layers_is_read = true;
+  }
+  if (this->coords_read) {
+    this->coords_is_read = true;
+  }
   for (size_t ii = 0; ii < this->history_shell_read.size(); ++ii) {
     this->history_shell_is_read.push_back(this->history_shell_read[ii]);
   }
@@ -1784,7 +1930,7 @@ D3plot::read_states(std::vector<std::string> _variables)
  *
  */
 void
-D3plot::read_states_displacement()
+D3plot::read_states_displacement(size_t iState)
 {
   if (dyna_iu != 1)
     return;
@@ -1800,6 +1946,7 @@ D3plot::read_states_displacement()
 
   DB_Nodes* db_nodes = this->get_db_nodes();
   const auto nNodes = static_cast<int32_t>(db_nodes->get_nNodes());
+  auto envelope = read_states_get_envelope("disp", Element::NONE, nNodes, 1);
 
 #pragma omp parallel
   {
@@ -1809,7 +1956,20 @@ D3plot::read_states_displacement()
     for (int32_t iNode = 0; iNode < nNodes; ++iNode) {
       auto ii = start + iNode * dyna_ndim;
       buffer->read_float_array(ii, dyna_ndim, disp_tmp);
-      db_nodes->get_nodeByIndex(iNode)->add_disp(disp_tmp);
+
+      auto node = db_nodes->get_nodeByIndex(iNode);
+      if (envelope) {
+        // resultant displacement from the initial position
+        const auto& position = node->get_position();
+        float resultant = 0.f;
+        for (int32_t iDim = 0; iDim < dyna_ndim; ++iDim)
+          resultant += (disp_tmp[iDim] - position[iDim]) *
+                       (disp_tmp[iDim] - position[iDim]);
+        resultant = std::sqrt(resultant);
+        envelope->add(iNode, iState, &resultant);
+      } else {
+        node->add_disp(disp_tmp);
+      }
     }
   }
 
@@ -1824,12 +1984,35 @@ D3plot::read_states_displacement()
   // }
 }
 
+/** Read the node coordinates of a state as one block
+ *
+ * @param iState : current state
+ *
+ * LS-Dyna writes the current coordinates, which are stored as they
+ * are instead of converting them to displacements in every node.
+ */
+void
+D3plot::read_states_coords(size_t iState)
+{
+  if (dyna_iu != 1)
+    return;
+
+  const int32_t start = wordPosition + dyna_nglbv + 1;
+
+  std::vector<float> positions(dyna_numnp * dyna_ndim);
+  buffer->read_float_array(
+    start, static_cast<int32_t>(positions.size()), positions);
+
+  this->get_db_nodes()->set_node_positions(
+    iState, positions, this->coords_precision);
+}
+
 /*
  * Read the node velocity.
  *
  */
 void
-D3plot::read_states_velocity()
+D3plot::read_states_velocity(size_t iState)
 {
   if (dyna_iv != 1)
     return;
@@ -1846,6 +2029,7 @@ D3plot::read_states_velocity()
 
   DB_Nodes* db_nodes = this->get_db_nodes();
   const auto nNodes = static_cast<int64_t>(db_nodes->get_nNodes());
+  auto envelope = read_states_get_envelope("vel", Element::NONE, nNodes, 1);
 
 #pragma omp parallel
   {
@@ -1855,7 +2039,16 @@ D3plot::read_states_velocity()
     for (int32_t iNode = 0; iNode < nNodes; ++iNode) {
       auto ii = start + iNode * dyna_ndim;
       buffer->read_float_array(ii, dyna_ndim, vel_tmp);
-      db_nodes->get_nodeByIndex(iNode)->add_vel(vel_tmp);
+
+      if (envelope) {
+        float resultant = 0.f;
+        for (int32_t iDim = 0; iDim < dyna_ndim; ++iDim)
+          resultant += vel_tmp[iDim] * vel_tmp[iDim];
+        resultant = std::sqrt(resultant);
+        envelope->add(iNode, iState, &resultant);
+      } else {
+        db_nodes->get_nodeByIndex(iNode)->add_vel(vel_tmp);
+      }
     }
   }
 }
@@ -1865,7 +2058,7 @@ D3plot::read_states_velocity()
  *
  */
 void
-D3plot::read_states_acceleration()
+D3plot::read_states_acceleration(size_t iState)
 {
   if (dyna_ia != 1)
     return;
@@ -1882,6 +2075,7 @@ D3plot::read_states_acceleration()
 
   DB_Nodes* db_nodes = this->get_db_nodes();
   const auto nNodes = static_cast<int64_t>(db_nodes->get_nNodes());
+  auto envelope = read_states_get_envelope("accel", Element::NONE, nNodes, 1);
 
 #pragma omp parallel
   {
@@ -1891,7 +2085,16 @@ D3plot::read_states_acceleration()
     for (int32_t iNode = 0; iNode < nNodes; ++iNode) {
       auto ii = start + iNode * dyna_ndim;
       buffer->read_float_array(ii, dyna_ndim, accel_tmp);
-      db_nodes->get_nodeByIndex(iNode)->add_accel(accel_tmp);
+
+      if (envelope) {
+        float resultant = 0.f;
+        for (int32_t iDim = 0; iDim < dyna_ndim; ++iDim)
+          resultant += accel_tmp[iDim] * accel_tmp[iDim];
+        resultant = std::sqrt(resultant);
+        envelope->add(iNode, iState, &resultant);
+      } else {
+        db_nodes->get_nodeByIndex(iNode)->add_accel(accel_tmp);
+      }
     }
   }
 }
@@ -1923,6 +2126,17 @@ D3plot::read_states_elem8(size_t iState)
   std::vector<float> history_vars(this->history_solid_read.size());
   DB_Elements* db_elements = this->get_db_elements();
 
+  // results reduced over time instead of stored
+  const size_t nElements = static_cast<size_t>(dyna_nel8);
+  auto stress_envelope =
+    read_states_get_envelope("stress", Element::SOLID, nElements, 6);
+  auto stress_mises_envelope =
+    read_states_get_envelope("stress_mises", Element::SOLID, nElements, 1);
+  auto plastic_strain_envelope =
+    read_states_get_envelope("plastic_strain", Element::SOLID, nElements, 1);
+  auto strain_envelope =
+    read_states_get_envelope("strain", Element::SOLID, nElements, 6);
+
   size_t iElement = 0;
   for (int32_t ii = start; ii < start + wordsToRead; ii += dyna_nv3d) {
     auto element = db_elements->get_elementByIndex(Element::SOLID, iElement);
@@ -1932,22 +2146,38 @@ D3plot::read_states_elem8(size_t iState)
       // tmp_vector.clear();
       buffer->read_float_array(ii, 6, tmp_vector);
 
-      if (this->stress_read)
-        element->add_stress(tmp_vector);
-      if (this->stress_mises_read)
-        element->add_stress_mises(MathUtility::mises_stress(tmp_vector));
+      if (this->stress_read) {
+        if (stress_envelope)
+          stress_envelope->add(iElement, iState, tmp_vector.data());
+        else
+          element->add_stress(tmp_vector);
+      }
+      if (this->stress_mises_read) {
+        const float stress_mises = MathUtility::mises_stress(tmp_vector);
+        if (stress_mises_envelope)
+          stress_mises_envelope->add(iElement, iState, &stress_mises);
+        else
+          element->add_stress_mises(stress_mises);
+      }
     }
 
     // plastic strain
     if (this->plastic_strain_read) {
-      element->add_plastic_strain(this->buffer->read_float(ii + 6));
+      const float plastic_strain = this->buffer->read_float(ii + 6);
+      if (plastic_strain_envelope)
+        plastic_strain_envelope->add(iElement, iState, &plastic_strain);
+      else
+        element->add_plastic_strain(plastic_strain);
     }
 
     // strain tensor
     if ((dyna_istrn == 1) && this->strain_read) {
       // tmp_vector.clear();
       buffer->read_float_array(ii + dyna_nv3d - 6, 6, tmp_vector);
-      element->add_strain(tmp_vector);
+      if (strain_envelope)
+        strain_envelope->add(iElement, iState, tmp_vector.data());
+      else
+        element->add_strain(tmp_vector);
     }
 
     // no energy ...
@@ -1998,164 +2228,20 @@ D3plot::read_states_elem4(size_t iState)
 
   wordsToRead = dyna_nv2d * (dyna_nel4 - dyna_numrbe);
 
-  // offsets
-  const int32_t iPlastStrainOffset = this->dyna_ioshl1 * 6; // stresses before?
-  const int32_t iHistoryOffset =
-    iPlastStrainOffset + this->dyna_ioshl2; // stresses & pl. strain before
-  const int32_t iLayerSize = dyna_neips + iHistoryOffset;
-
-  // const auto nElements_shell = static_cast<int64_t>(
-  //   get_db_elements()->get_nElements(Element::ElementType::SHELL));
-
-  // #pragma omp parallel
-  {
-
-    // helpful vars
-    // vectors
-    std::vector<float> tmp_vec6(6);
-    std::vector<float> layers_stress_mises(dyna_maxint);
-    std::vector<float> layers_plastic_strain(dyna_maxint);
-    // matrices
-    std::vector<std::vector<float>> layers_stress(
-      6, std::vector<float>(dyna_maxint));
-    std::vector<std::vector<float>> layers_strain(6, std::vector<float>(2));
-    std::vector<std::vector<float>> layers_history(
-      this->history_shell_read.size(), std::vector<float>(dyna_maxint));
-
-    // Do the thing ...
-    size_t iElement = 0;
-    for (int32_t ii = start; ii < start + wordsToRead; ++iElement) {
-
-      // #pragma omp for schedule(dynamic)
-      // #pragma omp for
-      // for (int32_t iElement = 0; iElement < nElements_shell; ++iElement) {
-
-      // auto ii = start + element_offsets[iElement];
-      // const auto ii = start + iElement * dyna_nv2d;
-
-      // get element (and check for rigidity)
-      auto element =
-        this->get_db_elements()->get_elementByIndex(Element::SHELL, iElement);
-
-      // Fix:
-      // Interestingly, dyna seems to write result values for rigid shells in
-      // the d3part file, but not in the d3plot. Of course this is not
-      // documented ...
-      // 5 -> d3part
-      if (dyna_filetype != 5 && element->get_is_rigid()) {
-        // does not increment ii, but iElement!!!!!
-        continue;
-      }
-
-      // LOOP: LAYERS
-      for (int32_t iLayer = 0; iLayer < dyna_maxint; ++iLayer) {
-        const int32_t layerStart = ii + iLayer * iLayerSize;
-
-        // LAYER: STRESS TENSOR AND MISES
-        if ((this->stress_read || this->stress_mises_read) && (dyna_ioshl1)) {
-          layers_stress[0][iLayer] = this->buffer->read_float(layerStart);
-          layers_stress[1][iLayer] = this->buffer->read_float(layerStart + 1);
-          layers_stress[2][iLayer] = this->buffer->read_float(layerStart + 2);
-          layers_stress[3][iLayer] = this->buffer->read_float(layerStart + 3);
-          layers_stress[4][iLayer] = this->buffer->read_float(layerStart + 4);
-          layers_stress[5][iLayer] = this->buffer->read_float(layerStart + 5);
-
-          // stress mises calculation
-          if (this->stress_mises_read) {
-            tmp_vec6[0] = layers_stress[0][iLayer];
-            tmp_vec6[1] = layers_stress[1][iLayer];
-            tmp_vec6[2] = layers_stress[2][iLayer];
-            tmp_vec6[3] = layers_stress[3][iLayer];
-            tmp_vec6[4] = layers_stress[4][iLayer];
-            tmp_vec6[5] = layers_stress[5][iLayer];
-            layers_stress_mises[iLayer] = MathUtility::mises_stress(tmp_vec6);
-          }
-
-        } // end:stress
-
-        // LAYER: PLASTIC_STRAIN
-        if ((this->plastic_strain_read) && (dyna_ioshl2)) {
-
-          layers_plastic_strain[iLayer] =
-            this->buffer->read_float(layerStart + iPlastStrainOffset);
-        }
-
-        // LAYERS: HISTORY SHELL
-        if (this->dyna_neips) {
-          int32_t iHistoryStart = layerStart + iHistoryOffset - 1;
-
-          for (size_t iHistoryVar = 0;
-               iHistoryVar < this->history_shell_read.size();
-               ++iHistoryVar) {
-
-            // history vars start with index 1 and not 0, thus the -1
-            layers_history[iHistoryVar][iLayer] = this->buffer->read_float(
-              iHistoryStart + history_shell_read[iHistoryVar]);
-
-          } // loop:history
-        }   // if:history
-
-      } // loop:layers
-
-      // add layer vars (if requested)
-      if (dyna_ioshl2 && this->plastic_strain_read)
-        element->add_plastic_strain(compute_state_var_from_mode(
-          layers_plastic_strain, this->plastic_strain_read));
-      if (dyna_ioshl1 && this->stress_read)
-        element->add_stress(
-          compute_state_var_from_mode(layers_stress, this->stress_read));
-      if (dyna_ioshl1 && this->stress_mises_read)
-        element->add_stress_mises(compute_state_var_from_mode(
-          layers_stress_mises, this->stress_mises_read));
-      if (this->history_shell_read.size())
-        element->add_history_vars(
-          compute_state_var_from_mode(layers_history, this->history_shell_mode),
-          iState);
-
-      // STRAIN TENSOR
-      if (dyna_istrn && this->strain_read) {
-
-        int32_t strainStart = this->own_has_internal_energy
-                                ? ii + dyna_nv2d - 13
-                                : ii + dyna_nv2d - 12;
-
-        layers_strain[0][0] = this->buffer->read_float(strainStart);
-        layers_strain[1][0] = this->buffer->read_float(strainStart + 1);
-        layers_strain[2][0] = this->buffer->read_float(strainStart + 2);
-        layers_strain[3][0] = this->buffer->read_float(strainStart + 3);
-        layers_strain[4][0] = this->buffer->read_float(strainStart + 4);
-        layers_strain[5][0] = this->buffer->read_float(strainStart + 5);
-        layers_strain[0][1] = this->buffer->read_float(strainStart + 6);
-        layers_strain[1][1] = this->buffer->read_float(strainStart + 7);
-        layers_strain[2][1] = this->buffer->read_float(strainStart + 8);
-        layers_strain[3][1] = this->buffer->read_float(strainStart + 9);
-        layers_strain[4][1] = this->buffer->read_float(strainStart + 10);
-        layers_strain[5][1] = this->buffer->read_float(strainStart + 11);
-
-        element->add_strain(
-          compute_state_var_from_mode(layers_strain, this->strain_read));
-      }
-
-      // INTERNAL ENERGY
-      if (this->energy_read && this->own_has_internal_energy) {
-        element->add_energy(this->buffer->read_float(ii + dyna_nv2d - 1));
-      }
-
-      /*
-      // internal energy (a little complicated ... but that's dyna)
-      if (this->energy_read && dyna_ioshl4) {
-        if (dyna_istrn == 1) {
-          if (dyna_nv2d >= 45)
-            element->add_energy(this->buffer->read_float(ii + dyna_nv2d -
-      1)); } else { element->add_energy(this->buffer->read_float(ii +
-      dyna_nv2d - 1));
-        }
-      }
-      */
-
-      ii += dyna_nv2d;
-    } // for elements
-  }   // pragma omp parallel
+  const int32_t strain_offset =
+    (dyna_istrn && this->strain_read)
+      ? (this->own_has_internal_energy ? dyna_nv2d - 13 : dyna_nv2d - 12)
+      : -1;
+  const int32_t energy_offset =
+    (this->energy_read && this->own_has_internal_energy) ? dyna_nv2d - 1 : -1;
+
+  read_states_layered_elements(Element::SHELL,
+                               start,
+                               static_cast<size_t>(dyna_nel4 - dyna_numrbe),
+                               static_cast<size_t>(dyna_nv2d),
+                               strain_offset,
+                               energy_offset,
+                               iState);
 }
 
 /** Read the state data of the thick shell elements
@@ -2179,127 +2265,238 @@ D3plot::read_states_elem4th(size_t iState)
 
   wordsToRead = dyna_nelth * dyna_nv3dt;
 
-  // offsets
-  int32_t iPlastStrainOffset = this->dyna_ioshl1 * 6; // stresses before?
-  int32_t iHistoryOffset =
-    iPlastStrainOffset + this->dyna_ioshl2; // stresses & pl. strain before
-  int32_t iLayerSize = dyna_neips + iHistoryOffset;
-
-  // helpful vars
-  bool has_strains = this->dyna_neiph >= 6;
-  // vectors
-  std::vector<float> tmp_vec6(6);
-  std::vector<float> layers_stress_mises(dyna_maxint);
-  std::vector<float> layers_plastic_strain(dyna_maxint);
-  // matrices
-  std::vector<std::vector<float>> layers_stress(
-    6, std::vector<float>(dyna_maxint));
-  std::vector<std::vector<float>> layers_strain(6, std::vector<float>(2));
-  std::vector<std::vector<float>> layers_history(
-    this->history_shell_read.size(), std::vector<float>(dyna_maxint));
-
-  // Do the thing ...
+  // no internal energy for tshells?
+  const bool has_strains = this->dyna_neiph >= 6;
+  const int32_t strain_offset =
+    ((dyna_istrn == 1) && this->strain_read && has_strains)
+      ? ((dyna_nv2d >= 45) ? dyna_nv2d - 13 : dyna_nv2d - 12)
+      : -1;
+
+  read_states_layered_elements(Element::TSHELL,
+                               start,
+                               static_cast<size_t>(dyna_nelth),
+                               static_cast<size_t>(dyna_nv3dt),
+                               strain_offset,
+                               -1,
+                               iState);
+}
+
+/** Read the state data of elements with integration layers
+ *
+ * @param _element_type : SHELL or TSHELL
+ * @param _start : word position of the first element
+ * @param _nElements : number of elements written in the file
+ * @param _element_stride : number of words per element
+ * @param _strain_offset : word offset of the strains in an element or -1
+ * @param _energy_offset : word offset of the energy in an element or -1
+ * @param iState : current state
+ *
+ * The elements are copied block wise from the buffer and the layers
+ * of every variable are reduced for the entire block at once.
+ */
+void
+D3plot::read_states_layered_elements(Element::ElementType _element_type,
+                                     int32_t _start,
+                                     size_t _nElements,
+                                     size_t _element_stride,
+                                     int32_t _strain_offset,
+                                     int32_t _energy_offset,
+                                     size_t iState)
+{
+  constexpr size_t block_size = 1024;
+
+  const size_t nLayers = static_cast<size_t>(dyna_maxint);
+  const size_t iPlastStrainOffset = this->dyna_ioshl1 * 6;
+  const size_t iHistoryOffset = iPlastStrainOffset + this->dyna_ioshl2;
+  const size_t iLayerSize = dyna_neips + iHistoryOffset;
+  const size_t nHistory = this->history_shell_read.size();
+
+  const bool read_stress = dyna_ioshl1 && this->stress_read;
+  const bool read_stress_mises = dyna_ioshl1 && this->stress_mises_read;
+  const bool read_plastic_strain = dyna_ioshl2 && this->plastic_strain_read;
+  const bool read_layers =
+    _element_type == Element::SHELL && this->shell_layers_read;
+
+  // reduced results of a block
+  std::vector<float> block;
+  std::vector<float> stress(read_stress ? 6 * block_size : 0);
+  std::vector<float> layers_stress_mises(
+    read_stress_mises ? nLayers * block_size : 0);
+  std::vector<float> stress_mises(read_stress_mises ? block_size : 0);
+  std::vector<float> plastic_strain(read_plastic_strain ? block_size : 0);
+  std::vector<float> strain(_strain_offset >= 0 ? 6 * block_size : 0);
+  std::vector<float> history(nHistory * block_size);
+  std::vector<float> history_var(nHistory ? block_size : 0);
+
+  // results reduced over time instead of stored
+  DB_Elements* db_elements = this->get_db_elements();
+  const size_t nTypeElements = db_elements->get_nElements(_element_type);
+  auto stress_envelope =
+    read_states_get_envelope("stress", _element_type, nTypeElements, 6);
+  auto stress_mises_envelope =
+    read_states_get_envelope("stress_mises", _element_type, nTypeElements, 1);
+  auto plastic_strain_envelope =
+    read_states_get_envelope("plastic_strain", _element_type, nTypeElements, 1);
+  auto strain_envelope =
+    read_states_get_envelope("strain", _element_type, nTypeElements, 6);
+  auto energy_envelope =
+    read_states_get_envelope("energy", _element_type, nTypeElements, 1);
+
+  // raw layer storage (nTimesteps x nShells x nLayers x nLayerVars)
+  // FLOAT32 is written into the storage directly, compact storage needs
+  // the range of the state, so the state is collected in full first
+  const size_t nLayerVars = nLayers * iLayerSize;
+  std::vector<float> layers_state;
+  float* layers_out = nullptr;
+  if (read_layers) {
+    if (this->shell_layers == nullptr)
+      this->shell_layers =
+        std::make_shared<CompactTensor>(this->shell_layers_precision);
+    if (this->shell_layers->get_shape().empty() ||
+        this->shell_layers->get_shape()[0] <= iState)
+      this->shell_layers->resize(
+        { iState + 1, nTypeElements, nLayers, iLayerSize });
+    layers_out = this->shell_layers->get_float_slice(iState);
+    if (layers_out == nullptr) {
+      layers_state.resize(nTypeElements * nLayerVars);
+      layers_out = layers_state.data();
+    }
+  }
+
   size_t iElement = 0;
-  for (int32_t ii = start; ii < start + wordsToRead; ++iElement) {
+  for (size_t iBlockStart = 0; iBlockStart < _nElements;
+       iBlockStart += block_size) {
+
+    const size_t nBlock = std::min(block_size, _nElements - iBlockStart);
+    block.resize(nBlock * _element_stride);
+    this->buffer->read_array(
+      _start + static_cast<int32_t>(iBlockStart * _element_stride),
+      static_cast<int32_t>(block.size()),
+      block);
+    const float* data = block.data();
+
+    // LAYERS: STRESS TENSOR AND MISES
+    if (read_stress)
+      reduce_layers(data,
+                    nBlock,
+                    _element_stride,
+                    nLayers,
+                    iLayerSize,
+                    6,
+                    this->stress_read,
+                    stress.data());
+    if (read_stress_mises) {
+      for (size_t iRow = 0; iRow < nBlock; ++iRow)
+        for (size_t iLayer = 0; iLayer < nLayers; ++iLayer)
+          layers_stress_mises[iRow * nLayers + iLayer] =
+            MathUtility::mises_stress(data + iRow * _element_stride +
+                                      iLayer * iLayerSize);
+
+      reduce_layers(layers_stress_mises.data(),
+                    nBlock,
+                    nLayers,
+                    nLayers,
+                    1,
+                    1,
+                    this->stress_mises_read,
+                    stress_mises.data());
+    }
 
-    // get element
-    auto element =
-      this->get_db_elements()->get_elementByIndex(Element::TSHELL, iElement);
+    // LAYERS: PLASTIC STRAIN
+    if (read_plastic_strain)
+      reduce_layers(data + iPlastStrainOffset,
+                    nBlock,
+                    _element_stride,
+                    nLayers,
+                    iLayerSize,
+                    1,
+                    this->plastic_strain_read,
+                    plastic_strain.data());
+
+    // LAYERS: HISTORY SHELL
+    // history vars start with index 1 and not 0, thus the -1
+    for (size_t iHistoryVar = 0; iHistoryVar < nHistory; ++iHistoryVar) {
+      reduce_layers(data + iHistoryOffset - 1 +
+                      this->history_shell_read[iHistoryVar],
+                    nBlock,
+                    _element_stride,
+                    nLayers,
+                    iLayerSize,
+                    1,
+                    this->history_shell_mode[iHistoryVar],
+                    history_var.data());
+      for (size_t iRow = 0; iRow < nBlock; ++iRow)
+        history[iRow * nHistory + iHistoryVar] = history_var[iRow];
+    }
 
-    // LOOP: LAYERS
-    for (int32_t iLayer = 0; iLayer < dyna_maxint; ++iLayer) {
-      int32_t layerStart = ii + iLayer * iLayerSize;
+    // STRAIN TENSOR (inner and outer layer)
+    if (_strain_offset >= 0)
+      reduce_layers(data + _strain_offset,
+                    nBlock,
+                    _element_stride,
+                    2,
+                    6,
+                    6,
+                    this->strain_read,
+                    strain.data());
 
-      // LAYER: PLASTIC_STRAIN
-      if ((this->plastic_strain_read) && (dyna_ioshl2)) {
+    // hand the results to the elements
+    for (size_t iRow = 0; iRow < nBlock; ++iElement) {
 
-        layers_plastic_strain[iLayer] =
-          this->buffer->read_float(layerStart + iPlastStrainOffset);
-      }
+      auto element = db_elements->get_elementByIndex(_element_type, iElement);
 
-      // LAYER: STRESS TENSOR AND MISES
-      if ((this->stress_read || this->stress_mises_read) &&
-          (this->dyna_ioshl1)) {
-
-        layers_stress[0][iLayer] = this->buffer->read_float(layerStart);
-        layers_stress[1][iLayer] = this->buffer->read_float(layerStart + 1);
-        layers_stress[2][iLayer] = this->buffer->read_float(layerStart + 2);
-        layers_stress[3][iLayer] = this->buffer->read_float(layerStart + 3);
-        layers_stress[4][iLayer] = this->buffer->read_float(layerStart + 4);
-        layers_stress[5][iLayer] = this->buffer->read_float(layerStart + 5);
-
-        // stress mises calculation
-        if (this->stress_mises_read) {
-          tmp_vec6[0] = layers_stress[0][iLayer];
-          tmp_vec6[1] = layers_stress[1][iLayer];
-          tmp_vec6[2] = layers_stress[2][iLayer];
-          tmp_vec6[3] = layers_stress[3][iLayer];
-          tmp_vec6[4] = layers_stress[4][iLayer];
-          tmp_vec6[5] = layers_stress[5][iLayer];
-          layers_stress_mises[iLayer] = MathUtility::mises_stress(tmp_vec6);
-        }
+      // Fix:
+      // Interestingly, dyna seems to write result values for rigid shells in
+      // the d3part file, but not in the d3plot. Of course this is not
+      // documented ...
+      // 5 -> d3part
+      if (_element_type == Element::SHELL && dyna_filetype != 5 &&
+          element->get_is_rigid()) {
+        // does not increment iRow, but iElement!!!!!
+        continue;
+      }
 
-      } // end:stress
-
-      // LAYERS: HISTORY SHELL
-      if (this->dyna_neips) {
-        int32_t iHistoryStart = layerStart + iHistoryOffset - 1;
-
-        for (size_t iHistoryVar = 0;
-             iHistoryVar < this->history_shell_read.size();
-             ++iHistoryVar) {
-
-          // history vars start with index 1 and not 0, thus the -1
-          layers_history[iHistoryVar][iLayer] = this->buffer->read_float(
-            iHistoryStart + history_shell_read[iHistoryVar]);
-
-        } // loop:history
-      }   // if:history
-
-    } // loop:layers
-
-    // add layer vars (if requested)
-    if (dyna_ioshl2 && this->plastic_strain_read)
-      element->add_plastic_strain(compute_state_var_from_mode(
-        layers_plastic_strain, this->plastic_strain_read));
-    if (dyna_ioshl1 && this->stress_read)
-      element->add_stress(
-        compute_state_var_from_mode(layers_stress, this->stress_read));
-    if (dyna_ioshl1 && this->stress_mises_read)
-      element->add_stress_mises(compute_state_var_from_mode(
-        layers_stress_mises, this->plastic_strain_read));
-    if (this->history_shell_read.size())
-      element->add_history_vars(
-        compute_state_var_from_mode(layers_history, this->history_shell_mode),
-        iState);
-
-    // STRAIN TENSOR
-    if ((dyna_istrn == 1) && this->strain_read && has_strains) {
-
-      int32_t strainStart =
-        (dyna_nv2d >= 45) ? ii + dyna_nv2d - 13 : ii + dyna_nv2d - 12;
-
-      layers_strain[0][0] = this->buffer->read_float(strainStart);
-      layers_strain[1][0] = this->buffer->read_float(strainStart + 1);
-      layers_strain[2][0] = this->buffer->read_float(strainStart + 2);
-      layers_strain[3][0] = this->buffer->read_float(strainStart + 3);
-      layers_strain[4][0] = this->buffer->read_float(strainStart + 4);
-      layers_strain[5][0] = this->buffer->read_float(strainStart + 5);
-      layers_strain[0][1] = this->buffer->read_float(strainStart + 6);
-      layers_strain[1][1] = this->buffer->read_float(strainStart + 7);
-      layers_strain[2][1] = this->buffer->read_float(strainStart + 8);
-      layers_strain[3][1] = this->buffer->read_float(strainStart + 9);
-      layers_strain[4][1] = this->buffer->read_float(strainStart + 10);
-      layers_strain[5][1] = this->buffer->read_float(strainStart + 11);
-
-      element->add_strain(
-        compute_state_var_from_mode(layers_strain, this->strain_read));
-    }
+      if (plastic_strain_envelope && read_plastic_strain)
+        plastic_strain_envelope->add(iElement, iState, &plastic_strain[iRow]);
+      else if (read_plastic_strain)
+        element->add_plastic_strain(plastic_strain[iRow]);
+      if (stress_envelope && read_stress)
+        stress_envelope->add(iElement, iState, &stress[6 * iRow]);
+      else if (read_stress)
+        element->add_stress(std::vector<float>(
+          stress.begin() + 6 * iRow, stress.begin() + 6 * (iRow + 1)));
+      if (stress_mises_envelope && read_stress_mises)
+        stress_mises_envelope->add(iElement, iState, &stress_mises[iRow]);
+      else if (read_stress_mises)
+        element->add_stress_mises(stress_mises[iRow]);
+      if (nHistory)
+        element->add_history_vars(
+          std::vector<float>(history.begin() + nHistory * iRow,
+                             history.begin() + nHistory * (iRow + 1)),
+          iState);
+      if (strain_envelope && _strain_offset >= 0)
+        strain_envelope->add(iElement, iState, &strain[6 * iRow]);
+      else if (_strain_offset >= 0)
+        element->add_strain(std::vector<float>(
+          strain.begin() + 6 * iRow, strain.begin() + 6 * (iRow + 1)));
+      if (energy_envelope && _energy_offset >= 0)
+        energy_envelope->add(
+          iElement, iState, data + iRow * _element_stride + _energy_offset);
+      else if (_energy_offset >= 0)
+        element->add_energy(data[iRow * _element_stride + _energy_offset]);
+
+      if (read_layers) {
+        const float* layers = data + iRow * _element_stride;
+        std::copy(
+          layers, layers + nLayerVars, layers_out + iElement * nLayerVars);
+      }
 
-    // no internal energy for tshells?
+      ++iRow;
+    } // for rows
+  }   // for blocks
 
-    ii += dyna_nv3dt;
-  } // for elements
+  if (read_layers && !layers_state.empty())
+    this->shell_layers->set_slice(iState, layers_state.data());
 }
 
 /** Read the airbag state data
@@ -2384,6 +2581,8 @@ D3plot::clear(const std::string& _variable)
 void
 D3plot::clear(const std::vector<std::string>& _variables)
 {
+  std::lock_guard<std::recursive_mutex> lock(state_mutex);
+
   // Default: Clear all
   if (_variables.size() == 0) {
     // hihi this is a naughty trick ... calling myself again
@@ -2398,6 +2597,9 @@ D3plot::clear(const std::vector<std::string>& _variables)
     _tmp.push_back("stress_mises");
     _tmp.push_back("history shell");
     _tmp.push_back("history solid");
+    _tmp.push_back("shell_layers");
+    _tmp.push_back("coords");
+    _tmp.push_back("envelope");
     this->clear(_tmp);
 
   } else {
@@ -2413,7 +2615,37 @@ D3plot::clear(const std::vector<std::string>& _variables)
     bool delete_history_shell = false;
     bool delete_history_solid = false;
     for (size_t iVar = 0; iVar < _variables.size(); ++iVar) {
-      if (_variables[iVar].find("disp") != std::string::npos) {
+      const auto envelope_pos = _variables[iVar].find("envelope");
+      if (envelope_pos != std::string::npos) {
+        // same matching order as in read_states_parse, all if no result
+        const std::vector<std::string> result_names = {
+          "disp",   "vel",           "accel",  "stress_mises",
+          "stress", "plastic_strain", "strain", "energy"
+        };
+        auto variable = _variables[iVar];
+        variable.erase(envelope_pos, std::string("envelope").size());
+
+        std::string result_name;
+        for (const auto& name : result_names) {
+          if (variable.find(name) != std::string::npos) {
+            result_name = name;
+            break;
+          }
+        }
+
+        for (auto it = this->envelopes.begin(); it != this->envelopes.end();) {
+          if (result_name.empty() || it->first.first == result_name)
+            it = this->envelopes.erase(it);
+          else
+            ++it;
+        }
+      } else if (_variables[iVar].find("shell_layers") != std::string::npos) {
+        this->shell_layers = nullptr;
+        this->shell_layers_is_read = false;
+      } else if (_variables[iVar].find("coords") != std::string::npos) {
+        this->get_db_nodes()->clear_node_positions();
+        this->coords_is_read = false;
+      } else if (_variables[iVar].find("disp") != std::string::npos) {
         delete_disp = true;
       } else if (_variables[iVar].find("vel") != std::string::npos) {
         delete_vel = true;
@@ -2542,6 +2774,56 @@ D3plot::clear(const std::vector<std::string>& _variables)
   }   // end:else for deletion
 } // end:function clear
 
+/** Get the raw integration layer results of the shells
+ *
+ * @return tensor : (nTimesteps x nShells x nLayers x nLayerVars)
+ *
+ * The layer variables are the stresses (xx,yy,zz,xy,yz,xz), the
+ * plastic strain and the history variables, as far as present in the
+ * file. Rigid shells have no results and are 0. The data needs to be
+ * read with read_states("shell_layers"). If it was read with a compact
+ * precision, e.g. read_states("shell_layers float16"), it is widened
+ * to float in a new tensor.
+ */
+Tensor_ptr<float>
+D3plot::get_shell_layer_results()
+{
+  std::lock_guard<std::recursive_mutex> lock(state_mutex);
+
+  if (!this->shell_layers_is_read || this->shell_layers == nullptr)
+    throw(std::invalid_argument(
+      "Shell layer results were not read, use read_states(\"shell_layers\")."));
+
+  return this->shell_layers->get_tensor();
+}
+
+/** Get a result reduced over time during reading
+ *
+ * @param _result_name : disp, vel, accel, stress_mises, stress,
+ *                       plastic_strain, strain or energy
+ * @param _element_type : type of the elements, NONE for node results
+ * @return envelope : extrema over time and the states they occurred in
+ *
+ * The envelope is computed with e.g. read_states("plastic_strain envelope"),
+ * which does not store the time history in the elements. Node results are
+ * reduced to the length of the vector, the displacement is taken from the
+ * initial position.
+ */
+TimeEnvelope_ptr<float>
+D3plot::get_result_envelope(const std::string& _result_name,
+                            Element::ElementType _element_type)
+{
+  std::lock_guard<std::recursive_mutex> lock(state_mutex);
+
+  auto it = this->envelopes.find(std::make_pair(_result_name, _element_type));
+  if (it == this->envelopes.end())
+    throw(std::invalid_argument(
+      "No envelope of " + _result_name + " was read for the element type, " +
+      "use read_states(\"" + _result_name + " envelope\")."));
+
+  return it->second;
+}
+
 /**
  *
  */
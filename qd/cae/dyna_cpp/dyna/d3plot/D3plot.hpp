@@ -3,14 +3,21 @@
 #define D3PLOT_HPP
 
 // includes
+#include <dyna_cpp/db/Element.hpp>
 #include <dyna_cpp/db/FEMFile.hpp>
+#include <dyna_cpp/math/CompactTensor.hpp>
+#include <dyna_cpp/math/Tensor.hpp>
+#include <dyna_cpp/math/TimeEnvelope.hpp>
 
 #include <algorithm>
 #include <cstdint>
 #include <iostream>
+#include <map>
 #include <memory>
+#include <mutex>
 #include <stdexcept>
 #include <string>
+#include <utility>
 #include <vector>
 
 namespace qd {
@@ -131,6 +138,19 @@ private:
   int32_t acc_read;
   bool vel_is_read;
   int32_t vel_read;
+  bool coords_is_read;
+  bool coords_read;
+  Precision coords_precision;
+  bool shell_layers_is_read;
+  bool shell_layers_read;
+  CompactTensor_ptr shell_layers; // raw shell layer results
+  Precision shell_layers_precision;
+
+  // results reduced over time while reading, by result and element type
+  std::vector<std::string> envelope_read;
+  std::map<std::pair<std::string, Element::ElementType>,
+           TimeEnvelope_ptr<float>>
+    envelopes;
 
   std::vector<int32_t> history_is_read;
   std::vector<int32_t> history_shell_is_read;
@@ -167,12 +187,29 @@ private:
   void read_states_init();
   void read_states_parse(std::vector<std::string>);
   int32_t read_states_parse_readMode(const std::string& _variable) const;
-  void read_states_displacement();
-  void read_states_velocity();
-  void read_states_acceleration();
+  bool read_states_parse_envelope(bool _is_envelope,
+                                  const std::string& _result_name,
+                                  int32_t& _read_mode);
+  bool read_states_is_envelope(const std::string& _result_name) const;
+  TimeEnvelope_ptr<float> read_states_get_envelope(
+    const std::string& _result_name,
+    Element::ElementType _element_type,
+    size_t _nEntities,
+    size_t _nComponents);
+  void read_states_displacement(size_t iState);
+  void read_states_coords(size_t iState);
+  void read_states_velocity(size_t iState);
+  void read_states_acceleration(size_t iState);
   void read_states_elem8(size_t iState);
   void read_states_elem4(size_t iState);
   void read_states_elem4th(size_t iState);
+  void read_states_layered_elements(Element::ElementType _element_type,
+                                    int32_t _start,
+                                    size_t _nElements,
+                                    size_t _element_stride,
+                                    int32_t _strain_offset,
+                                    int32_t _energy_offset,
+                                    size_t iState);
   void read_states_airbag();
   bool isFileEnding(int32_t _iWord);
 
@@ -195,6 +232,10 @@ public:
   size_t get_nTimesteps() const override;
   std::string get_title() const;
   std::vector<float> get_timesteps() const;
+  Tensor_ptr<float> get_shell_layer_results();
+  TimeEnvelope_ptr<float> get_result_envelope(
+    const std::string& _result_name,
+    Element::ElementType _element_type = Element::NONE);
   /*
   void save_hdf5(const std::string& _filepath,
                  bool _overwrite_run,
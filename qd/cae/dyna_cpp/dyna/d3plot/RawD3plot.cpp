@@ -2079,6 +2079,40 @@ RawD3plot::get_float_data(const std::string& _name)
   }
 }
 
+/** Get the min and max of state data over time
+ *
+ * @param _name : variable name of a state array, e.g. elem_shell_results
+ * @return envelope : (nEntities x nComponents) extrema and their states
+ *
+ * The first axis of the array are the states and the second the
+ * entities, e.g. nodes or elements. All further axes are flattened
+ * into the components.
+ */
+TimeEnvelope_ptr<float>
+RawD3plot::get_float_data_envelope(const std::string& _name)
+{
+  auto tensor = this->get_float_data(_name);
+
+  const auto& shape = tensor->get_shape();
+  if (shape.size() < 2)
+    throw(std::invalid_argument(
+      "Can not compute an envelope of " + _name +
+      ", since it has less than two dimensions (nStates x nEntities)."));
+
+  size_t nComponents = 1;
+  for (size_t iDim = 2; iDim < shape.size(); ++iDim)
+    nComponents *= shape[iDim];
+
+  auto envelope = std::make_shared<TimeEnvelope<float>>(shape[1], nComponents);
+
+  const float* data = tensor->get_data().data();
+  const size_t state_size = shape[1] * nComponents;
+  for (size_t iState = 0; iState < shape[0]; ++iState)
+    envelope->add_state(iState, data + iState * state_size);
+
+  return envelope;
+}
+
 /** Get float data variables available
  *
  * @param ret : vector of variable names available
@@ -2119,6 +2153,18 @@ RawD3plot::set_float_data(const std::string& _name,
   std::copy(_data_ptr, _data_ptr + offset, tensor->get_data().begin());
 }
 
+/** Insert a float memory array into the file buffer
+ *
+ * @param _name : name of the variable
+ * @param _data : data array, which is shared and not copied
+ */
+void
+RawD3plot::set_float_data(const std::string& _name,
+                          std::shared_ptr<Tensor<float>> _data)
+{
+  float_data.insert(std::make_pair(_name, _data));
+}
+
 /** Insert an int memory array into the file buffer
  *
  * @param _name : name of the variable
@@ -10,6 +10,7 @@
 #include <vector>
 
 #include <dyna_cpp/math/Tensor.hpp>
+#include <dyna_cpp/math/TimeEnvelope.hpp>
 
 namespace qd {
 
@@ -168,9 +169,11 @@ public:
   std::vector<std::string> get_string_names() const;
   Tensor_ptr<float> get_float_data(const std::string& _name);
   std::vector<std::string> get_float_names() const;
+  TimeEnvelope_ptr<float> get_float_data_envelope(const std::string& _name);
   void set_float_data(const std::string& _name,
                       std::vector<size_t> _shape,
                       const float* _data_ptr);
+  void set_float_data(const std::string& _name, Tensor_ptr<float> _data);
   void set_int_data(const std::string& _name,
                     std::vector<size_t> _shape,
                     const int* _data_ptr);
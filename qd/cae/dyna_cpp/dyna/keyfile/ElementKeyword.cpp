@@ -1,5 +1,5 @@
 
-#include <iomanip>
+#include <iostream>
 
 #include <dyna_cpp/db/Node.hpp>
 #include <dyna_cpp/dyna/keyfile/ElementKeyword.hpp>
@@ -156,6 +156,7 @@ ElementKeyword::parse_elem2(const std::string& _keyword_name_lower,
 
   // remove all lines below keyword
   lines.resize(header_size);
+  field_indexes_cache.clear();
 }
 
 /** Parse the string buffer as shell element
@@ -257,6 +258,7 @@ ElementKeyword::parse_elem4(const std::string& _keyword_name_lower,
 
   // remove all lines below keyword
   lines.resize(header_size);
+  field_indexes_cache.clear();
 }
 
 /** Parse the string buffer as solid elements
@@ -364,6 +366,7 @@ ElementKeyword::parse_elem8(const std::string& _keyword_name_lower,
 
   // remove all lines below keyword
   lines.resize(header_size);
+  field_indexes_cache.clear();
 }
 
 /** Parse the string buffer as thick elements
@@ -444,6 +447,7 @@ ElementKeyword::parse_elem4th(const std::string& _keyword_name_lower,
 
   // remove all lines below keyword
   lines.resize(header_size);
+  field_indexes_cache.clear();
 }
 
 /** Get the element type from the keyword name
@@ -457,19 +461,17 @@ ElementKeyword::determine_element_type(const std::string& _keyword_name) const
   if (_keyword_name.size() <= 9)
     return Element::ElementType::NONE;
 
-  auto line_lower = to_lower_copy(_keyword_name);
-
   // hardcoding festival !!!!!!! yeah !!!!!!
-  if (line_lower.compare(9, 5, "shell") == 0)
+  if (starts_with_icase(_keyword_name, 9, "shell"))
     return Element::ElementType::SHELL;
 
-  else if (line_lower.compare(9, 4, "beam") == 0)
+  else if (starts_with_icase(_keyword_name, 9, "beam"))
     return Element::ElementType::BEAM;
 
-  else if (line_lower.compare(9, 5, "solid") == 0)
+  else if (starts_with_icase(_keyword_name, 9, "solid"))
     return Element::ElementType::SOLID;
 
-  else if (line_lower.compare(9, 6, "tshell") == 0)
+  else if (starts_with_icase(_keyword_name, 9, "tshell"))
     return Element::ElementType::TSHELL;
 
   else
@@ -492,166 +494,149 @@ ElementKeyword::get_elements()
   return std::move(elems);
 }
 
-/** Convert keyword into a string
+/** Write the keyword into a writer
  *
- * @return str
+ * @param _writer : sink to write to
  */
-std::string
-ElementKeyword::str()
+void
+ElementKeyword::write(BufferedWriter& _writer)
 {
-  // build header
-  std::stringstream ss;
+  // write header
   for (const auto& entry : lines)
-    ss << entry << '\n';
+    _writer.write_line(entry);
 
   // do the thing
   if (element_type == Element::ElementType::BEAM)
-    keyword_elem2_str(ss);
+    write_elem2(_writer);
   else if (element_type == Element::ElementType::SHELL)
-    keyword_elem4_str(ss);
+    write_elem4(_writer);
   else if (element_type == Element::ElementType::SOLID)
-    keyword_elem8_str(ss);
+    write_elem8(_writer);
 
   // trailing lines
   for (const auto& line : trailing_lines)
-    ss << line << '\n';
-
-  return ss.str();
+    _writer.write_line(line);
 }
 
-/** Convert the keyword to string for elem2
- * @param _ss :  stringstream to put stuff in
+/** Write the elements as elem2
+ *
+ * @param _writer : sink to write to
  */
 void
-ElementKeyword::keyword_elem2_str(std::stringstream& _ss)
+ElementKeyword::write_elem2(BufferedWriter& _writer)
 {
 
-  _ss.precision(7); // float
   for (size_t iElement = 0; iElement < elem_indexes_in_card.size();
        ++iElement) {
 
     // this is faster than getting nodes
     auto element = get_elementByIndex(iElement);
-    auto elem_nodes = element->get_nodes();
+    const auto& node_ids = element->get_node_ids();
 
-    _ss << std::setw(field_size) << element->get_elementID()
-        << std::setw(field_size) << elem_part_ids[iElement]
-        << std::setw(field_size) << elem_nodes[0]->get_nodeID()
-        << std::setw(field_size) << elem_nodes[1]->get_nodeID()
-        << unparsed_element_data[iElement] << '\n';
+    _writer.write_int(element->get_elementID(), field_size);
+    _writer.write_int(elem_part_ids[iElement], field_size);
+    _writer.write_int(node_ids[0], field_size);
+    _writer.write_int(node_ids[1], field_size);
+    _writer.write_line(unparsed_element_data[iElement]);
   }
 }
 
-/** Convert the keyword to string for elem2
- * @param _ss :  stringstream to put stuff in
+/** Write the elements as elem4
+ *
+ * @param _writer : sink to write to
  */
 void
-ElementKeyword::keyword_elem4_str(std::stringstream& _ss)
+ElementKeyword::write_elem4(BufferedWriter& _writer)
 {
   // index for comparison, whether we have 3 or 4 nodes
   // if we have 3 then the last is printed twice
   constexpr size_t magic_index = 2;
 
-  _ss.precision(7); // float
   for (size_t iElement = 0; iElement < elem_indexes_in_card.size();
        ++iElement) {
 
     // element and nodes
     auto element = get_elementByIndex(iElement);
-    auto elem_nodes = element->get_nodes();
+    const auto& node_ids = element->get_node_ids();
 
     // write stuff
-    _ss
-      << std::setw(field_size) << element->get_elementID()
-      << std::setw(field_size) << elem_part_ids[iElement]
-      << std::setw(field_size) << elem_nodes[0]->get_nodeID()
-      << std::setw(field_size) << elem_nodes[1]->get_nodeID()
-      << std::setw(field_size) << elem_nodes[2]->get_nodeID()
-      << std::setw(field_size)
-      << elem_nodes[std::max(elem_nodes.size() - 1, magic_index)]->get_nodeID();
+    _writer.write_int(element->get_elementID(), field_size);
+    _writer.write_int(elem_part_ids[iElement], field_size);
+    _writer.write_int(node_ids[0], field_size);
+    _writer.write_int(node_ids[1], field_size);
+    _writer.write_int(node_ids[2], field_size);
+    _writer.write_int(node_ids[std::max(node_ids.size() - 1, magic_index)],
+                      field_size);
 
     if (unparsed_element_data.size() != 0)
-      _ss << unparsed_element_data[iElement] << '\n';
+      _writer.write_line(unparsed_element_data[iElement]);
   }
 }
 
-/** Convert the keyword to string for elem4th
+/** Write the elements as elem4th
  *
- * @param _ss :  stringstream to put stuff in
+ * @param _writer : sink to write to
  */
 void
-ElementKeyword::keyword_elem4th_str(std::stringstream& _ss)
+ElementKeyword::write_elem4th(BufferedWriter& _writer)
 {
 
-  _ss.precision(7); // float
   for (size_t iElement = 0; iElement < elem_indexes_in_card.size();
        ++iElement) {
 
     // element and nodes
     auto element = get_elementByIndex(iElement);
-    auto elem_nodes = element->get_nodes();
-
-    _ss << std::setw(field_size) << element->get_elementID()
-        << std::setw(field_size) << elem_part_ids[iElement];
-
-    if (elem_nodes.size() == 6) {
-      _ss << std::setw(field_size) << elem_nodes[0]->get_nodeID()
-          << std::setw(field_size) << elem_nodes[1]->get_nodeID()
-          << std::setw(field_size) << elem_nodes[2]->get_nodeID()
-          << std::setw(field_size) << elem_nodes[2]->get_nodeID()
-          << std::setw(field_size) << elem_nodes[3]->get_nodeID()
-          << std::setw(field_size) << elem_nodes[4]->get_nodeID()
-          << std::setw(field_size) << elem_nodes[5]->get_nodeID()
-          << std::setw(field_size) << elem_nodes[5]->get_nodeID();
-    } else if (elem_nodes.size() == 8) {
-      _ss << std::setw(field_size) << elem_nodes[0]->get_nodeID()
-          << std::setw(field_size) << elem_nodes[1]->get_nodeID()
-          << std::setw(field_size) << elem_nodes[2]->get_nodeID()
-          << std::setw(field_size) << elem_nodes[3]->get_nodeID()
-          << std::setw(field_size) << elem_nodes[4]->get_nodeID()
-          << std::setw(field_size) << elem_nodes[5]->get_nodeID()
-          << std::setw(field_size) << elem_nodes[6]->get_nodeID()
-          << std::setw(field_size) << elem_nodes[7]->get_nodeID();
+    const auto& node_ids = element->get_node_ids();
+
+    _writer.write_int(element->get_elementID(), field_size);
+    _writer.write_int(elem_part_ids[iElement], field_size);
+
+    if (node_ids.size() == 6) {
+      // degenerated: n3 and n6 are doubled
+      for (size_t iNode : { 0, 1, 2, 2, 3, 4, 5, 5 })
+        _writer.write_int(node_ids[iNode], field_size);
+    } else if (node_ids.size() == 8) {
+      for (auto node_id : node_ids)
+        _writer.write_int(node_id, field_size);
     } else {
       std::cout << "Warning: thick shell with id " << element->get_elementID()
-                << " has an invalid number of nodes: " << elem_nodes.size()
+                << " has an invalid number of nodes: " << node_ids.size()
                 << '\n';
     }
 
     // write stuff
     if (unparsed_element_data.size() != 0)
-      _ss << unparsed_element_data[iElement] << '\n';
+      _writer.write_line(unparsed_element_data[iElement]);
   }
 }
 
-/** Convert the keyword to string for elem2
- * @param _ss :  stringstream to put stuff in
+/** Write the elements as elem8
+ *
+ * @param _writer : sink to write to
  */
 void
-ElementKeyword::keyword_elem8_str(std::stringstream& _ss)
+ElementKeyword::write_elem8(BufferedWriter& _writer)
 {
 
-  _ss.precision(7); // float
   for (size_t iElement = 0; iElement < elem_indexes_in_card.size();
        ++iElement) {
 
     // element and nodes
     auto element = get_elementByIndex(iElement);
-    auto elem_nodes = element->get_nodes();
+    const auto& node_ids = element->get_node_ids();
 
-    _ss << std::setw(field_size) << element->get_elementID()
-        << std::setw(field_size) << elem_part_ids[iElement];
+    _writer.write_int(element->get_elementID(), field_size);
+    _writer.write_int(elem_part_ids[iElement], field_size);
 
-    for (auto& node : elem_nodes)
-      _ss << std::setw(field_size) << node->get_nodeID();
+    for (auto node_id : node_ids)
+      _writer.write_int(node_id, field_size);
 
-    for (size_t iNode = 0; iNode < 8 - elem_nodes.size(); ++iNode) {
-      _ss << std::setw(field_size) << elem_nodes.back()->get_nodeID();
-    }
+    for (size_t iNode = 0; iNode < 8 - node_ids.size(); ++iNode)
+      _writer.write_int(node_ids.back(), field_size);
 
     // write stuff
     if (unparsed_element_data.size() != 0)
-      _ss << unparsed_element_data[iElement] << '\n';
+      _writer.write_line(unparsed_element_data[iElement]);
   }
 }
 
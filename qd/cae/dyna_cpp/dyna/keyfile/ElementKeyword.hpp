@@ -27,10 +27,10 @@ private:
                    const std::vector<std::string>& _lines);
   void parse_elem4th(const std::string& _keyword_name_lower,
                      const std::vector<std::string>& _lines);
-  void keyword_elem2_str(std::stringstream& _ss);
-  void keyword_elem4_str(std::stringstream& _ss);
-  void keyword_elem8_str(std::stringstream& _ss);
-  void keyword_elem4th_str(std::stringstream& _ss);
+  void write_elem2(BufferedWriter& _writer);
+  void write_elem4(BufferedWriter& _writer);
+  void write_elem8(BufferedWriter& _writer);
+  void write_elem4th(BufferedWriter& _writer);
 
 public:
   explicit ElementKeyword(DB_Elements* _db_elems,
@@ -56,7 +56,7 @@ public:
     const std::vector<size_t>& _node_indexes,
     const std::vector<std::string>& _additional_card_data = "");
   std::vector<std::shared_ptr<Element>> get_elements();
-  std::string str() override;
+  void write(BufferedWriter& _writer) override;
 };
 
 /** Get the element type of the keyword
@@ -123,6 +123,7 @@ ElementKeyword::add_elementByNodeIndex(
     db_elems->get_element_index_from_id(element_type, id));
   elem_part_ids.push_back(static_cast<int32_t>(_part_id));
   unparsed_element_data.push_back(str_concat_lines(_additional_card_data));
+  dirty = true;
 
   return elem;
 }
@@ -154,6 +155,7 @@ ElementKeyword::add_elementByNodeID(
     db_elems->get_element_index_from_id(element_type, id));
   elem_part_ids.push_back(static_cast<int32_t>(_part_id));
   unparsed_element_data.push_back(str_concat_lines(_additional_card_data));
+  dirty = true;
 
   return elem;
 }
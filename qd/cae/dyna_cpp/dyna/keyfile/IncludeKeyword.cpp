@@ -76,29 +76,27 @@ IncludeKeyword::load(bool _load_mesh)
     trailing_lines.push_back(lines[iLine]);
 
   lines.resize(header_size);
+  field_indexes_cache.clear();
 }
 
-/** Get the keyword as a string
+/** Write the keyword into a writer
  *
- * @return keyword as string
+ * @param _writer : sink to write to
  */
-std::string
-IncludeKeyword::str()
+void
+IncludeKeyword::write(BufferedWriter& _writer)
 {
-  // build header
-  std::stringstream ss;
+  // write header
   for (const auto& entry : lines)
-    ss << entry << '\n';
+    _writer.write_line(entry);
 
   // data
   for (const auto& include_path : unresolved_filepaths)
-    ss << include_path << '\n';
+    _writer.write_line(include_path);
 
   // trailing lines
   for (const auto& line : trailing_lines)
-    ss << line << '\n';
-
-  return ss.str();
+    _writer.write_line(line);
 }
 
 } // namespace:qd
\ No newline at end of file
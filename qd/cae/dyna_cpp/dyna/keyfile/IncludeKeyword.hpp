@@ -31,7 +31,7 @@ public:
   // getters
   inline std::vector<std::shared_ptr<KeyFile>>& get_includes();
 
-  std::string str() override;
+  void write(BufferedWriter& _writer) override;
 };
 
 /** Get all includes in the include keyword
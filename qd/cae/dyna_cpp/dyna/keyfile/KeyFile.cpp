@@ -1,5 +1,6 @@
 
 #include <cstdint>
+#include <cstdio>
 #include <fstream>
 #include <iostream>
 #include <sstream>
@@ -33,7 +34,9 @@ KeyFile::KeyFile(bool _read_generic_keywords,
   , read_generic_keywords(_read_generic_keywords)
   , parse_mesh(_parse_mesh)
   , has_linebreak_at_eof(true)
+  , keywords_changed(false)
   , max_position(0)
+  , source_size(0)
 {}
 
 /** Constructor for reading a LS-Dyna input file.
@@ -51,7 +54,9 @@ KeyFile::KeyFile(const std::string& _filepath,
   , read_generic_keywords(_read_generic_keywords)
   , parse_mesh(_parse_mesh)
   , has_linebreak_at_eof(true)
+  , keywords_changed(false)
   , max_position(0)
+  , source_size(0)
 {}
 
 /** Parse a keyfile
@@ -65,11 +70,14 @@ KeyFile::KeyFile(const std::string& _filepath,
 bool
 KeyFile::load(bool _load_mesh)
 {
+  std::lock_guard<std::recursive_mutex> lock(keywords_mutex);
 
   // read file
   auto my_filepath = resolve_include_filepath(get_filepath());
   std::vector<char> char_buffer = read_binary_file(my_filepath);
   has_linebreak_at_eof = char_buffer.back() == '\n';
+  source_filepath = my_filepath;
+  source_size = char_buffer.size();
 
 #ifdef QD_DEBUG
   std::cout << "Specified filepath: " << get_filepath() << std::endl;
@@ -87,12 +95,20 @@ KeyFile::load(bool _load_mesh)
   std::vector<std::string> line_buffer_tmp;
   bool found_pgp_section = false;
 
+  // byte offsets of the lines (for copying unmodified keywords)
+  size_t line_offset = 0;
+  std::vector<size_t> line_offsets;
+  std::vector<size_t> line_offsets_tmp;
+
   std::string line;
   auto string_buffer = std::string(char_buffer.begin(), char_buffer.end());
   std::stringstream st(string_buffer);
   // for (; std::getline(st, line); ++iLine) {
   for (; std::getline(st, line); ++iLine) {
 
+    auto next_line_offset =
+      std::min(line_offset + line.size() + 1, string_buffer.size());
+
     if (line.find("-----BEGIN PGP") != std::string::npos) {
       found_pgp_section = true;
 #ifdef QD_DEBUG
@@ -111,6 +127,9 @@ KeyFile::load(bool _load_mesh)
 
         // transfer possible header for following keyword (see function)
         transfer_comment_header(line_buffer, line_buffer_tmp);
+        line_offsets_tmp.assign(line_offsets.end() - line_buffer_tmp.size(),
+                                line_offsets.end());
+        line_offsets.resize(line_buffer.size());
 
         // get type
         auto kw_type = Keyword::determine_keyword_type(last_keyword);
@@ -143,11 +162,17 @@ KeyFile::load(bool _load_mesh)
                                  kw_type,
                                  iLine - line_buffer.size() -
                                    line_buffer_tmp.size() + 1);
-        if (kw)
-          keywords[kw->get_keyword_name()].push_back(kw);
+        if (kw) {
+          kw->set_source_range(line_offsets.front(),
+                               line_offsets_tmp.empty()
+                                 ? line_offset
+                                 : line_offsets_tmp.front());
+          insert_keyword(kw);
+        }
 
         // transfer cropped data
         line_buffer = line_buffer_tmp;
+        line_offsets = line_offsets_tmp;
       }
 
       // we always trim keywords
@@ -176,6 +201,7 @@ KeyFile::load(bool _load_mesh)
 
       // set stream position behind encrypted section
       st.seekg(end_position);
+      next_line_offset = end_position;
 
       // extract encrypted stuff
       line += '\n';
@@ -192,6 +218,8 @@ KeyFile::load(bool _load_mesh)
 
     // we stupidly add every line to the buffer
     line_buffer.push_back(line);
+    line_offsets.push_back(line_offset);
+    line_offset = next_line_offset;
 
   } // for:line
 
@@ -201,8 +229,10 @@ KeyFile::load(bool _load_mesh)
     auto kw = create_keyword(line_buffer,
                              Keyword::determine_keyword_type(last_keyword),
                              iLine - line_buffer.size() + 1);
-    if (kw)
-      keywords[kw->get_keyword_name()].push_back(kw);
+    if (kw) {
+      kw->set_source_range(line_offsets.front(), string_buffer.size());
+      insert_keyword(kw);
+    }
   }
 
   // only load files above *END!
@@ -484,6 +514,7 @@ std::shared_ptr<Keyword>
 KeyFile::add_keyword(const std::vector<std::string>& _lines,
                      int64_t _line_index)
 {
+  std::lock_guard<std::recursive_mutex> lock(keywords_mutex);
 
   // find keyword name
   const auto it =
@@ -500,8 +531,10 @@ KeyFile::add_keyword(const std::vector<std::string>& _lines,
 
   // do the thing
   auto kw = create_keyword(_lines, kw_type, _line_index);
-  if (kw)
-    keywords[kw->get_keyword_name()].push_back(kw);
+  if (kw) {
+    insert_keyword(kw);
+    keywords_changed = true;
+  }
 
   return kw;
 }
@@ -513,6 +546,8 @@ KeyFile::add_keyword(const std::vector<std::string>& _lines,
 void
 KeyFile::remove_keyword(const std::string& _keyword_name)
 {
+  std::lock_guard<std::recursive_mutex> lock(keywords_mutex);
+
   // search
   auto it = keywords.find(_keyword_name);
   if (it == keywords.end())
@@ -527,7 +562,45 @@ KeyFile::remove_keyword(const std::string& _keyword_name)
       throw(std::invalid_argument("Can not delete non-generic keywords yet."));
   }
 
-  keywords.erase(it);
+  erase_keyword_name(it);
+  keywords_changed = true;
+}
+
+/** Insert a keyword into the keyword map and index its name
+ *
+ * @param _kw : keyword to insert
+ */
+void
+KeyFile::insert_keyword(const std::shared_ptr<Keyword>& _kw)
+{
+  std::lock_guard<std::recursive_mutex> lock(keywords_mutex);
+
+  const auto& name = _kw->get_keyword_name();
+  auto it = keywords.find(name);
+  if (it == keywords.end()) {
+    it = keywords.emplace(name, std::vector<std::shared_ptr<Keyword>>())
+           .first;
+    keyword_index.emplace(to_upper_copy(name), it);
+  }
+  it->second.push_back(_kw);
+}
+
+/** Remove a keyword name from the keyword map and the index
+ *
+ * @param _it : entry in the keyword map
+ */
+void
+KeyFile::erase_keyword_name(KeywordMap::iterator _it)
+{
+  std::lock_guard<std::recursive_mutex> lock(keywords_mutex);
+
+  auto range = keyword_index.equal_range(to_upper_copy(_it->first));
+  for (auto iter = range.first; iter != range.second; ++iter)
+    if (iter->second == _it) {
+      keyword_index.erase(iter);
+      break;
+    }
+  keywords.erase(_it);
 }
 
 /** Convert the keyfile to a string
@@ -537,41 +610,278 @@ KeyFile::remove_keyword(const std::string& _keyword_name)
 std::string
 KeyFile::str() const
 {
+  std::lock_guard<std::recursive_mutex> lock(keywords_mutex);
+
+  BufferedWriter writer;
+  write(writer);
+  return writer.str();
+}
+
+/** Get all keywords whose name starts with a prefix
+ *
+ * @param _prefix : prefix of the keyword name, e.g. "*MAT_"
+ * @param _search_includes : whether to search the includes too
+ * @return kwrds : keywords in the order of the file
+ *
+ * The comparison is case-insensitive, like keyword names in LS-Dyna.
+ */
+std::vector<std::shared_ptr<Keyword>>
+KeyFile::get_keywordsByPrefix(const std::string& _prefix,
+                              bool _search_includes)
+{
+  std::vector<std::shared_ptr<Keyword>> kwrds;
+  collect_keywords(_prefix,
+                   [](const std::string&, Keyword::KeywordType) {
+                     return true;
+                   },
+                   _search_includes,
+                   kwrds);
+  return kwrds;
+}
+
+/** Get all keywords whose name matches a wildcard pattern
+ *
+ * @param _pattern : pattern with '*' and '?', e.g. "*SECTION_*"
+ * @param _search_includes : whether to search the includes too
+ * @return kwrds : keywords in the order of the file
+ *
+ * The leading '*' of keyword names is not a wildcard, thus
+ * "*SECTION_*" matches "*SECTION_SHELL" but not "*PART_SECTION_X".
+ * A single "*" matches all keywords. Matching is case-insensitive.
+ */
+std::vector<std::shared_ptr<Keyword>>
+KeyFile::get_keywordsByPattern(const std::string& _pattern,
+                               bool _search_includes)
+{
+
+  // a single star means all keywords
+  if (_pattern == "*")
+    return get_keywordsByPrefix(std::string(), _search_includes);
+
+  // the keyword star and all chars until the first wildcard are a prefix
+  const auto pattern = to_upper_copy(_pattern);
+  const size_t iStart = !pattern.empty() && pattern[0] == '*' ? 1 : 0;
+  const auto iWildcard =
+    std::min(pattern.find_first_of("*?", iStart), pattern.size());
+  const auto prefix = pattern.substr(0, iWildcard);
+  const auto pattern_rest = pattern.substr(iWildcard);
+
+  std::vector<std::shared_ptr<Keyword>> kwrds;
+  collect_keywords(prefix,
+                   [&pattern_rest, &prefix](const std::string& _name,
+                                            Keyword::KeywordType) {
+                     return glob_match(_name.substr(prefix.size()),
+                                       pattern_rest);
+                   },
+                   _search_includes,
+                   kwrds);
+  return kwrds;
+}
+
+/** Get all keywords of a specific type
+ *
+ * @param _type : type of the keyword
+ * @param _search_includes : whether to search the includes too
+ * @return kwrds : keywords in the order of the file
+ */
+std::vector<std::shared_ptr<Keyword>>
+KeyFile::get_keywordsByType(Keyword::KeywordType _type, bool _search_includes)
+{
+  std::vector<std::shared_ptr<Keyword>> kwrds;
+  collect_keywords(std::string(),
+                   [_type](const std::string&, Keyword::KeywordType _kw_type) {
+                     return _kw_type == _type;
+                   },
+                   _search_includes,
+                   kwrds);
+  return kwrds;
+}
 
-  std::vector<std::shared_ptr<Keyword>> kwrds_sorted;
+/** Get all keywords sorted by their position
+ *
+ * @return kwrds_sorted
+ */
+std::vector<Keyword*>
+KeyFile::get_keywords_sorted() const
+{
+  std::vector<Keyword*> kwrds_sorted;
   for (auto& kv : keywords) {
-    for (auto kw : kv.second) {
-      kwrds_sorted.push_back(kw);
+    for (auto& kw : kv.second) {
+      kwrds_sorted.push_back(kw.get());
     }
   }
 
   std::sort(kwrds_sorted.begin(),
             kwrds_sorted.end(),
-            [](const std::shared_ptr<Keyword>& instance1,
-               const std::shared_ptr<Keyword>& instance2) {
+            [](const Keyword* instance1, const Keyword* instance2) {
               return instance1->get_position() < instance2->get_position();
             });
 
-  std::stringstream ss;
-  for (auto kv : kwrds_sorted)
-    ss << kv->str();
-
-  auto str = ss.str();
+  return kwrds_sorted;
+}
 
-  if (!has_linebreak_at_eof && str.back() == '\n')
-    str.pop_back();
+/** Write all keywords in the order of their position
+ *
+ * @param _writer : sink to write to
+ */
+void
+KeyFile::write(BufferedWriter& _writer) const
+{
+  for (auto kw : get_keywords_sorted())
+    kw->write(_writer);
 
-  return std::move(str);
+  if (!has_linebreak_at_eof)
+    _writer.pop_back_if('\n');
 }
 
 /** Save a keyfile again
  *
  * @param _filepath : path to new file
+ *
+ * The keywords are streamed into the file, thus the file is never
+ * held as a whole in memory.
  */
 void
 KeyFile::save_txt(const std::string& _filepath)
 {
-  save_file(_filepath, str());
+  std::lock_guard<std::recursive_mutex> lock(keywords_mutex);
+  write_file(_filepath, false);
+}
+
+/** Save only the modifications of the keyfile and its includes
+ *
+ * @param _filepath : path to new file, the file is overwritten if empty
+ * @param _save_includes : whether to save modified includes too
+ *
+ * Keywords which were not modified are copied from the file they were
+ * read from, only modified ones are written again. Unmodified files
+ * are skipped entirely. Includes are always saved to their own file.
+ */
+void
+KeyFile::save_incremental(const std::string& _filepath, bool _save_includes)
+{
+  std::lock_guard<std::recursive_mutex> lock(keywords_mutex);
+
+  if (_save_includes && load_includes)
+    for (auto& include_kf : get_includes())
+      include_kf->save_incremental(std::string(), true);
+
+  const auto filepath = _filepath.empty() ? source_filepath : _filepath;
+  if (filepath.empty())
+    throw(std::invalid_argument(
+      "KeyFile was not loaded from a file, a filepath is required."));
+
+  if (filepath == source_filepath && !is_modified())
+    return;
+
+  write_file(filepath, true);
+}
+
+/** Check if keywords were modified, added or removed
+ *
+ * @return is_modified
+ *
+ * Includes are not considered.
+ */
+bool
+KeyFile::is_modified() const
+{
+  std::lock_guard<std::recursive_mutex> lock(keywords_mutex);
+
+  if (keywords_changed)
+    return true;
+
+  for (auto& kv : keywords)
+    for (auto& kw : kv.second)
+      if (kw->is_dirty())
+        return true;
+
+  return false;
+}
+
+/** Write the keyfile into a file
+ *
+ * @param _filepath : path to new file
+ * @param _copy_unmodified : whether to copy unmodified keywords from source
+ *
+ * The written file becomes the new source file and all keywords are
+ * considered unmodified afterwards.
+ */
+void
+KeyFile::write_file(const std::string& _filepath, bool _copy_unmodified)
+{
+
+  // source can only be used if it was not changed since
+  std::ifstream source;
+  if (_copy_unmodified && !source_filepath.empty()) {
+    source.open(source_filepath, std::ios::binary | std::ios::ate);
+    if (source.is_open() &&
+        static_cast<size_t>(source.tellg()) != source_size)
+      source.close();
+  }
+
+  // we can not overwrite what we are reading from
+  const bool use_tmp_file = source.is_open() && _filepath == source_filepath;
+  const auto filepath_out = use_tmp_file ? _filepath + ".qd_tmp" : _filepath;
+
+  auto kwrds_sorted = get_keywords_sorted();
+  std::vector<std::pair<size_t, size_t>> new_ranges;
+  new_ranges.reserve(kwrds_sorted.size());
+
+  size_t output_size = 0;
+  {
+    BufferedWriter writer(filepath_out);
+    size_t source_position = source_size;
+
+    for (auto kw : kwrds_sorted) {
+      const auto begin = writer.get_position();
+      const auto range = kw->get_source_range();
+
+      if (source.is_open() && !kw->is_dirty() && range.first < range.second) {
+
+        if (source_position != range.first)
+          source.seekg(static_cast<std::streamoff>(range.first));
+        writer.copy_from(source, range.second - range.first);
+        source_position = range.second;
+
+        // last keyword in file may lack a linebreak
+        writer.pop_back_if('\n');
+        writer.write('\n');
+
+      } else {
+        kw->write(writer);
+      }
+
+      new_ranges.push_back(std::make_pair(begin, writer.get_position()));
+    }
+
+    if (!has_linebreak_at_eof)
+      writer.pop_back_if('\n');
+
+    output_size = writer.get_position();
+    writer.close();
+  }
+  source.close();
+
+  if (use_tmp_file) {
+#ifdef _WIN32
+    std::remove(_filepath.c_str());
+#endif
+    if (std::rename(filepath_out.c_str(), _filepath.c_str()) != 0)
+      throw(std::runtime_error("Could not move " + filepath_out + " to " +
+                               _filepath));
+  }
+
+  // the new file is our source now
+  for (size_t iKeyword = 0; iKeyword < kwrds_sorted.size(); ++iKeyword) {
+    const auto& range = new_ranges[iKeyword];
+    kwrds_sorted[iKeyword]->set_source_range(
+      range.first, std::min(range.second, output_size));
+    kwrds_sorted[iKeyword]->set_dirty(false);
+  }
+  source_filepath = _filepath;
+  source_size = output_size;
+  keywords_changed = false;
   set_filepath(_filepath);
 }
 
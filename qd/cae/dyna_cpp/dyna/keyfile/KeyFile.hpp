@@ -12,7 +12,9 @@
 #include <dyna_cpp/dyna/keyfile/PartKeyword.hpp>
 // #include <dyna_cpp/parallel/WorkQueue.hpp>
 
+#include <iterator>
 #include <map>
+#include <mutex>
 #include <queue>
 #include <stdexcept>
 #include <string>
@@ -43,10 +45,22 @@ private:
   bool read_generic_keywords;
   bool parse_mesh;
   bool has_linebreak_at_eof;
+  bool keywords_changed; // keywords added or removed
   int64_t max_position;
 
+  // file from which unmodified keywords can be copied
+  std::string source_filepath;
+  size_t source_size;
+
   std::vector<std::string> include_dirs;
-  std::map<std::string, std::vector<std::shared_ptr<Keyword>>> keywords;
+  typedef std::map<std::string, std::vector<std::shared_ptr<Keyword>>>
+    KeywordMap;
+  KeywordMap keywords;
+  // upper-case name -> entry in keywords (names are case-insensitive)
+  std::multimap<std::string, KeywordMap::iterator> keyword_index;
+
+  // loading, saving and changing keywords may run in parallel (no GIL)
+  mutable std::recursive_mutex keywords_mutex;
 
   // internal use only
   std::vector<std::shared_ptr<NodeKeyword>> node_keywords;
@@ -73,6 +87,16 @@ private:
   void load_parts();
   void load_elements();
 
+  void insert_keyword(const std::shared_ptr<Keyword>& _kw);
+  void erase_keyword_name(KeywordMap::iterator _it);
+  std::vector<Keyword*> get_keywords_sorted() const;
+  template<typename F>
+  void collect_keywords(const std::string& _prefix,
+                        F _match,
+                        bool _search_includes,
+                        std::vector<std::shared_ptr<Keyword>>& _result);
+  void write_file(const std::string& _filepath, bool _copy_unmodified);
+
 public:
   KeyFile(bool _read_generic_keywords = false,
           bool _parse_mesh = false,
@@ -92,6 +116,15 @@ public:
   inline std::vector<std::string> keys();
   inline std::vector<std::shared_ptr<Keyword>> get_keywordsByName(
     const std::string& _keyword_name);
+  std::vector<std::shared_ptr<Keyword>> get_keywordsByPrefix(
+    const std::string& _prefix,
+    bool _search_includes = true);
+  std::vector<std::shared_ptr<Keyword>> get_keywordsByPattern(
+    const std::string& _pattern,
+    bool _search_includes = true);
+  std::vector<std::shared_ptr<Keyword>> get_keywordsByType(
+    Keyword::KeywordType _type,
+    bool _search_includes = true);
   std::shared_ptr<Keyword> add_keyword(const std::vector<std::string>& _lines,
                                        int64_t _line_index = 0);
   void remove_keyword(const std::string& _keyword_name);
@@ -101,7 +134,11 @@ public:
 
   // io
   std::string str() const;
+  void write(BufferedWriter& _writer) const;
   void save_txt(const std::string& _filepath);
+  void save_incremental(const std::string& _filepath = std::string(),
+                        bool _save_includes = true);
+  bool is_modified() const;
   std::string resolve_include_filepath(const std::string& _filepath);
   std::vector<std::shared_ptr<KeyFile>> get_includes();
   const std::vector<std::string>& get_include_dirs(bool _update = false);
@@ -124,6 +161,7 @@ public:
 std::vector<std::shared_ptr<Keyword>>
 KeyFile::get_keywordsByName(const std::string& _keyword_name)
 {
+  std::lock_guard<std::recursive_mutex> lock(keywords_mutex);
 
   // search and return
   auto it = keywords.find(_keyword_name);
@@ -135,6 +173,74 @@ KeyFile::get_keywordsByName(const std::string& _keyword_name)
   return std::vector<std::shared_ptr<Keyword>>();
 }
 
+/** Collect keywords of this file and its includes in file order
+ *
+ * @param _prefix : only keyword names with this prefix are checked
+ * @param _match : filter called with (name, type) once per keyword name
+ * @param _search_includes : whether to search the includes too
+ * @param _result : matching keywords are appended here
+ *
+ * The keywords of an include are placed at the position of
+ * the include keyword which loaded it. Keyword names are compared
+ * case-insensitively, thus the prefix and the name given to the
+ * filter are upper-case.
+ */
+template<typename F>
+void
+KeyFile::collect_keywords(const std::string& _prefix,
+                          F _match,
+                          bool _search_includes,
+                          std::vector<std::shared_ptr<Keyword>>& _result)
+{
+  std::lock_guard<std::recursive_mutex> lock(keywords_mutex);
+
+  // all names with the prefix are one sorted range of the index
+  const auto prefix_upper = to_upper_copy(_prefix);
+  std::vector<std::shared_ptr<Keyword>> own_keywords;
+  for (auto iter = keyword_index.lower_bound(prefix_upper);
+       iter != keyword_index.end() &&
+       iter->first.compare(0, prefix_upper.size(), prefix_upper) == 0;
+       ++iter) {
+    const auto& kwrds = iter->second->second;
+    if (!kwrds.empty() &&
+        _match(iter->first, kwrds.front()->get_keyword_type()))
+      own_keywords.insert(own_keywords.end(), kwrds.begin(), kwrds.end());
+  }
+
+  auto by_position = [](const std::shared_ptr<Keyword>& instance1,
+                        const std::shared_ptr<Keyword>& instance2) {
+    return instance1->get_position() < instance2->get_position();
+  };
+  std::sort(own_keywords.begin(), own_keywords.end(), by_position);
+
+  if (!_search_includes || !load_includes || include_keywords.empty()) {
+    if (_result.empty())
+      _result = std::move(own_keywords);
+    else
+      _result.insert(_result.end(),
+                     std::make_move_iterator(own_keywords.begin()),
+                     std::make_move_iterator(own_keywords.end()));
+    return;
+  }
+
+  // insert the includes behind their include keyword
+  auto include_kwrds = include_keywords;
+  std::sort(include_kwrds.begin(), include_kwrds.end(), by_position);
+
+  auto it = own_keywords.begin();
+  for (auto& include_kw : include_kwrds) {
+    while (it != own_keywords.end() &&
+           (*it)->get_position() <= include_kw->get_position())
+      _result.push_back(std::move(*it++));
+
+    for (auto& include_kf : include_kw->get_includes())
+      include_kf->collect_keywords(_prefix, _match, true, _result);
+  }
+  _result.insert(_result.end(),
+                 std::make_move_iterator(it),
+                 std::make_move_iterator(own_keywords.end()));
+}
+
 /** Remove a keyword
  *
  * @param _keyword_name : name
@@ -146,6 +252,8 @@ template<typename T>
 void
 KeyFile::remove_keyword(const std::string& _keyword_name, T _index)
 {
+  std::lock_guard<std::recursive_mutex> lock(keywords_mutex);
+
   // search
   auto it = keywords.find(_keyword_name);
   if (it == keywords.end())
@@ -155,17 +263,18 @@ KeyFile::remove_keyword(const std::string& _keyword_name, T _index)
 
   // do the thing
   _index = index_treatment(_index, kwrds.size());
-
-  if (static_cast<size_t>(_index) < kwrds.size() &&
-      kwrds[_index]->get_keyword_type() == Keyword::KeywordType::GENERIC)
-    kwrds.erase(kwrds.begin() + _index);
-
-  // remove keyword name in map if no data is here
-  if (kwrds.size() == 0)
-    keywords.erase(it);
+  if (static_cast<size_t>(_index) >= kwrds.size())
+    return;
 
   if (kwrds[_index]->get_keyword_type() != Keyword::KeywordType::GENERIC)
     throw(std::invalid_argument("Can not delete non-generic keywords yet."));
+
+  kwrds.erase(kwrds.begin() + _index);
+  keywords_changed = true;
+
+  // remove keyword name in map if no data is here
+  if (kwrds.empty())
+    erase_keyword_name(it);
 }
 
 /** Get a list of keywords in the file
@@ -175,6 +284,8 @@ KeyFile::remove_keyword(const std::string& _keyword_name, T _index)
 std::vector<std::string>
 KeyFile::keys()
 {
+  std::lock_guard<std::recursive_mutex> lock(keywords_mutex);
+
   std::vector<std::string> list;
   for (const auto& kv : keywords)
     list.push_back(kv.first);
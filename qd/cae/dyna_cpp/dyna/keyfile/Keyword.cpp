@@ -27,6 +27,9 @@ Keyword::Keyword(const std::vector<std::string>& _lines,
   : kw_type(KeywordType::GENERIC)
   , position(_position)
   , lines(_lines)
+  , dirty(false)
+  , source_begin(0)
+  , source_end(0)
 {
 
   // field size
@@ -74,6 +77,9 @@ Keyword::Keyword(const std::vector<std::string>& _lines,
   : kw_type(KeywordType::GENERIC)
   , position(_position)
   , lines(_lines)
+  , dirty(false)
+  , source_begin(0)
+  , source_end(0)
 {
   // field size
   if (_field_size == 0) {
@@ -87,98 +93,101 @@ Keyword::Keyword(const std::vector<std::string>& _lines,
   }
 }
 
+/** Check if a keyword name continues with one of the options
+ *
+ * @param _str : keyword name
+ * @param _offset : char index where the option starts
+ * @param _options : options in lower-case, terminated by nullptr
+ * @return is_match
+ */
+static bool
+has_option(const std::string& _str,
+           size_t _offset,
+           const char* const* _options)
+{
+  for (; *_options != nullptr; ++_options)
+    if (starts_with_icase(_str, _offset, *_options))
+      return true;
+  return false;
+}
+
 /** Get the type of the keyword
  *
  * @param str : keyword name as string
  * @return type
  *
- * Generic, Node, etc.
+ * Generic, Node, etc. The name is dispatched on its first letters
+ * and compared case-insensitively in place, thus nothing is allocated.
  */
 Keyword::KeywordType
 Keyword::determine_keyword_type(const std::string& _str)
 {
-  auto str_lower = to_lower_copy(_str);
-
-  // *NODE
-  if (str_lower.compare(0, 5, "*node") == 0) {
-    if (str_lower.size() <= 5 || // just *node
-        str_lower.compare(5, 13, "_scalar_value") == 0 ||
-        str_lower.compare(5, 14, "_rigid_surface") == 0 ||
-        str_lower.compare(5, 6, "_merge") == 0)
-      return KeywordType::NODE;
-
-  }
-  // *ELEMENT
-  else if (str_lower.compare(0, 8, "*element") == 0 && str_lower.size() > 8) {
-
-    // *ELEMENT_BEAM
-    if (str_lower.compare(8, 5, "_beam") == 0)
-      return KeywordType::ELEMENT;
-
-    // *ELEMENT_SOLID
-    if (str_lower.compare(8, 6, "_solid") == 0)
-      return KeywordType::ELEMENT;
+  static const char* const node_options[] = {
+    "_scalar_value", "_rigid_surface", "_merge", nullptr
+  };
+  static const char* const shell_options[] = {
+    "_thickness", "_beta", "_mcid", "_offset", "_dof", nullptr
+  };
+  static const char* const tshell_options[] = { "_beta", nullptr };
+  static const char* const unsupported_part_options[] = {
+    "_adaptive", "_anneal", "_composite", "_duplicate",
+    "_modes",    "_move",   "_sensor",    "_stacked",
+    nullptr
+  };
+
+  if (_str.size() < 5 || _str[0] != '*')
+    return KeywordType::GENERIC;
+
+  switch (std::tolower(static_cast<unsigned char>(_str[1]))) {
+
+    // *NODE
+    case ('n'):
+      if (starts_with_icase(_str, 1, "node") &&
+          (_str.size() == 5 || has_option(_str, 5, node_options)))
+        return KeywordType::NODE;
+      break;
 
-    // *ELEMENT_SHELL
-    if (str_lower.compare(8, 6, "_shell") == 0) {
+    // *ELEMENT
+    case ('e'):
+      if (_str.size() <= 8 || !starts_with_icase(_str, 1, "element_"))
+        break;
 
-      if (str_lower.size() <= 14)
+      if (starts_with_icase(_str, 8, "_beam") ||
+          starts_with_icase(_str, 8, "_solid"))
         return KeywordType::ELEMENT;
 
-      if (str_lower.compare(14, 10, "_thickness") == 0 ||
-          str_lower.compare(14, 5, "_beta") == 0 ||
-          str_lower.compare(14, 5, "_mcid") == 0 ||
-          str_lower.compare(14, 7, "_offset") == 0 ||
-          str_lower.compare(14, 4, "_dof") == 0)
+      if (starts_with_icase(_str, 8, "_shell") &&
+          (_str.size() == 14 || has_option(_str, 14, shell_options)))
         return KeywordType::ELEMENT;
-    }
-
-    // *ELEMENT_TSHELL
-    if (str_lower.compare(8, 7, "_tshell") == 0) {
 
-      if (str_lower.size() <= 15)
+      if (starts_with_icase(_str, 8, "_tshell") &&
+          (_str.size() == 15 || has_option(_str, 15, tshell_options)))
         return KeywordType::ELEMENT;
+      break;
 
-      if (str_lower.compare(15, 5, "_beta") == 0)
-        return KeywordType::ELEMENT;
-    }
-  }
-  // *PART
-  else if (str_lower.compare(0, 5, "*part") == 0) {
-    if (str_lower.size() > 5) {
-
-      // unsupported part options
-      if (str_lower.compare(5, 9, "_adaptive") == 0 ||
-          str_lower.compare(5, 7, "_anneal") == 0 ||
-          str_lower.compare(5, 10, "_composite") == 0 ||
-          str_lower.compare(5, 10, "_duplicate") == 0 ||
-          str_lower.compare(5, 6, "_modes") == 0 ||
-          str_lower.compare(6, 5, "_move") == 0 ||
-          str_lower.compare(5, 7, "_sensor") == 0 ||
-          str_lower.compare(5, 8, "_stacked") == 0)
-        return KeywordType::GENERIC;
-      else
+    // *PART
+    case ('p'):
+      if (starts_with_icase(_str, 1, "part") &&
+          !has_option(_str, 5, unsupported_part_options))
         return KeywordType::PART;
-    } else {
-      return KeywordType::PART;
-    }
-  }
-  // *INCLUDE
-  else if (str_lower.compare(0, 8, "*include") == 0) {
+      break;
 
-    // TODO
-    if (str_lower.size() == 8 || str_lower.compare(8, 4, "_binary") == 0)
-      return KeywordType::INCLUDE;
+    // *INCLUDE
+    // (*INCLUDE_BINARY is not a keyfile and stays generic)
+    case ('i'):
+      if (!starts_with_icase(_str, 1, "include"))
+        break;
 
-    // PATH
-    if (str_lower.compare(8, 5, "_path") == 0) {
+      if (_str.size() == 8)
+        return KeywordType::INCLUDE;
 
-      if (str_lower.size() == 13 || str_lower.compare(13, 9, "_relative") == 0)
+      if (starts_with_icase(_str, 8, "_path") &&
+          (_str.size() == 13 || starts_with_icase(_str, 13, "_relative")))
         return KeywordType::INCLUDE_PATH;
-    }
-  }
-  // *INCLUDE_PATH
-  else if (str_lower.compare(0, 13, "*include_path") == 0) {
+      break;
+
+    default:
+      break;
   }
 
   return KeywordType::GENERIC;
@@ -200,6 +209,8 @@ Keyword::change_field_size_byLine(size_t _iLine,
   if (old_field_size == new_field_size)
     return;
 
+  dirty = true;
+  field_indexes_cache.clear();
   auto& line = lines[_iLine];
 
   // COPY: FIELDS
@@ -295,6 +306,8 @@ void
 Keyword::append_line(const std::string& _new_line)
 {
   lines.push_back(_new_line);
+  dirty = true;
+  field_indexes_cache.clear();
 }
 
 /** Set a new line buffer
@@ -309,6 +322,8 @@ Keyword::set_lines(const std::vector<std::string>& _new_lines)
   for (const auto& line : _new_lines)
     if (is_keyword(line)) {
       lines = _new_lines;
+      dirty = true;
+      field_indexes_cache.clear();
       return;
     }
 
@@ -320,12 +335,19 @@ Keyword::set_lines(const std::vector<std::string>& _new_lines)
  *
  * @param _keyword_name name of the keyword to search from comments
  * @returns indexes first index is is the line, second is the field
+ *
+ * Found indexes are cached, the cache is cleared by every
+ * function changing comments, the line layout or the field size.
  */
 std::pair<size_t, size_t>
 Keyword::get_field_indexes(const std::string& _keyword_name) const
 {
 
-  for (size_t iLine = 0; iLine < lines.size() - 1; ++iLine) {
+  auto it = field_indexes_cache.find(_keyword_name);
+  if (it != field_indexes_cache.end())
+    return it->second;
+
+  for (size_t iLine = 0; iLine + 1 < lines.size(); ++iLine) {
     const auto& line = lines[iLine];
     const auto& next_line = lines[iLine + 1];
 
@@ -337,9 +359,12 @@ Keyword::get_field_indexes(const std::string& _keyword_name) const
 
     // field name in comment line
     auto start = get_word_position(line, _keyword_name);
-    if (start >= 0)
-      return std::make_pair(iLine + 1,
-                            iChar_to_iField(static_cast<size_t>(start)));
+    if (start >= 0) {
+      auto indexes =
+        std::make_pair(iLine + 1, iChar_to_iField(static_cast<size_t>(start)));
+      field_indexes_cache.insert(std::make_pair(_keyword_name, indexes));
+      return indexes;
+    }
   }
 
   throw(std::invalid_argument("Can not find field: " + _keyword_name +
@@ -382,6 +407,7 @@ Keyword::set_card_value_byLine(std::string& _line,
 
   // check for user-specific field size
   _field_size = _field_size != 0 ? _field_size : field_size;
+  dirty = true;
 
   // clear field or allocate
   clear_field(_line, _iField, _field_size);
@@ -404,7 +430,12 @@ Keyword::set_card_value_byLine(std::string& _line,
   }
 
   // assign value to field
+  const bool was_comment = is_comment(_line);
   _line.replace(start, len, _value, 0, len);
+
+  // field names are searched in comments
+  if (was_comment || is_comment(_line))
+    field_indexes_cache.clear();
 }
 
 /** Set the name of a field in the comments
@@ -428,6 +459,8 @@ Keyword::set_card_name_byLine(std::string& _line,
 
   // check for user-specific field size
   _field_size = _field_size != 0 ? _field_size : field_size;
+  dirty = true;
+  field_indexes_cache.clear();
 
   // First field always has an delimiter offset due to comment symbol
   const size_t delimiter_size = Keyword::name_delimiter_used || _iField == 0;
@@ -500,10 +533,23 @@ Keyword::clear_field(std::string& _line, size_t _iField, size_t _field_size)
 std::string
 Keyword::str()
 {
-  std::stringstream ss;
+  BufferedWriter writer;
+  write(writer);
+  return writer.str();
+}
+
+/** Write the keyword into a writer
+ *
+ * @param _writer : sink to write to
+ *
+ * Subclasses write their parsed data here, so that saving a
+ * file does not require to assemble the whole file as string.
+ */
+void
+Keyword::write(BufferedWriter& _writer)
+{
   for (const auto& entry : lines)
-    ss << entry << '\n';
-  return ss.str();
+    _writer.write_line(entry);
 }
 
 /** Print the card
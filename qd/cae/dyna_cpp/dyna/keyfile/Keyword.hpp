@@ -8,10 +8,12 @@
 #include <memory>
 #include <sstream>
 #include <string>
+#include <unordered_map>
 #include <type_traits>
 #include <utility>
 #include <vector>
 
+#include <dyna_cpp/utility/BufferedWriter.hpp>
 #include <dyna_cpp/utility/MathUtility.hpp>
 #include <dyna_cpp/utility/TextUtility.hpp>
 
@@ -50,6 +52,13 @@ protected:
   size_t field_size;              // size of the fields (8 or 20)
   int64_t position;               // line index in file (keeps order)
   std::vector<std::string> lines; // line buffer
+  bool dirty;                     // modified since loading/saving
+  size_t source_begin;            // byte range in the source file
+  size_t source_end;              // (empty if not from a file)
+
+  // field name -> (line, field), filled by get_field_indexes
+  mutable std::unordered_map<std::string, std::pair<size_t, size_t>>
+    field_indexes_cache;
 
   // as always, dirty stuff is better kept private ...
   inline bool is_comment(const std::string& _line) const;
@@ -114,7 +123,8 @@ public:
   /*
   bool contains_field(const std::string& _name) const;
   */
-  virtual std::string str();
+  std::string str();
+  virtual void write(BufferedWriter& _writer);
   void print();
 
   // card stuff
@@ -182,6 +192,12 @@ public:
 
   inline void set_position(int64_t _iLine);
 
+  // modification tracking
+  virtual bool is_dirty() const;
+  virtual void set_dirty(bool _dirty = true);
+  inline std::pair<size_t, size_t> get_source_range() const;
+  inline void set_source_range(size_t _begin, size_t _end);
+
   // useful but mostly internal stuff
   inline size_t get_line_index_of_next_card(size_t _iLineOffset = 0);
 };
@@ -204,6 +220,8 @@ Keyword::set_field_size(T _new_field_size)
 {
   check_non_negative(_new_field_size);
   field_size = static_cast<size_t>(_new_field_size);
+  dirty = true;
+  field_indexes_cache.clear();
 }
 
 /** Get the type of the keyword
@@ -334,6 +352,54 @@ Keyword::set_position(int64_t _iLine)
   position = _iLine;
 }
 
+/** Check whether the keyword was modified since loading or saving
+ *
+ * @return is_dirty
+ *
+ * Changing the lines directly through the reference of get_lines does
+ * not mark a keyword as dirty, use set_dirty in that case.
+ */
+inline bool
+Keyword::is_dirty() const
+{
+  return dirty;
+}
+
+/** Mark the keyword as modified (or unmodified)
+ *
+ * @param _dirty
+ *
+ * Dirty keywords are regenerated in an incremental save,
+ * clean ones are copied from the source file.
+ */
+inline void
+Keyword::set_dirty(bool _dirty)
+{
+  dirty = _dirty;
+}
+
+/** Get the byte range of the keyword in the file it was read from
+ *
+ * @return range : begin and end of the range, empty if none
+ */
+std::pair<size_t, size_t>
+Keyword::get_source_range() const
+{
+  return std::make_pair(source_begin, source_end);
+}
+
+/** Set the byte range of the keyword in the file it was read from
+ *
+ * @param _begin : offset of the first char
+ * @param _end : offset behind the last char
+ */
+void
+Keyword::set_source_range(size_t _begin, size_t _end)
+{
+  source_begin = _begin;
+  source_end = _end;
+}
+
 /** Checks if a string is a comment
  *
  * @param _line line to check
@@ -394,6 +460,7 @@ Keyword::iCard_to_iLine(T _iCard, bool _auto_extend)
   // simply append more empty lines
   if (_auto_extend) {
     lines.resize(lines.size() + iCard_u - nCards);
+    field_indexes_cache.clear();
     return lines.size() - 1;
   }
 
@@ -482,10 +549,13 @@ Keyword::get_lines() const
 /** Get the line buffer of the keyword
  *
  * @return lines line buffer
+ *
+ * Since the lines may be changed, cached field indexes are dropped.
  */
 std::vector<std::string>&
 Keyword::get_lines()
 {
+  field_indexes_cache.clear();
   return lines;
 }
 
@@ -506,6 +576,8 @@ Keyword::switch_field_size(const std::vector<T> _skip_cards)
   // new sizes
   auto old_field_size = field_size;
   field_size = old_field_size <= 10 ? old_field_size * 2 : old_field_size / 2;
+  dirty = true;
+  field_indexes_cache.clear();
 
   T iCard = 0;
   for (size_t iLine = 0; iLine < lines.size(); ++iLine) {
@@ -707,6 +779,8 @@ Keyword::set_line(T iLine, const std::string& _line)
     lines.resize(iLine + 1);
 
   lines[iLine] = _line;
+  dirty = true;
+  field_indexes_cache.clear();
 }
 
 /** Insert a line into the buffer
@@ -726,6 +800,8 @@ Keyword::insert_line(T iLine, const std::string& _line)
   } else {
     lines.insert(lines.begin() + iLine, _line);
   }
+  dirty = true;
+  field_indexes_cache.clear();
 }
 
 /** Remove a line in the buffer
@@ -742,6 +818,8 @@ Keyword::remove_line(T iLine)
     return;
 
   lines.erase(lines.begin() + iLine);
+  dirty = true;
+  field_indexes_cache.clear();
 }
 
 /** Reformat the whole card according to the formatting rules
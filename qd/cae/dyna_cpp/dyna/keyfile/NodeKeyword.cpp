@@ -1,6 +1,4 @@
 
-#include <iomanip>
-
 #include <dyna_cpp/dyna/keyfile/KeyFile.hpp>
 #include <dyna_cpp/dyna/keyfile/NodeKeyword.hpp>
 
@@ -17,6 +15,7 @@ NodeKeyword::NodeKeyword(DB_Nodes* _db_nodes,
                          int64_t _iLine)
   : Keyword(_lines, _iLine)
   , db_nodes(_db_nodes)
+  , clean_revision(0)
 {
   field_size = 8;
   kw_type = KeywordType::NODE;
@@ -108,40 +107,76 @@ NodeKeyword::load()
 
   // remove all lines below keyword (except for failed ones)
   lines.resize(header_size);
+  field_indexes_cache.clear();
 }
 
-/** Get the keyword as a string
+/** Check whether the keyword or any of its nodes was modified
+ *
+ * @return is_dirty
  *
- * @return keyword as string
+ * Nodes moved through the database (e.g. Node::set_coords) are
+ * detected by their revision stamp.
  */
-std::string
-NodeKeyword::str()
+bool
+NodeKeyword::is_dirty() const
 {
-  // build header
-  std::stringstream ss;
+  if (dirty)
+    return true;
+
+  if (db_nodes == nullptr || db_nodes->get_revision() <= clean_revision)
+    return false;
+
+  for (auto node_id : node_ids_in_card)
+    if (db_nodes->get_nodeByID(node_id)->get_revision() > clean_revision)
+      return true;
+
+  return false;
+}
+
+/** Mark the keyword as modified (or unmodified)
+ *
+ * @param _dirty
+ *
+ * Marking the keyword as clean also accepts all node modifications
+ * done so far.
+ */
+void
+NodeKeyword::set_dirty(bool _dirty)
+{
+  dirty = _dirty;
+  if (!_dirty && db_nodes != nullptr)
+    clean_revision = db_nodes->get_revision();
+}
+
+/** Write the keyword into a writer
+ *
+ * @param _writer : sink to write to
+ */
+void
+NodeKeyword::write(BufferedWriter& _writer)
+{
+  // write header
   for (const auto& entry : lines)
-    ss << entry << '\n';
+    _writer.write_line(entry);
 
   // insert nodes
   const size_t id_width = field_size;
   const size_t float_width = 2 * field_size;
 
-  ss.precision(7); // float
   for (size_t iNode = 0; iNode < this->get_nNodes(); ++iNode) {
 
     auto node = this->get_nodeByIndex(iNode);
-    auto coords = node->get_coords()[0];
-    ss << std::setw(id_width) << node->get_nodeID() << std::setw(float_width)
-       << coords[0] << std::setw(float_width) << coords[1]
-       << std::setw(float_width) << coords[2] << unparsed_node_data[iNode]
-       << '\n';
+    const auto& coords = node->get_position();
+    _writer.write_int(node->get_nodeID(), id_width);
+    _writer.write_float(coords[0], float_width);
+    _writer.write_float(coords[1], float_width);
+    _writer.write_float(coords[2], float_width);
+    _writer.write_line(unparsed_node_data[iNode]);
   }
 
   // trailing lines
   for (const auto& line : trailing_lines)
-    ss << line << '\n';
-
-  return ss.str();
+    _writer.write_line(line);
 }
 
 } // NAMESPACE:qd
\ No newline at end of file
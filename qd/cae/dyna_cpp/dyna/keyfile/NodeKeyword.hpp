@@ -22,6 +22,7 @@ private:
   std::vector<int32_t> node_ids_in_card;
   std::vector<std::string> unparsed_node_data;
   std::vector<std::string> trailing_lines;
+  uint64_t clean_revision; // db revision at the last save
 
   std::mutex _instance_mutex;
 
@@ -44,7 +45,9 @@ public:
   inline std::vector<std::shared_ptr<Node>> get_nodes();
   inline const std::vector<int32_t>& get_node_ids();
   inline size_t get_nNodes() const;
-  std::string str() override;
+  void write(BufferedWriter& _writer) override;
+  bool is_dirty() const override;
+  void set_dirty(bool _dirty = true) override;
 
   inline std::vector<std::string> get_failed_lines();
 };
@@ -66,6 +69,7 @@ NodeKeyword::add_node(T _id, float _x, float _y, float _z)
   auto node = db_nodes->add_node(static_cast<int32_t>(_id), _x, _y, _z);
   node_ids_in_card.push_back(node->get_nodeID());
   unparsed_node_data.push_back("");
+  dirty = true;
   return node;
 }
 
@@ -92,6 +96,7 @@ NodeKeyword::add_node(T _id,
   auto node = db_nodes->add_node(static_cast<int32_t>(_id), _x, _y, _z);
   node_ids_in_card.push_back(node->get_nodeID());
   unparsed_node_data.push_back(_additional_card_data);
+  dirty = true;
   return node;
 }
 
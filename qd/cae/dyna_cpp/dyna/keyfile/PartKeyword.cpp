@@ -1,6 +1,4 @@
 
-#include <iomanip>
-
 #include <dyna_cpp/dyna/keyfile/PartKeyword.hpp>
 
 namespace qd {
@@ -16,6 +14,7 @@ PartKeyword::PartKeyword(DB_Parts* _db_parts,
                          int64_t _iLine)
   : Keyword(_lines, _iLine)
   , db_parts(_db_parts)
+  , clean_revision(0)
 {
 
   field_size = has_long_fields() ? 20 : 10;
@@ -156,33 +155,61 @@ PartKeyword::load()
 
   // remove all lines below keyword
   lines.resize(iLine_trailing);
+  field_indexes_cache.clear();
 }
 
-/** Get the keyword as a string
+/** Check whether the keyword or any of its parts was modified
+ *
+ * @return is_dirty
  *
- * @return str : keyword as string (again)
+ * Parts renamed through the database (e.g. Part::set_name) are
+ * detected by their revision stamp.
  */
-std::string
-PartKeyword::str()
+bool
+PartKeyword::is_dirty() const
 {
-  std::stringstream ss;
+  if (dirty)
+    return true;
+
+  if (db_parts == nullptr || db_parts->get_revision() <= clean_revision)
+    return false;
+
+  for (auto part_id : part_ids)
+    if (db_parts->get_partByID(part_id)->get_revision() > clean_revision)
+      return true;
+
+  return false;
+}
+
+/** Mark the keyword as modified (or unmodified)
+ *
+ * @param _dirty
+ *
+ * Marking the keyword as clean also accepts all part modifications
+ * done so far.
+ */
+void
+PartKeyword::set_dirty(bool _dirty)
+{
+  dirty = _dirty;
+  if (!_dirty && db_parts != nullptr)
+    clean_revision = db_parts->get_revision();
+}
 
+/** Write the keyword into a writer
+ *
+ * @param _writer : sink to write to
+ */
+void
+PartKeyword::write(BufferedWriter& _writer)
+{
   // write headers
   auto iLine = get_line_index_of_next_card(0);
   for (size_t ii = 0; ii < iLine; ++ii)
-    ss << lines[ii] << '\n';
-
-  // write parts
-  switch (Keyword::field_alignment) {
-    case (Keyword::Align::LEFT):
-      ss.setf(std::ios::left);
-      break;
-    case (Keyword::Align::RIGHT):
-      ss.setf(std::ios::right);
-      break;
-    default:
-      ss.setf(std::ios::internal);
-  }
+    _writer.write_line(lines[ii]);
+
+  // write parts (middle alignment pads left like std::ios::internal)
+  const bool left_aligned = Keyword::field_alignment == Keyword::Align::LEFT;
 
   const auto kw_name = get_keyword_name();
   bool is_part_inertia = false;
@@ -200,7 +227,6 @@ PartKeyword::str()
   if (kw_name.find("attachment_nodes", 6) != std::string::npos)
     ++nAdditionalLines;
 
-  ss.precision(7);
   for (size_t iPart = 0; iPart < part_ids.size(); ++iPart) {
     const auto part = db_parts->get_partByID(part_ids[iPart]);
 
@@ -211,24 +237,21 @@ PartKeyword::str()
     //   << "unparsed_data '" << unparsed_data[iPart] << "'" << std::endl;
 
     // CARD 0: write part name
-    ss << std::setw(7 * field_size) << part->get_name() << '\n';
-    
+    _writer.write_padded(part->get_name(), 7 * field_size, left_aligned);
+    _writer.write('\n');
+
     // write comment block inbetween
     const auto& comment_block = comments_between_card0_and_card1[iPart];
-    if(!comment_block.empty())
-      ss << comment_block << "\n"; 
+    if (!comment_block.empty())
+      _writer.write_line(comment_block);
 
     const size_t iLineNextKeyword = get_line_index_of_next_card(iLine);
     
     // CARD 1: write part id
-    ss << std::setw(field_size) << part->get_partID() ;
-    
+    _writer.write_int(part->get_partID(), field_size, left_aligned);
+
     // write remaining line data
-    const auto& remaining_line_data = unparsed_data[iPart];
-    if(!remaining_line_data.empty()) {
-      ss << remaining_line_data;
-    }
-    ss << "\n";
+    _writer.write_line(unparsed_data[iPart]);
 
     iLine = iLineNextKeyword + 1;
     size_t iCardCount = 0;
@@ -249,7 +272,7 @@ PartKeyword::str()
 
           ++iCardCount;
         }
-        ss << lines[iLine] << '\n';
+        _writer.write_line(lines[iLine]);
         ++iLine;
       }
     } catch (const std::exception& err) {
@@ -261,9 +284,7 @@ PartKeyword::str()
 
   // write trailing lines
   for (const auto& entry : trailing_lines)
-    ss << entry << '\n';
-
-  return ss.str();
+    _writer.write_line(entry);
 }
 
 } // namespace:qd
\ No newline at end of file
@@ -21,6 +21,7 @@ private:
   std::vector<std::string> comments_between_card0_and_card1;
   std::vector<std::string> unparsed_data;
   std::vector<std::string> trailing_lines;
+  uint64_t clean_revision; // db revision at the last save
 
 public:
   explicit PartKeyword(DB_Parts* _db_parts,
@@ -40,7 +41,9 @@ public:
   inline std::shared_ptr<Part> get_partByIndex(T _part_index);
   inline std::vector<std::shared_ptr<Part>> get_parts();
   inline size_t get_nParts() const;
-  std::string str() override;
+  void write(BufferedWriter& _writer) override;
+  bool is_dirty() const override;
+  void set_dirty(bool _dirty = true) override;
 };
 
 /** Add a part to the keyword
@@ -60,6 +63,7 @@ PartKeyword::add_part(T _part_id, const std::string& _name)
   part_ids.push_back(part_id_i32);
   comments_between_card0_and_card1.push_back("");
   unparsed_data.push_back("");
+  dirty = true;
   return part;
 }
 
@@ -94,6 +98,7 @@ PartKeyword::add_part(T _part_id,
     unparsed_data.push_back(rest);
   }
 
+  dirty = true;
   return part;
 }
 
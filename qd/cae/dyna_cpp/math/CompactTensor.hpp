@@ -0,0 +1,632 @@
+#ifndef COMPACTTENSOR_HPP
+#define COMPACTTENSOR_HPP
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <limits>
+#include <memory>
+#include <numeric>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+// F16C is used if the compiler targets it, otherwise gcc and clang on x86
+// compile it for a check of the CPU at runtime
+#if defined(__F16C__)
+#define QD_F16C_STATIC
+#elif (defined(__GNUC__) || defined(__clang__)) &&                            \
+  (defined(__x86_64__) || defined(__i386__))
+#define QD_F16C_DISPATCH
+#include <cpuid.h>
+#endif
+
+#if defined(QD_F16C_STATIC) || defined(QD_F16C_DISPATCH)
+#include <immintrin.h>
+#endif
+
+#include <dyna_cpp/math/Tensor.hpp>
+
+namespace qd {
+
+/** Element types a CompactTensor may store its data in
+ *
+ * FLOAT16 are IEEE half floats, INT16 and INT8 are fixed-point values with
+ * an own scale per slice and field.
+ */
+enum class Precision : int32_t
+{
+  FLOAT32,
+  FLOAT16,
+  INT16,
+  INT8
+};
+
+/** Parse the precision from a read_states variable
+ *
+ * @param _variable : e.g. "shell_layers float16"
+ * @param _name : name of the variable, e.g. "shell_layers"
+ * @return precision : FLOAT32 if none is mentioned
+ *
+ * Every other word must be a precision, thus a typo such as
+ * "shell_layers float8" throws instead of silently using float32.
+ */
+inline Precision
+parse_precision(const std::string& _variable, const std::string& _name)
+{
+  auto precision = Precision::FLOAT32;
+  size_t nPrecisions = 0;
+
+  std::istringstream words(_variable);
+  std::string word;
+  while (words >> word) {
+    if (word == _name)
+      continue;
+    else if (word == "float32")
+      precision = Precision::FLOAT32;
+    else if (word == "float16")
+      precision = Precision::FLOAT16;
+    else if (word == "int16")
+      precision = Precision::INT16;
+    else if (word == "int8")
+      precision = Precision::INT8;
+    else
+      throw(std::invalid_argument(
+        "Unknown precision \"" + word + "\" in \"" + _variable +
+        "\", use float32, float16, int16 or int8."));
+    ++nPrecisions;
+  }
+
+  if (nPrecisions > 1)
+    throw(std::invalid_argument("More than one precision in \"" + _variable +
+                                "\"."));
+
+  return precision;
+}
+
+/** Convert a float to a half float with rounding to nearest even
+ *
+ * @param _value : value to convert
+ * @return bits : bits of the half float
+ *
+ * Values too large for a half become infinity, too small ones
+ * subnormal or zero. Results are identical to the F16C instructions.
+ */
+inline uint16_t
+float_to_half(float _value)
+{
+  uint32_t bits;
+  std::memcpy(&bits, &_value, sizeof(bits));
+
+  const auto sign = static_cast<uint16_t>((bits >> 16) & 0x8000);
+  const uint32_t abs_bits = bits & 0x7fffffff;
+
+  // inf or nan (nan is quieted)
+  if (abs_bits >= 0x7f800000)
+    return sign | 0x7c00 |
+           (abs_bits > 0x7f800000 ? 0x0200 | ((abs_bits >> 13) & 0x03ff) : 0);
+
+  // rounds to a value beyond the max of 65504
+  if (abs_bits >= 0x477ff000)
+    return sign | 0x7c00;
+
+  // subnormal half
+  if (abs_bits < 0x38800000) {
+    if (abs_bits <= 0x33000000)
+      return sign;
+    const uint32_t shift = 126 - (abs_bits >> 23);
+    const uint32_t mantissa = (abs_bits & 0x007fffff) | 0x00800000;
+    uint32_t result = mantissa >> shift;
+    const uint32_t remainder = mantissa & ((1u << shift) - 1);
+    const uint32_t halfway = 1u << (shift - 1);
+    if (remainder > halfway || (remainder == halfway && (result & 1)))
+      ++result;
+    return sign | static_cast<uint16_t>(result);
+  }
+
+  // normal half, rebias the exponent from 127 to 15
+  uint32_t result = (abs_bits >> 13) - (112u << 10);
+  const uint32_t remainder = abs_bits & 0x1fff;
+  if (remainder > 0x1000 || (remainder == 0x1000 && (result & 1)))
+    ++result;
+  return sign | static_cast<uint16_t>(result);
+}
+
+/** Convert a half float to a float
+ *
+ * @param _bits : bits of the half float
+ * @return value : exact float value
+ *
+ * Results are identical to the F16C instructions.
+ */
+inline float
+half_to_float(uint16_t _bits)
+{
+  const uint32_t sign = static_cast<uint32_t>(_bits & 0x8000) << 16;
+  const uint32_t exponent = (_bits >> 10) & 0x1f;
+  uint32_t mantissa = _bits & 0x03ff;
+
+  uint32_t bits;
+  if (exponent == 0x1f) {
+    // inf or nan (nan is quieted)
+    bits = sign | 0x7f800000 | (mantissa ? 0x00400000 | (mantissa << 13) : 0);
+  } else if (exponent == 0) {
+    if (mantissa == 0) {
+      bits = sign;
+    } else {
+      // normalize the subnormal
+      uint32_t float_exponent = 113;
+      while (!(mantissa & 0x0400)) {
+        mantissa <<= 1;
+        --float_exponent;
+      }
+      bits = sign | (float_exponent << 23) | ((mantissa & 0x03ff) << 13);
+    }
+  } else {
+    bits = sign | ((exponent + 112) << 23) | (mantissa << 13);
+  }
+
+  float value;
+  std::memcpy(&value, &bits, sizeof(value));
+  return value;
+}
+
+#if defined(QD_F16C_STATIC) || defined(QD_F16C_DISPATCH)
+
+#ifdef QD_F16C_DISPATCH
+#define QD_F16C_TARGET __attribute__((target("avx,f16c")))
+#else
+#define QD_F16C_TARGET
+#endif
+
+/** Tells whether the CPU and the OS support F16C
+ *
+ * @return supported
+ */
+inline bool
+has_f16c()
+{
+#ifdef QD_F16C_STATIC
+  return true;
+#else
+  static const bool supported = []() {
+    unsigned int eax, ebx, ecx, edx;
+    if (!__get_cpuid(1, &eax, &ebx, &ecx, &edx))
+      return false;
+    if (!(ecx & bit_OSXSAVE) || !(ecx & bit_AVX) || !(ecx & bit_F16C))
+      return false;
+
+    // the OS must save the ymm registers
+    unsigned int xcr0, xcr0_high;
+    __asm__("xgetbv" : "=a"(xcr0), "=d"(xcr0_high) : "c"(0));
+    return (xcr0 & 0x6) == 0x6;
+  }();
+  return supported;
+#endif
+}
+
+/** Convert blocks of 8 floats to half floats with F16C
+ *
+ * @param _values : values to convert
+ * @param _size : number of values
+ * @param _out : output bits
+ * @return nConverted : number of values converted
+ */
+QD_F16C_TARGET inline size_t
+float_to_half_f16c(const float* _values, size_t _size, uint16_t* _out)
+{
+  size_t iValue = 0;
+  for (; iValue + 8 <= _size; iValue += 8) {
+    const __m256 values = _mm256_loadu_ps(_values + iValue);
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(_out + iValue),
+                     _mm256_cvtps_ph(values, _MM_FROUND_TO_NEAREST_INT));
+  }
+  return iValue;
+}
+
+/** Convert blocks of 8 half floats to floats with F16C
+ *
+ * @param _bits : half floats to convert
+ * @param _size : number of values
+ * @param _out : output values
+ * @return nConverted : number of values converted
+ */
+QD_F16C_TARGET inline size_t
+half_to_float_f16c(const uint16_t* _bits, size_t _size, float* _out)
+{
+  size_t iValue = 0;
+  for (; iValue + 8 <= _size; iValue += 8) {
+    const __m128i bits =
+      _mm_loadu_si128(reinterpret_cast<const __m128i*>(_bits + iValue));
+    _mm256_storeu_ps(_out + iValue, _mm256_cvtph_ps(bits));
+  }
+  return iValue;
+}
+
+#undef QD_F16C_TARGET
+
+#endif
+
+/** Convert an array of floats to half floats
+ *
+ * @param _values : values to convert
+ * @param _size : number of values
+ * @param _out : output bits
+ *
+ * Uses the F16C instructions if the CPU has them.
+ */
+inline void
+float_to_half(const float* _values, size_t _size, uint16_t* _out)
+{
+  size_t iValue = 0;
+#if defined(QD_F16C_STATIC) || defined(QD_F16C_DISPATCH)
+  if (has_f16c())
+    iValue = float_to_half_f16c(_values, _size, _out);
+#endif
+  for (; iValue < _size; ++iValue)
+    _out[iValue] = float_to_half(_values[iValue]);
+}
+
+/** Convert an array of half floats to floats
+ *
+ * @param _bits : half floats to convert
+ * @param _size : number of values
+ * @param _out : output values
+ *
+ * Uses the F16C instructions if the CPU has them.
+ */
+inline void
+half_to_float(const uint16_t* _bits, size_t _size, float* _out)
+{
+  size_t iValue = 0;
+#if defined(QD_F16C_STATIC) || defined(QD_F16C_DISPATCH)
+  if (has_f16c())
+    iValue = half_to_float_f16c(_bits, _size, _out);
+#endif
+  for (; iValue < _size; ++iValue)
+    _out[iValue] = half_to_float(_bits[iValue]);
+}
+
+/** Float tensor stored with a compact element type
+ *
+ * The data is written and read slice by slice along the first axis, which
+ * in the state data is the time. Reading always widens back to float.
+ * For the fixed-point types every slice has an own offset and scale per
+ * field, the fields being the entries of the last axis. The error of a
+ * value therefore is at most half a step of the range of its field in
+ * its slice. FLOAT32 stores the data as is.
+ */
+class CompactTensor
+{
+private:
+  Precision _precision;
+  std::vector<size_t> _shape;
+  size_t _slice_size;
+  size_t _nFields;
+
+  Tensor_ptr<float> _float_data;
+  std::vector<uint16_t> _half_data;
+  std::vector<int16_t> _int16_data;
+  std::vector<int8_t> _int8_data;
+  std::vector<float> _offsets; // nSlices x nFields
+  std::vector<float> _scales;  // nSlices x nFields
+
+  template<typename I>
+  void quantize_slice(size_t _iSlice, const float* _values, I* _out);
+  template<typename I>
+  void dequantize_slice(size_t _iSlice, const I* _data, float* _out) const;
+
+public:
+  explicit CompactTensor(Precision _precision = Precision::FLOAT32);
+
+  Precision get_precision() const;
+  const std::vector<size_t>& get_shape() const;
+  size_t size() const;
+  size_t get_nbytes() const;
+
+  void resize(const std::vector<size_t>& _new_shape);
+  void set_slice(size_t _iSlice, const float* _values);
+  void get_slice(size_t _iSlice, float* _out) const;
+  float* get_float_slice(size_t _iSlice);
+  const float* get_float_slice(size_t _iSlice) const;
+  Tensor_ptr<float> get_tensor() const;
+};
+
+using CompactTensor_ptr = std::shared_ptr<CompactTensor>;
+
+/** Create an empty compact tensor
+ *
+ * @param _precision : element type of the storage
+ */
+inline CompactTensor::CompactTensor(Precision _precision)
+  : _precision(_precision)
+  , _slice_size(0)
+  , _nFields(1)
+  , _float_data(std::make_shared<Tensor<float>>())
+{}
+
+/** Get the element type of the storage
+ *
+ * @return precision
+ */
+inline Precision
+CompactTensor::get_precision() const
+{
+  return _precision;
+}
+
+/** Get the shape of the tensor
+ *
+ * @return shape
+ */
+inline const std::vector<size_t>&
+CompactTensor::get_shape() const
+{
+  return _shape;
+}
+
+/** Get the number of entries of the tensor
+ *
+ * @return size
+ */
+inline size_t
+CompactTensor::size() const
+{
+  return _shape.empty() ? 0 : _shape[0] * _slice_size;
+}
+
+/** Get the memory used for the data including the scales
+ *
+ * @return nbytes
+ */
+inline size_t
+CompactTensor::get_nbytes() const
+{
+  return _float_data->size() * sizeof(float) +
+         _half_data.size() * sizeof(uint16_t) +
+         _int16_data.size() * sizeof(int16_t) +
+         _int8_data.size() * sizeof(int8_t) +
+         (_offsets.size() + _scales.size()) * sizeof(float);
+}
+
+/** Resize the tensor
+ *
+ * @param _new_shape : new shape, at least one dimension
+ *
+ * Slices already set are kept if only the first axis changes.
+ * New entries are 0.
+ */
+inline void
+CompactTensor::resize(const std::vector<size_t>& _new_shape)
+{
+  if (_new_shape.empty())
+    throw(std::invalid_argument("A CompactTensor needs at least one axis."));
+
+  _shape = _new_shape;
+  _slice_size = std::accumulate(_shape.begin() + 1,
+                                _shape.end(),
+                                static_cast<size_t>(1),
+                                std::multiplies<size_t>());
+  _nFields = _shape.size() > 1 ? _shape.back() : 1;
+
+  const size_t nEntries = _shape[0] * _slice_size;
+  switch (_precision) {
+    case Precision::FLOAT32:
+      _float_data->resize(_shape);
+      return;
+    case Precision::FLOAT16:
+      _half_data.resize(nEntries);
+      return;
+    case Precision::INT16:
+      _int16_data.resize(nEntries);
+      break;
+    case Precision::INT8:
+      _int8_data.resize(nEntries);
+      break;
+  }
+  _offsets.resize(_shape[0] * _nFields);
+  _scales.resize(_shape[0] * _nFields);
+}
+
+/** Quantize a slice to fixed-point values
+ *
+ * @param _iSlice : index of the slice
+ * @param _values : slice values (slice_size)
+ * @param _out : fixed-point output (slice_size)
+ */
+template<typename I>
+void
+CompactTensor::quantize_slice(size_t _iSlice, const float* _values, I* _out)
+{
+  if (_slice_size == 0 || _nFields == 0)
+    return;
+
+  const float max_int = static_cast<float>(std::numeric_limits<I>::max());
+  const size_t nRows = _slice_size / _nFields;
+  float* offsets = _offsets.data() + _iSlice * _nFields;
+  float* scales = _scales.data() + _iSlice * _nFields;
+
+  // range of the fields
+  std::vector<float> field_min(_values, _values + _nFields);
+  std::vector<float> field_max(_values, _values + _nFields);
+  for (size_t iRow = 1; iRow < nRows; ++iRow) {
+    const float* row = _values + iRow * _nFields;
+    for (size_t iField = 0; iField < _nFields; ++iField) {
+      field_min[iField] = std::min(field_min[iField], row[iField]);
+      field_max[iField] = std::max(field_max[iField], row[iField]);
+    }
+  }
+
+  std::vector<float> inverse_scales(_nFields);
+  for (size_t iField = 0; iField < _nFields; ++iField) {
+    offsets[iField] = (field_min[iField] + field_max[iField]) / 2;
+    scales[iField] = (field_max[iField] - field_min[iField]) / (2 * max_int);
+    inverse_scales[iField] =
+      scales[iField] > 0.f ? 1.f / scales[iField] : 0.f;
+  }
+
+  for (size_t iRow = 0; iRow < nRows; ++iRow) {
+    const float* row = _values + iRow * _nFields;
+    I* out = _out + iRow * _nFields;
+    for (size_t iField = 0; iField < _nFields; ++iField) {
+      const float value =
+        std::round((row[iField] - offsets[iField]) * inverse_scales[iField]);
+      out[iField] =
+        static_cast<I>(std::max(-max_int, std::min(max_int, value)));
+    }
+  }
+}
+
+/** Widen a fixed-point slice to floats
+ *
+ * @param _iSlice : index of the slice
+ * @param _data : fixed-point values of the slice (slice_size)
+ * @param _out : output values (slice_size)
+ */
+template<typename I>
+void
+CompactTensor::dequantize_slice(size_t _iSlice,
+                                const I* _data,
+                                float* _out) const
+{
+  if (_slice_size == 0 || _nFields == 0)
+    return;
+
+  const size_t nRows = _slice_size / _nFields;
+  const float* offsets = _offsets.data() + _iSlice * _nFields;
+  const float* scales = _scales.data() + _iSlice * _nFields;
+
+  for (size_t iRow = 0; iRow < nRows; ++iRow) {
+    const I* row = _data + iRow * _nFields;
+    float* out = _out + iRow * _nFields;
+    for (size_t iField = 0; iField < _nFields; ++iField)
+      out[iField] =
+        offsets[iField] + static_cast<float>(row[iField]) * scales[iField];
+  }
+}
+
+/** Set all values of a slice along the first axis
+ *
+ * @param _iSlice : index of the slice, e.g. the state
+ * @param _values : values of the slice (product of the other axes)
+ */
+inline void
+CompactTensor::set_slice(size_t _iSlice, const float* _values)
+{
+  if (_shape.empty() || _iSlice >= _shape[0])
+    throw(std::invalid_argument("Slice index " + std::to_string(_iSlice) +
+                                " exceeds the size of the CompactTensor."));
+
+  const size_t offset = _iSlice * _slice_size;
+  switch (_precision) {
+    case Precision::FLOAT32:
+      std::copy(_values,
+                _values + _slice_size,
+                _float_data->get_data().begin() + offset);
+      break;
+    case Precision::FLOAT16:
+      float_to_half(_values, _slice_size, _half_data.data() + offset);
+      break;
+    case Precision::INT16:
+      quantize_slice(_iSlice, _values, _int16_data.data() + offset);
+      break;
+    case Precision::INT8:
+      quantize_slice(_iSlice, _values, _int8_data.data() + offset);
+      break;
+  }
+}
+
+/** Get the values of a slice along the first axis widened to float
+ *
+ * @param _iSlice : index of the slice, e.g. the state
+ * @param _out : output values (product of the other axes)
+ */
+inline void
+CompactTensor::get_slice(size_t _iSlice, float* _out) const
+{
+  if (_shape.empty() || _iSlice >= _shape[0])
+    throw(std::invalid_argument("Slice index " + std::to_string(_iSlice) +
+                                " exceeds the size of the CompactTensor."));
+
+  const size_t offset = _iSlice * _slice_size;
+  switch (_precision) {
+    case Precision::FLOAT32: {
+      const auto& data = _float_data->get_data();
+      std::copy(data.begin() + offset,
+                data.begin() + offset + _slice_size,
+                _out);
+      break;
+    }
+    case Precision::FLOAT16:
+      half_to_float(_half_data.data() + offset, _slice_size, _out);
+      break;
+    case Precision::INT16:
+      dequantize_slice(_iSlice, _int16_data.data() + offset, _out);
+      break;
+    case Precision::INT8:
+      dequantize_slice(_iSlice, _int8_data.data() + offset, _out);
+      break;
+  }
+}
+
+/** Get the storage of a slice, if it is kept as float
+ *
+ * @param _iSlice : index of the slice, e.g. the state
+ * @return data : slice in the storage for FLOAT32, otherwise nullptr
+ *
+ * Allows to write or read FLOAT32 data without staging a copy.
+ */
+inline float*
+CompactTensor::get_float_slice(size_t _iSlice)
+{
+  return const_cast<float*>(
+    static_cast<const CompactTensor*>(this)->get_float_slice(_iSlice));
+}
+
+/** Get the storage of a slice, if it is kept as float
+ *
+ * @param _iSlice : index of the slice, e.g. the state
+ * @return data : slice in the storage for FLOAT32, otherwise nullptr
+ */
+inline const float*
+CompactTensor::get_float_slice(size_t _iSlice) const
+{
+  if (_shape.empty() || _iSlice >= _shape[0])
+    throw(std::invalid_argument("Slice index " + std::to_string(_iSlice) +
+                                " exceeds the size of the CompactTensor."));
+
+  if (_precision != Precision::FLOAT32)
+    return nullptr;
+  return _float_data->get_data().data() + _iSlice * _slice_size;
+}
+
+/** Get the entire data widened to float
+ *
+ * @return tensor : the storage itself for FLOAT32, otherwise a new tensor
+ */
+inline Tensor_ptr<float>
+CompactTensor::get_tensor() const
+{
+  if (_precision == Precision::FLOAT32)
+    return _float_data;
+
+  auto tensor = std::make_shared<Tensor<float>>();
+  if (_shape.empty())
+    return tensor;
+  tensor->resize(_shape);
+
+  float* data = tensor->get_data().data();
+  const auto nSlices = static_cast<int64_t>(_shape[0]);
+#pragma omp parallel for schedule(static)
+  for (int64_t iSlice = 0; iSlice < nSlices; ++iSlice)
+    get_slice(static_cast<size_t>(iSlice), data + iSlice * _slice_size);
+
+  return tensor;
+}
+
+} // namespace qd
+
+#endif
@@ -0,0 +1,657 @@
+#ifndef TENSOREXPRESSION_HPP
+#define TENSOREXPRESSION_HPP
+
+#include <cmath>
+#include <cstdint>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+#include <dyna_cpp/math/Tensor.hpp>
+#include <dyna_cpp/math/TensorView.hpp>
+
+namespace qd {
+
+/** Base of all lazy tensor expressions
+ *
+ * An expression only describes a computation, e.g. a + b * 2. It is
+ * computed by evaluate or a reduction in one loop over the result,
+ * thus composed expressions create no temporary tensors.
+ *
+ * The result is walked row by row, a row being the last axis. Every
+ * node of an expression is placed on a row with seek and then read
+ * along the row with operator[].
+ */
+template<typename E>
+class TensorExpression
+{
+public:
+  const E& derived() const { return static_cast<const E&>(*this); }
+};
+
+/** Compute the shape of two broadcasted shapes
+ *
+ * @param _shape1
+ * @param _shape2
+ * @return shape : broadcasted shape
+ *
+ * As in numpy the shapes are aligned at the last axis and an axis of
+ * size 1 is repeated to match the other one.
+ */
+inline std::vector<size_t>
+broadcast_shapes(const std::vector<size_t>& _shape1,
+                 const std::vector<size_t>& _shape2)
+{
+  const auto& longer = _shape1.size() >= _shape2.size() ? _shape1 : _shape2;
+  const auto& shorter = _shape1.size() >= _shape2.size() ? _shape2 : _shape1;
+
+  std::vector<size_t> shape(longer);
+  const size_t offset = longer.size() - shorter.size();
+  for (size_t iDim = 0; iDim < shorter.size(); ++iDim) {
+    auto& extent = shape[offset + iDim];
+    if (shorter[iDim] == extent || shorter[iDim] == 1)
+      continue;
+    if (extent != 1)
+      throw(std::invalid_argument(
+        "Tensor shapes can not be broadcasted, axis " +
+        std::to_string(offset + iDim) + " has the sizes " +
+        std::to_string(extent) + " and " + std::to_string(shorter[iDim]) +
+        "."));
+    extent = shorter[iDim];
+  }
+
+  return shape;
+}
+
+/** Compute the index of a row from its number
+ *
+ * @param _iRow : number of the row in c-order
+ * @param _shape : shape of the tensor
+ * @param _skip_axis : axis which is not counted, e.g. a reduced one
+ * @param _row_index : index of all axes except the last one
+ */
+inline void
+unravel_row_index(size_t _iRow,
+                  const std::vector<size_t>& _shape,
+                  size_t _skip_axis,
+                  std::vector<size_t>& _row_index)
+{
+  for (size_t iDim = _row_index.size(); iDim > 0; --iDim) {
+    if (iDim - 1 == _skip_axis)
+      continue;
+    _row_index[iDim - 1] = _iRow % _shape[iDim - 1];
+    _iRow /= _shape[iDim - 1];
+  }
+}
+
+/** Expression of a tensor or a view
+ *
+ * The operand keeps the owning tensor alive. Broadcasted axes get the
+ * stride 0, thus no data is repeated in memory. The data pointer is
+ * resolved on construction, thus the owner may not be resized while
+ * the expression lives.
+ */
+template<typename T>
+class TensorOperand : public TensorExpression<TensorOperand<T>>
+{
+private:
+  Tensor_ptr<T> _owner;
+  const T* _data;
+  std::vector<size_t> _shape;
+  std::vector<size_t> _strides;
+  const T* _row;
+  size_t _row_stride;
+
+public:
+  typedef T value_type;
+
+  explicit TensorOperand(const TensorView<T>& _view)
+    : _owner(_view.get_owner())
+    , _data(_view.data())
+    , _shape(_view.get_shape())
+    , _strides(_view.get_strides())
+    , _row(_view.data())
+    , _row_stride(0)
+  {}
+
+  const std::vector<size_t>& get_shape() const { return _shape; }
+
+  /** Broadcast the operand to a shape
+   *
+   * @param _target_shape : shape of the result
+   */
+  void broadcast(const std::vector<size_t>& _target_shape)
+  {
+    if (_shape.size() > _target_shape.size())
+      throw(std::invalid_argument(
+        "Tensor with " + std::to_string(_shape.size()) +
+        " dimensions can not be broadcasted to " +
+        std::to_string(_target_shape.size()) + " dimensions."));
+
+    std::vector<size_t> strides(_target_shape.size(), 0);
+    const size_t offset = _target_shape.size() - _shape.size();
+    for (size_t iDim = 0; iDim < _shape.size(); ++iDim) {
+      if (_shape[iDim] == _target_shape[offset + iDim])
+        strides[offset + iDim] = _strides[iDim];
+      else if (_shape[iDim] != 1)
+        throw(std::invalid_argument(
+          "Tensor axis of size " + std::to_string(_shape[iDim]) +
+          " can not be broadcasted to size " +
+          std::to_string(_target_shape[offset + iDim]) + "."));
+    }
+
+    _shape = _target_shape;
+    _strides = strides;
+  }
+
+  /** Place the operand on a row
+   *
+   * @param _row_index : index of all axes except the last one
+   */
+  void seek(const std::vector<size_t>& _row_index)
+  {
+    size_t offset = 0;
+    for (size_t iDim = 0; iDim < _row_index.size(); ++iDim)
+      offset += _row_index[iDim] * _strides[iDim];
+    _row = _data + offset;
+    _row_stride = _strides.empty() ? 0 : _strides.back();
+  }
+
+  T operator[](size_t _index) const { return _row[_index * _row_stride]; }
+};
+
+/** Expression of a scalar, which broadcasts to any shape
+ *
+ */
+template<typename T>
+class ScalarOperand : public TensorExpression<ScalarOperand<T>>
+{
+private:
+  T _value;
+  std::vector<size_t> _shape;
+
+public:
+  typedef T value_type;
+
+  explicit ScalarOperand(T value)
+    : _value(value)
+  {}
+
+  const std::vector<size_t>& get_shape() const { return _shape; }
+  void broadcast(const std::vector<size_t>&) {}
+  void seek(const std::vector<size_t>&) {}
+  T operator[](size_t) const { return _value; }
+};
+
+/** Element-wise function of an expression
+ *
+ */
+template<typename Op, typename E>
+class UnaryExpression : public TensorExpression<UnaryExpression<Op, E>>
+{
+private:
+  E _operand;
+
+public:
+  typedef typename E::value_type value_type;
+
+  explicit UnaryExpression(const E& operand)
+    : _operand(operand)
+  {}
+
+  const std::vector<size_t>& get_shape() const
+  {
+    return _operand.get_shape();
+  }
+  void broadcast(const std::vector<size_t>& _target_shape)
+  {
+    _operand.broadcast(_target_shape);
+  }
+  void seek(const std::vector<size_t>& _row_index)
+  {
+    _operand.seek(_row_index);
+  }
+  value_type operator[](size_t _index) const
+  {
+    return Op::apply(_operand[_index]);
+  }
+};
+
+/** Element-wise function of two broadcasted expressions
+ *
+ */
+template<typename Op, typename L, typename R>
+class BinaryExpression : public TensorExpression<BinaryExpression<Op, L, R>>
+{
+  static_assert(
+    std::is_same<typename L::value_type, typename R::value_type>::value,
+    "Tensor expressions require operands of the same type.");
+
+private:
+  L _left;
+  R _right;
+  std::vector<size_t> _shape;
+
+public:
+  typedef typename L::value_type value_type;
+
+  BinaryExpression(const L& left, const R& right)
+    : _left(left)
+    , _right(right)
+    , _shape(broadcast_shapes(left.get_shape(), right.get_shape()))
+  {}
+
+  const std::vector<size_t>& get_shape() const { return _shape; }
+  void broadcast(const std::vector<size_t>& _target_shape)
+  {
+    _left.broadcast(_target_shape);
+    _right.broadcast(_target_shape);
+    _shape = _target_shape;
+  }
+  void seek(const std::vector<size_t>& _row_index)
+  {
+    _left.seek(_row_index);
+    _right.seek(_row_index);
+  }
+  value_type operator[](size_t _index) const
+  {
+    return Op::apply(_left[_index], _right[_index]);
+  }
+};
+
+// element-wise operations
+struct PlusOp
+{
+  template<typename T>
+  static T apply(T _a, T _b)
+  {
+    return _a + _b;
+  }
+};
+
+struct MinusOp
+{
+  template<typename T>
+  static T apply(T _a, T _b)
+  {
+    return _a - _b;
+  }
+};
+
+struct MultipliesOp
+{
+  template<typename T>
+  static T apply(T _a, T _b)
+  {
+    return _a * _b;
+  }
+};
+
+struct DividesOp
+{
+  template<typename T>
+  static T apply(T _a, T _b)
+  {
+    return _a / _b;
+  }
+};
+
+struct MaximumOp
+{
+  template<typename T>
+  static T apply(T _a, T _b)
+  {
+    return _a < _b ? _b : _a;
+  }
+};
+
+struct MinimumOp
+{
+  template<typename T>
+  static T apply(T _a, T _b)
+  {
+    return _b < _a ? _b : _a;
+  }
+};
+
+struct NegateOp
+{
+  template<typename T>
+  static T apply(T _a)
+  {
+    return -_a;
+  }
+};
+
+struct AbsOp
+{
+  template<typename T>
+  static T apply(T _a)
+  {
+    return _a < 0 ? -_a : _a;
+  }
+};
+
+struct SqrtOp
+{
+  template<typename T>
+  static T apply(T _a)
+  {
+    return static_cast<T>(std::sqrt(_a));
+  }
+};
+
+/** Use a view in an expression
+ *
+ * @param _view
+ * @return operand
+ */
+template<typename T>
+inline TensorOperand<T>
+as_expression(const TensorView<T>& _view)
+{
+  return TensorOperand<T>(_view);
+}
+
+/** Use a tensor in an expression
+ *
+ * @param _tensor
+ * @return operand
+ */
+template<typename T>
+inline TensorOperand<T>
+as_expression(Tensor_ptr<T> _tensor)
+{
+  return TensorOperand<T>(TensorView<T>(_tensor));
+}
+
+// operators for expression with expression, scalar or scalar with expression
+#define QD_TENSOR_BINARY_FUNCTION(NAME, OP)                                   \
+  template<typename L, typename R>                                            \
+  inline BinaryExpression<OP, L, R> NAME(const TensorExpression<L>& _left,    \
+                                         const TensorExpression<R>& _right)   \
+  {                                                                           \
+    return BinaryExpression<OP, L, R>(_left.derived(), _right.derived());     \
+  }                                                                           \
+  template<typename L>                                                        \
+  inline BinaryExpression<OP, L, ScalarOperand<typename L::value_type>> NAME( \
+    const TensorExpression<L>& _left, typename L::value_type _right)          \
+  {                                                                           \
+    return BinaryExpression<OP, L, ScalarOperand<typename L::value_type>>(    \
+      _left.derived(), ScalarOperand<typename L::value_type>(_right));        \
+  }                                                                           \
+  template<typename R>                                                        \
+  inline BinaryExpression<OP, ScalarOperand<typename R::value_type>, R> NAME( \
+    typename R::value_type _left, const TensorExpression<R>& _right)          \
+  {                                                                           \
+    return BinaryExpression<OP, ScalarOperand<typename R::value_type>, R>(    \
+      ScalarOperand<typename R::value_type>(_left), _right.derived());        \
+  }
+
+QD_TENSOR_BINARY_FUNCTION(operator+, PlusOp)
+QD_TENSOR_BINARY_FUNCTION(operator-, MinusOp)
+QD_TENSOR_BINARY_FUNCTION(operator*, MultipliesOp)
+QD_TENSOR_BINARY_FUNCTION(operator/, DividesOp)
+QD_TENSOR_BINARY_FUNCTION(maximum, MaximumOp)
+QD_TENSOR_BINARY_FUNCTION(minimum, MinimumOp)
+
+#undef QD_TENSOR_BINARY_FUNCTION
+
+template<typename E>
+inline UnaryExpression<NegateOp, E>
+operator-(const TensorExpression<E>& _expression)
+{
+  return UnaryExpression<NegateOp, E>(_expression.derived());
+}
+
+// not named abs and sqrt, which would hide the scalar versions in qd
+template<typename E>
+inline UnaryExpression<AbsOp, E>
+absolute(const TensorExpression<E>& _expression)
+{
+  return UnaryExpression<AbsOp, E>(_expression.derived());
+}
+
+template<typename E>
+inline UnaryExpression<SqrtOp, E>
+square_root(const TensorExpression<E>& _expression)
+{
+  return UnaryExpression<SqrtOp, E>(_expression.derived());
+}
+
+/** Evaluate an expression into existing memory
+ *
+ * @param _expression : expression to compute
+ * @param _out : view to write to, the expression is broadcasted to it
+ *
+ * The rows of the result are computed in parallel. Writing into an
+ * operand of the expression is only safe if it is not broadcasted.
+ */
+template<typename E>
+void
+evaluate(const TensorExpression<E>& _expression,
+         const TensorView<typename E::value_type>& _out)
+{
+  typedef typename E::value_type T;
+
+  const auto& shape = _out.get_shape();
+  auto expression = _expression.derived();
+  expression.broadcast(shape);
+
+  const size_t nDims = shape.size();
+  const size_t row_size = nDims != 0 ? shape.back() : 1;
+  size_t nRows = 1;
+  for (size_t iDim = 0; iDim + 1 < nDims; ++iDim)
+    nRows *= shape[iDim];
+  if (_out.size() == 0)
+    return;
+
+  const auto& out_strides = _out.get_strides();
+  const size_t out_row_stride = nDims != 0 ? out_strides.back() : 0;
+  T* out_data = _out.data();
+
+#pragma omp parallel firstprivate(expression)
+  {
+    std::vector<size_t> row_index(nDims != 0 ? nDims - 1 : 0);
+
+#pragma omp for schedule(static)
+    for (int64_t iRow = 0; iRow < static_cast<int64_t>(nRows); ++iRow) {
+      unravel_row_index(
+        static_cast<size_t>(iRow), shape, row_index.size(), row_index);
+      expression.seek(row_index);
+
+      T* out_row = out_data;
+      for (size_t iDim = 0; iDim < row_index.size(); ++iDim)
+        out_row += row_index[iDim] * out_strides[iDim];
+
+      for (size_t iEntry = 0; iEntry < row_size; ++iEntry)
+        out_row[iEntry * out_row_stride] = expression[iEntry];
+    }
+  }
+}
+
+/** Evaluate an expression into a new tensor
+ *
+ * @param _expression : expression to compute
+ * @return tensor : result
+ *
+ * Example: coordinates over time from the initial coordinates
+ *          (nNodes x 3) and the displacements (nNodes x nTimesteps x 3)
+ *
+ *          auto coords = evaluate(
+ *            as_expression(TensorView<float>(coords0).insert_axis(1)) +
+ *            as_expression(disp));
+ */
+template<typename E>
+Tensor_ptr<typename E::value_type>
+evaluate(const TensorExpression<E>& _expression)
+{
+  typedef typename E::value_type T;
+
+  auto tensor = std::make_shared<Tensor<T>>();
+  tensor->resize(_expression.derived().get_shape());
+  evaluate(_expression, TensorView<T>(tensor));
+
+  return tensor;
+}
+
+/** Reduce an expression along an axis
+ *
+ * @param _expression : expression to reduce
+ * @param _axis : axis to reduce, which is removed
+ * @return tensor : result
+ *
+ * The expression is computed while reducing, thus only the reduced
+ * result is allocated. Op must be associative.
+ */
+template<typename Op, typename E>
+Tensor_ptr<typename E::value_type>
+reduce(const TensorExpression<E>& _expression, size_t _axis)
+{
+  typedef typename E::value_type T;
+
+  auto expression = _expression.derived();
+  const auto shape = expression.get_shape();
+  const size_t nDims = shape.size();
+  if (_axis >= nDims)
+    throw(std::invalid_argument("Reduction axis " + std::to_string(_axis) +
+                                " exceeds the number of dimensions " +
+                                std::to_string(nDims) + "."));
+  if (shape[_axis] == 0)
+    throw(std::invalid_argument("Can not reduce the empty axis " +
+                                std::to_string(_axis) + "."));
+  expression.broadcast(shape);
+
+  std::vector<size_t> out_shape(shape);
+  out_shape.erase(out_shape.begin() + _axis);
+  auto tensor = std::make_shared<Tensor<T>>();
+  tensor->resize(out_shape);
+  if (tensor->size() == 0)
+    return tensor;
+  T* out_data = tensor->get_data().data();
+
+  const size_t row_size = shape.back();
+  const size_t nReduced = shape[_axis];
+
+  // reduce the rows themselves
+  if (_axis == nDims - 1) {
+    const auto nRows = static_cast<int64_t>(tensor->size());
+
+#pragma omp parallel firstprivate(expression)
+    {
+      std::vector<size_t> row_index(nDims - 1);
+
+#pragma omp for schedule(static)
+      for (int64_t iRow = 0; iRow < nRows; ++iRow) {
+        unravel_row_index(
+          static_cast<size_t>(iRow), shape, row_index.size(), row_index);
+        expression.seek(row_index);
+
+        T value = expression[0];
+        for (size_t iEntry = 1; iEntry < row_size; ++iEntry)
+          value = Op::apply(value, expression[iEntry]);
+        out_data[iRow] = value;
+      }
+    }
+
+    // combine rows, every thread owns distinct result rows
+  } else {
+    const auto nOutRows = static_cast<int64_t>(tensor->size() / row_size);
+
+#pragma omp parallel firstprivate(expression)
+    {
+      std::vector<size_t> row_index(nDims - 1);
+
+#pragma omp for schedule(static)
+      for (int64_t iOutRow = 0; iOutRow < nOutRows; ++iOutRow) {
+        unravel_row_index(
+          static_cast<size_t>(iOutRow), shape, _axis, row_index);
+        T* out_row = out_data + iOutRow * row_size;
+
+        row_index[_axis] = 0;
+        expression.seek(row_index);
+        for (size_t iEntry = 0; iEntry < row_size; ++iEntry)
+          out_row[iEntry] = expression[iEntry];
+
+        for (size_t iReduced = 1; iReduced < nReduced; ++iReduced) {
+          row_index[_axis] = iReduced;
+          expression.seek(row_index);
+          for (size_t iEntry = 0; iEntry < row_size; ++iEntry)
+            out_row[iEntry] = Op::apply(out_row[iEntry], expression[iEntry]);
+        }
+      }
+    }
+  }
+
+  return tensor;
+}
+
+/** Sum an expression along an axis
+ *
+ * @param _expression
+ * @param _axis : axis to sum up
+ * @return tensor
+ */
+template<typename E>
+inline Tensor_ptr<typename E::value_type>
+reduce_sum(const TensorExpression<E>& _expression, size_t _axis)
+{
+  return reduce<PlusOp>(_expression, _axis);
+}
+
+/** Mean of an expression along an axis
+ *
+ * @param _expression
+ * @param _axis : axis to average
+ * @return tensor
+ */
+template<typename E>
+Tensor_ptr<typename E::value_type>
+reduce_mean(const TensorExpression<E>& _expression, size_t _axis)
+{
+  typedef typename E::value_type T;
+
+  auto tensor = reduce<PlusOp>(_expression, _axis);
+  const auto count = static_cast<T>(_expression.derived().get_shape()[_axis]);
+  for (auto& value : tensor->get_data())
+    value /= count;
+
+  return tensor;
+}
+
+/** Maximum of an expression along an axis
+ *
+ * @param _expression
+ * @param _axis : axis to reduce
+ * @return tensor
+ *
+ * Example: largest absolute stress components over time from
+ *          (nElems x nTimesteps x 6)
+ *
+ *          auto peak = reduce_max(absolute(as_expression(stress)), 1);
+ */
+template<typename E>
+inline Tensor_ptr<typename E::value_type>
+reduce_max(const TensorExpression<E>& _expression, size_t _axis)
+{
+  return reduce<MaximumOp>(_expression, _axis);
+}
+
+/** Minimum of an expression along an axis
+ *
+ * @param _expression
+ * @param _axis : axis to reduce
+ * @return tensor
+ */
+template<typename E>
+inline Tensor_ptr<typename E::value_type>
+reduce_min(const TensorExpression<E>& _expression, size_t _axis)
+{
+  return reduce<MinimumOp>(_expression, _axis);
+}
+
+} // namespace qd
+
+#endif
@@ -0,0 +1,379 @@
+#ifndef TENSORVIEW_HPP
+#define TENSORVIEW_HPP
+
+#include <algorithm>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include <dyna_cpp/math/Tensor.hpp>
+
+namespace qd {
+
+/** Strided, non-owning view into the data of a tensor
+ *
+ * The view keeps the owning tensor alive, thus slices of it may
+ * be passed around (or to python) without copying any data.
+ * Strides are given in number of entries, not bytes.
+ *
+ * The view stores an offset into the owner instead of a pointer and
+ * resolves it on every access, thus it survives a reallocation of
+ * the owner. Accessing a view which does not fit into a shrunk owner
+ * throws. Raw pointers from data() are valid until the next resize.
+ */
+template<typename T>
+class TensorView
+{
+private:
+  Tensor_ptr<T> _owner;
+  size_t _offset;
+  std::vector<size_t> _shape;
+  std::vector<size_t> _strides;
+
+  void check_axis(size_t _axis) const;
+  size_t get_extent() const;
+
+public:
+  TensorView();
+  explicit TensorView(Tensor_ptr<T> _tensor);
+
+  T* data() const;
+  size_t get_offset() const;
+  Tensor_ptr<T> get_owner() const;
+  const std::vector<size_t>& get_shape() const;
+  const std::vector<size_t>& get_strides() const;
+  size_t ndim() const;
+  size_t size() const;
+  bool is_contiguous() const;
+
+  T& operator()(const std::vector<size_t>& _indexes) const;
+
+  TensorView<T> slice(size_t _axis,
+                      size_t _start,
+                      size_t _stop,
+                      size_t _step = 1) const;
+  TensorView<T> select(size_t _axis, size_t _index) const;
+  TensorView<T> insert_axis(size_t _axis) const;
+  Tensor_ptr<T> copy() const;
+};
+
+template<typename T>
+using TensorView_ptr = std::shared_ptr<TensorView<T>>;
+
+/** Create an empty view
+ *
+ */
+template<typename T>
+TensorView<T>::TensorView()
+  : _offset(0)
+{}
+
+/** Create a view on the entire tensor
+ *
+ * @param _tensor : tensor to view, is kept alive by the view
+ */
+template<typename T>
+TensorView<T>::TensorView(Tensor_ptr<T> _tensor)
+  : _owner(_tensor)
+  , _offset(0)
+{
+  if (_tensor == nullptr)
+    throw(std::invalid_argument("Can not create a view of a null tensor."));
+
+  _shape = _tensor->get_shape();
+
+  _strides.resize(_shape.size());
+  size_t stride = 1;
+  for (size_t iDim = _shape.size(); iDim > 0; --iDim) {
+    _strides[iDim - 1] = stride;
+    stride *= _shape[iDim - 1];
+  }
+}
+
+/** Check if an axis is within the dimensions of the view
+ *
+ * @param _axis : axis to check
+ */
+template<typename T>
+inline void
+TensorView<T>::check_axis(size_t _axis) const
+{
+  if (_axis >= _shape.size())
+    throw(std::invalid_argument("TensorView axis " + std::to_string(_axis) +
+                                " exceeds the number of dimensions " +
+                                std::to_string(_shape.size()) + "."));
+}
+
+/** Get the number of entries of the owner spanned by the view
+ *
+ * @return extent : offset behind the last entry relative to the first
+ */
+template<typename T>
+inline size_t
+TensorView<T>::get_extent() const
+{
+  size_t extent = 1;
+  for (size_t iDim = 0; iDim < _shape.size(); ++iDim) {
+    if (_shape[iDim] == 0)
+      return 0;
+    extent += (_shape[iDim] - 1) * _strides[iDim];
+  }
+  return extent;
+}
+
+/** Get the pointer to the first entry of the view
+ *
+ * @return data : pointer to first entry, nullptr for an empty view
+ *
+ * The pointer is resolved from the owner on every call.
+ */
+template<typename T>
+inline T*
+TensorView<T>::data() const
+{
+  if (_owner == nullptr)
+    return nullptr;
+
+  auto& buffer = _owner->get_data();
+  const auto extent = get_extent();
+  if (extent != 0 && _offset + extent > buffer.size())
+    throw(std::runtime_error(
+      "TensorView exceeds its tensor, which was resized to " +
+      std::to_string(buffer.size()) + " entries."));
+
+  return buffer.data() + _offset;
+}
+
+/** Get the offset of the first entry of the view in the owner
+ *
+ * @return offset : number of entries
+ */
+template<typename T>
+inline size_t
+TensorView<T>::get_offset() const
+{
+  return _offset;
+}
+
+/** Get the tensor owning the memory of the view
+ *
+ * @return owner
+ */
+template<typename T>
+inline Tensor_ptr<T>
+TensorView<T>::get_owner() const
+{
+  return _owner;
+}
+
+/** Get the shape of the view
+ *
+ * @return shape
+ */
+template<typename T>
+inline const std::vector<size_t>&
+TensorView<T>::get_shape() const
+{
+  return _shape;
+}
+
+/** Get the strides of the view in number of entries
+ *
+ * @return strides
+ */
+template<typename T>
+inline const std::vector<size_t>&
+TensorView<T>::get_strides() const
+{
+  return _strides;
+}
+
+/** Get the number of dimensions of the view
+ *
+ * @return ndim
+ */
+template<typename T>
+inline size_t
+TensorView<T>::ndim() const
+{
+  return _shape.size();
+}
+
+/** Get the number of entries in the view
+ *
+ * @return size
+ */
+template<typename T>
+inline size_t
+TensorView<T>::size() const
+{
+  if (_owner == nullptr)
+    return 0;
+
+  size_t n_entries = 1;
+  for (auto extent : _shape)
+    n_entries *= extent;
+  return n_entries;
+}
+
+/** Check whether the view is laid out contiguously in c-order
+ *
+ * @return is_contiguous
+ */
+template<typename T>
+bool
+TensorView<T>::is_contiguous() const
+{
+  size_t stride = 1;
+  for (size_t iDim = _shape.size(); iDim > 0; --iDim) {
+    if (_shape[iDim - 1] != 1 && _strides[iDim - 1] != stride)
+      return false;
+    stride *= _shape[iDim - 1];
+  }
+  return true;
+}
+
+/** Access an entry of the view
+ *
+ * @param _indexes : indexes of the entry
+ * @return entry : reference to the entry in the owner
+ */
+template<typename T>
+inline T& TensorView<T>::operator()(const std::vector<size_t>& _indexes) const
+{
+  if (_indexes.size() != _shape.size())
+    throw(std::invalid_argument(
+      "TensorView index dimension different from view dimension."));
+
+  size_t offset = 0;
+  for (size_t iDim = 0; iDim < _indexes.size(); ++iDim) {
+    if (_indexes[iDim] >= _shape[iDim])
+      throw(std::invalid_argument("TensorView index too large."));
+    offset += _indexes[iDim] * _strides[iDim];
+  }
+
+  return data()[offset];
+}
+
+/** Slice the view along an axis
+ *
+ * @param _axis : axis to slice
+ * @param _start : first index taken
+ * @param _stop : index behind the last index taken
+ * @param _step : step between indexes
+ * @return view : view of the slice, sharing the memory
+ */
+template<typename T>
+TensorView<T>
+TensorView<T>::slice(size_t _axis,
+                     size_t _start,
+                     size_t _stop,
+                     size_t _step) const
+{
+  check_axis(_axis);
+  if (_step == 0)
+    throw(std::invalid_argument("TensorView slice step may not be 0."));
+
+  _stop = std::min(_stop, _shape[_axis]);
+  _start = std::min(_start, _stop);
+
+  TensorView<T> view(*this);
+  view._shape[_axis] = (_stop - _start + _step - 1) / _step;
+  view._strides[_axis] *= _step;
+  if (view._shape[_axis] != 0)
+    view._offset += _start * _strides[_axis];
+
+  return view;
+}
+
+/** Select a single index along an axis, which removes the axis
+ *
+ * @param _axis : axis to select from
+ * @param _index : index to select
+ * @return view : view with one dimension less, sharing the memory
+ *
+ * Example: stress.select(1, nTimesteps - 1) for the last state of a
+ *          (nElems x nTimesteps x 6) tensor.
+ */
+template<typename T>
+TensorView<T>
+TensorView<T>::select(size_t _axis, size_t _index) const
+{
+  check_axis(_axis);
+  if (_index >= _shape[_axis])
+    throw(std::invalid_argument("TensorView index " + std::to_string(_index) +
+                                " exceeds the axis size " +
+                                std::to_string(_shape[_axis]) + "."));
+
+  TensorView<T> view(*this);
+  view._offset += _index * _strides[_axis];
+  view._shape.erase(view._shape.begin() + _axis);
+  view._strides.erase(view._strides.begin() + _axis);
+
+  return view;
+}
+
+/** Insert an axis of size 1, e.g. to broadcast over the states
+ *
+ * @param _axis : position of the new axis, may be ndim for the end
+ * @return view : view with one dimension more, sharing the memory
+ *
+ * Example: coords.insert_axis(1) turns (nNodes x 3) into
+ *          (nNodes x 1 x 3), which broadcasts against
+ *          (nNodes x nTimesteps x 3).
+ */
+template<typename T>
+TensorView<T>
+TensorView<T>::insert_axis(size_t _axis) const
+{
+  if (_axis > _shape.size())
+    throw(std::invalid_argument("TensorView axis " + std::to_string(_axis) +
+                                " exceeds the number of dimensions " +
+                                std::to_string(_shape.size()) + "."));
+
+  TensorView<T> view(*this);
+  view._shape.insert(view._shape.begin() + _axis, 1);
+  view._strides.insert(view._strides.begin() + _axis, 0);
+
+  return view;
+}
+
+/** Copy the entries of the view into a new, contiguous tensor
+ *
+ * @return tensor
+ */
+template<typename T>
+Tensor_ptr<T>
+TensorView<T>::copy() const
+{
+  auto tensor = std::make_shared<Tensor<T>>();
+  tensor->resize(_shape);
+
+  auto& buffer = tensor->get_data();
+  if (buffer.size() == 0 || _owner == nullptr)
+    return tensor;
+  const auto* view_data = data();
+
+  // walk the indexes in c-order
+  std::vector<size_t> indexes(_shape.size(), 0);
+  for (size_t iEntry = 0; iEntry < buffer.size(); ++iEntry) {
+
+    size_t offset = 0;
+    for (size_t iDim = 0; iDim < indexes.size(); ++iDim)
+      offset += indexes[iDim] * _strides[iDim];
+    buffer[iEntry] = view_data[offset];
+
+    for (size_t iDim = indexes.size(); iDim > 0; --iDim) {
+      if (++indexes[iDim - 1] < _shape[iDim - 1])
+        break;
+      indexes[iDim - 1] = 0;
+    }
+  }
+
+  return tensor;
+}
+
+} // namespace qd
+
+#endif
@@ -0,0 +1,194 @@
+#ifndef TIMEENVELOPE_HPP
+#define TIMEENVELOPE_HPP
+
+#include <algorithm>
+#include <cstdint>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include <dyna_cpp/math/Tensor.hpp>
+
+namespace qd {
+
+/** Running min/max of a result over the states
+ *
+ * States are fed one after another, thus the time history of the
+ * result never has to be stored. All tensors are (nEntities x nComponents).
+ * The state of an extremum is the index of the state it occurred in,
+ * entities which never received a value keep the state -1 and the value 0.
+ */
+template<typename T>
+class TimeEnvelope
+{
+private:
+  size_t _nEntities;
+  size_t _nComponents;
+  Tensor_ptr<T> _max;
+  Tensor_ptr<T> _min;
+  Tensor_ptr<int32_t> _max_state;
+  Tensor_ptr<int32_t> _min_state;
+
+public:
+  TimeEnvelope(size_t _nEntities, size_t _nComponents);
+
+  size_t get_nEntities() const;
+  size_t get_nComponents() const;
+
+  void add(size_t _iEntity, size_t _iState, const T* _values);
+  void add_state(size_t _iState, const T* _values);
+
+  Tensor_ptr<T> get_max() const;
+  Tensor_ptr<T> get_min() const;
+  Tensor_ptr<int32_t> get_max_state() const;
+  Tensor_ptr<int32_t> get_min_state() const;
+};
+
+template<typename T>
+using TimeEnvelope_ptr = std::shared_ptr<TimeEnvelope<T>>;
+
+/** Create an empty envelope
+ *
+ * @param _nEntities : number of entities, e.g. elements or nodes
+ * @param _nComponents : number of components per entity
+ */
+template<typename T>
+TimeEnvelope<T>::TimeEnvelope(size_t _nEntities, size_t _nComponents)
+  : _nEntities(_nEntities)
+  , _nComponents(_nComponents)
+  , _max(std::make_shared<Tensor<T>>())
+  , _min(std::make_shared<Tensor<T>>())
+  , _max_state(std::make_shared<Tensor<int32_t>>())
+  , _min_state(std::make_shared<Tensor<int32_t>>())
+{
+  _max->resize({ _nEntities, _nComponents });
+  _min->resize({ _nEntities, _nComponents });
+  _max_state->resize({ _nEntities, _nComponents });
+  _min_state->resize({ _nEntities, _nComponents });
+
+  auto& max_state = _max_state->get_data();
+  auto& min_state = _min_state->get_data();
+  std::fill(max_state.begin(), max_state.end(), -1);
+  std::fill(min_state.begin(), min_state.end(), -1);
+}
+
+/** Get the number of entities
+ *
+ * @return nEntities
+ */
+template<typename T>
+inline size_t
+TimeEnvelope<T>::get_nEntities() const
+{
+  return _nEntities;
+}
+
+/** Get the number of components per entity
+ *
+ * @return nComponents
+ */
+template<typename T>
+inline size_t
+TimeEnvelope<T>::get_nComponents() const
+{
+  return _nComponents;
+}
+
+/** Add the values of an entity at a state
+ *
+ * @param _iEntity : index of the entity
+ * @param _iState : index of the state
+ * @param _values : nComponents values
+ *
+ * Different entities may be added from different threads.
+ */
+template<typename T>
+inline void
+TimeEnvelope<T>::add(size_t _iEntity, size_t _iState, const T* _values)
+{
+  if (_iEntity >= _nEntities)
+    throw(std::invalid_argument("Entity index " + std::to_string(_iEntity) +
+                                " exceeds the size of the envelope " +
+                                std::to_string(_nEntities) + "."));
+
+  const size_t offset = _iEntity * _nComponents;
+  T* max = _max->get_data().data() + offset;
+  T* min = _min->get_data().data() + offset;
+  int32_t* max_state = _max_state->get_data().data() + offset;
+  int32_t* min_state = _min_state->get_data().data() + offset;
+  const auto iState = static_cast<int32_t>(_iState);
+
+  for (size_t iComponent = 0; iComponent < _nComponents; ++iComponent) {
+    const T value = _values[iComponent];
+    if (max_state[iComponent] < 0 || value > max[iComponent]) {
+      max[iComponent] = value;
+      max_state[iComponent] = iState;
+    }
+    if (min_state[iComponent] < 0 || value < min[iComponent]) {
+      min[iComponent] = value;
+      min_state[iComponent] = iState;
+    }
+  }
+}
+
+/** Add the values of all entities at a state
+ *
+ * @param _iState : index of the state
+ * @param _values : (nEntities x nComponents) values
+ */
+template<typename T>
+void
+TimeEnvelope<T>::add_state(size_t _iState, const T* _values)
+{
+  for (size_t iEntity = 0; iEntity < _nEntities; ++iEntity)
+    add(iEntity, _iState, _values + iEntity * _nComponents);
+}
+
+/** Get the maximum values over time
+ *
+ * @return max : (nEntities x nComponents)
+ */
+template<typename T>
+inline Tensor_ptr<T>
+TimeEnvelope<T>::get_max() const
+{
+  return _max;
+}
+
+/** Get the minimum values over time
+ *
+ * @return min : (nEntities x nComponents)
+ */
+template<typename T>
+inline Tensor_ptr<T>
+TimeEnvelope<T>::get_min() const
+{
+  return _min;
+}
+
+/** Get the state indexes of the maximum values
+ *
+ * @return max_state : (nEntities x nComponents), -1 if no data
+ */
+template<typename T>
+inline Tensor_ptr<int32_t>
+TimeEnvelope<T>::get_max_state() const
+{
+  return _max_state;
+}
+
+/** Get the state indexes of the minimum values
+ *
+ * @return min_state : (nEntities x nComponents), -1 if no data
+ */
+template<typename T>
+inline Tensor_ptr<int32_t>
+TimeEnvelope<T>::get_min_state() const
+{
+  return _min_state;
+}
+
+} // namespace qd
+
+#endif
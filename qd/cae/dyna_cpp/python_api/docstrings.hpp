@@ -2,6 +2,240 @@
 #ifndef QD_DOCSTRINGS_HPP
 #define QD_DOCSTRINGS_HPP
 
+/* --------------------- TENSOR --------------------- */
+const char* tensor_view_docs = R"qddoc(
+    view()
+
+    Get a strided view on the entire tensor.
+
+    Returns
+    -------
+    view : TensorView
+        view sharing the memory of the tensor
+
+    Notes
+    -----
+        The view keeps the tensor alive and supports the buffer
+        protocol, thus ``np.asarray(view)`` does not copy any data.
+        The view itself stores an offset and thus stays valid if the
+        tensor is resized, arrays taken from it before do not.
+)qddoc";
+
+const char* tensor_view_init_docs = R"qddoc(
+    TensorView(array)
+
+    Create a strided view on an array.
+
+    Parameters
+    ----------
+    array : np.ndarray
+        array to view. Arrays returned by the library are shared,
+        other arrays are copied once.
+
+    Examples
+    --------
+        >>> stress = d3plot.get_element_stress()
+        >>> view = TensorView_f32(stress).select(1, 0)
+        >>> np.asarray(view).shape
+        (4696, 6)
+)qddoc";
+
+const char* tensor_view_slice_docs = R"qddoc(
+    slice(axis, start, stop, step=1)
+
+    Slice the view along an axis without copying.
+
+    Parameters
+    ----------
+    axis : int
+        axis to slice
+    start : int
+        first index taken
+    stop : int
+        index behind the last index taken
+    step : int
+        step between indexes
+
+    Returns
+    -------
+    view : TensorView
+        view of the slice
+)qddoc";
+
+const char* tensor_view_select_docs = R"qddoc(
+    select(axis, index)
+
+    Select a single index along an axis without copying. The
+    axis is removed from the view.
+
+    Parameters
+    ----------
+    axis : int
+        axis to select from
+    index : int
+        index to select
+
+    Returns
+    -------
+    view : TensorView
+        view with one dimension less
+
+    Examples
+    --------
+        Get the last state of a (nElems x nTimesteps x 6) tensor
+
+        >>> last_state = np.asarray(view.select(1, n_timesteps - 1))
+)qddoc";
+
+const char* tensor_view_insert_axis_docs = R"qddoc(
+    insert_axis(axis)
+
+    Insert an axis of size 1 without copying, e.g. to broadcast
+    over the states.
+
+    Parameters
+    ----------
+    axis : int
+        position of the new axis
+
+    Returns
+    -------
+    view : TensorView
+        view with one dimension more
+)qddoc";
+
+const char* tensor_view_sum_docs = R"qddoc(
+    sum(axis)
+
+    Sum the view along an axis.
+
+    Parameters
+    ----------
+    axis : int
+        axis to reduce, which is removed
+
+    Returns
+    -------
+    result : np.ndarray
+        new array in the type of the view
+
+    Notes
+    -----
+        Broadcasted axes from ``insert_axis`` are reduced without
+        copying the view first.
+)qddoc";
+
+const char* tensor_view_mean_docs = R"qddoc(
+    mean(axis)
+
+    Average the view along an axis.
+
+    Parameters
+    ----------
+    axis : int
+        axis to reduce, which is removed
+
+    Returns
+    -------
+    result : np.ndarray
+        new array in the type of the view, thus integer views are
+        rounded towards zero
+)qddoc";
+
+const char* tensor_view_max_docs = R"qddoc(
+    max(axis)
+
+    Maximum of the view along an axis.
+
+    Parameters
+    ----------
+    axis : int
+        axis to reduce, which is removed
+
+    Returns
+    -------
+    result : np.ndarray
+        new array in the type of the view
+
+    Examples
+    --------
+        Largest stress components over time
+
+        >>> stress = TensorView_f32(d3plot.get_element_stress())
+        >>> stress.max(1).shape
+        (4696, 6)
+)qddoc";
+
+const char* tensor_view_min_docs = R"qddoc(
+    min(axis)
+
+    Minimum of the view along an axis.
+
+    Parameters
+    ----------
+    axis : int
+        axis to reduce, which is removed
+
+    Returns
+    -------
+    result : np.ndarray
+        new array in the type of the view
+)qddoc";
+
+/* ----------------- TIME ENVELOPE ----------------- */
+const char* time_envelope_docs = R"qddoc(
+    Minimum and maximum of a result over all states
+
+    The states are reduced one after another, thus the time history
+    of the result does not need to be in memory. All arrays have the
+    shape (nEntities x nComponents), e.g. nodes or elements times the
+    components of the result. Entities without the result have the
+    state -1 and a value of 0.
+
+    The arrays share the memory of the envelope and are read-only,
+    use ``np.array(envelope.get_max())`` for a writable copy.
+)qddoc";
+
+const char* time_envelope_get_max_docs = R"qddoc(
+    get_max()
+
+    Returns
+    -------
+    max : np.ndarray
+        maximum values over time (nEntities x nComponents)
+)qddoc";
+
+const char* time_envelope_get_min_docs = R"qddoc(
+    get_min()
+
+    Returns
+    -------
+    min : np.ndarray
+        minimum values over time (nEntities x nComponents)
+)qddoc";
+
+const char* time_envelope_get_max_state_docs = R"qddoc(
+    get_max_state()
+
+    Returns
+    -------
+    max_state : np.ndarray
+        index of the state in which the maximum occurred
+
+    Examples
+    --------
+        >>> time_of_max = d3plot.get_timesteps()[envelope.get_max_state()]
+)qddoc";
+
+const char* time_envelope_get_min_state_docs = R"qddoc(
+    get_min_state()
+
+    Returns
+    -------
+    min_state : np.ndarray
+        index of the state in which the minimum occurred
+)qddoc";
+
 /* --------------------- NODE --------------------- */
 const char* qd_node_class_docs = R"qddoc(
 
@@ -71,6 +305,26 @@ const char* node_get_coords_docs = R"qddoc(
         (34L, 3L)
 )qddoc";
 
+const char* node_set_coords_docs = R"qddoc(
+    set_coords(x, y, z)
+
+    Move the node to new geometric coordinates. A KeyFile
+    containing the node will rewrite its node card on the next
+    incremental save.
+
+    Parameters
+    ----------
+    x : float
+    y : float
+    z : float
+
+    Examples
+    --------
+        >>> kf = KeyFile("path/to/keyfile", load_mesh=True)
+        >>> kf.get_nodeByID(1).set_coords(0., 1., 2.)
+        >>> kf.save_incremental("path/to/keyfile")
+)qddoc";
+
 const char* node_get_disp_docs = R"qddoc(
     get_disp()
 
@@ -436,6 +690,23 @@ const char* element_get_node_ids_docs = R"qddoc(
 )qddoc";
 
 /* ----------------------- PART ---------------------- */
+const char* part_set_name_docs = R"qddoc(
+    set_name(name)
+
+    Rename the part. A KeyFile containing the part will rewrite its
+    part card on the next incremental save.
+
+    Parameters
+    ----------
+    name : str
+        new name of the part
+
+    Examples
+    --------
+        >>> kf = KeyFile("path/to/keyfile", load_mesh=True)
+        >>> kf.get_partByID(1).set_name("PLATE_D")
+)qddoc";
+
 const char* part_get_id_docs = R"qddoc(
     get_id()
 
@@ -667,6 +938,37 @@ const char* part_get_element_ids_docs = R"qddoc(
         >>> # oops no beams :P
 )qddoc";
 
+const char* part_get_element_results_docs = R"qddoc(
+    get_element_results(result_name, element_filter = Element.none, timesteps=[])
+
+    Get a result of the elements belonging to the part.
+
+    Parameters
+    ----------
+    result_name : str
+        one of: energy, stress_mises, plastic_strain, strain, stress,
+        history_vars
+    element_filter : Element.type
+        optional filter for elements
+    timesteps : list of int
+        indexes of the timesteps, negative ones count from the end.
+        All timesteps are taken if empty.
+
+    Returns
+    -------
+    field : np.ndarray
+        result of the elements (nElems x nTimesteps) for energy,
+        stress_mises and plastic_strain, else always
+        (nElems x nTimesteps x nComponents)
+
+    Examples
+    --------
+        >>> d3plot = D3plot("path/to/d3plot", read_states="stress_mises max")
+        >>> part = d3plot.get_partByID(1)
+        >>> part.get_element_results("stress_mises", timesteps=[-1]).shape
+        (9631, 1)
+)qddoc";
+
 /* ----------------------- DB_NODES ---------------------- */
 const char* dbnodes_description = R"qddoc(
 
@@ -771,17 +1073,48 @@ const char* dbnodes_get_nNodes_docs = R"qddoc(
 )qddoc";
 
 const char* dbnodes_get_node_coords_docs = R"qddoc(
-    get_node_coords()
+    get_node_coords(states=[])
+
+    Parameters
+    ----------
+    states : list(int)
+        indexes of the states to get, all by default
 
     Returns
     -------
     node_coords : np.ndarray
-        coordinates of all nodes
+        coordinates of all nodes with shape (nNodes x nStates x 3)
+
+    Raises
+    ------
+    ValueError
+        if a state index is out of range
+    RuntimeError
+        if the coordinate block does not match the number of nodes
+
+    Notes
+    -----
+        The coordinates are computed from the displacements of the
+        nodes. Reading ``read_states("coords")`` instead stores the
+        coordinates of all states in one block, which is faster. The
+        block holds the coordinates as written by LS-Dyna, whereas the
+        displacement path adds the initial position to the displacement,
+        so both may differ by rounding (up to about 7.6e-6 for
+        coordinates around 30). The nodes themselves do not receive
+        anything from the block, ``node.get_disp()`` stays empty and
+        ``node.get_coords()`` only returns the initial position. Without
+        either, there is only the initial position.
 
     Examples
     --------
         >>> d3plot.get_node_coords().shape
-        (4915, 3)
+        (4915, 1, 3)
+        >>> d3plot.read_states("coords")
+        >>> d3plot.get_node_coords().shape
+        (4915, 32, 3)
+        >>> # first and last state only
+        >>> d3plot.get_node_coords(states=[0, 31]).shape
+        (4915, 2, 3)
 )qddoc";
 
 const char* dbnodes_get_node_velocity_docs = R"qddoc(
@@ -812,6 +1145,35 @@ const char* dbnodes_get_node_acceleration_docs = R"qddoc(
         (4915,1,3)
 )qddoc";
 
+const char* dbnodes_get_node_result_envelope_docs = R"qddoc(
+    get_node_result_envelope(result_name)
+
+    Get the minimum and maximum of the vector length of a node
+    result over time.
+
+    Parameters
+    ----------
+    result_name : str
+        disp, vel or accel
+
+    Returns
+    -------
+    envelope : TimeEnvelope
+        arrays of shape (nNodes x 1)
+
+    Notes
+    -----
+        The displacement is measured from the initial position. The
+        states are reduced one after another, no array with the entire
+        time history is created.
+
+    Examples
+    --------
+        >>> d3plot = D3plot("path/to/d3plot", read_states="disp")
+        >>> envelope = d3plot.get_node_result_envelope("disp")
+        >>> peak_disp = envelope.get_max()[:, 0]
+)qddoc";
+
 const char* dbnodes_get_node_ids_docs = R"qddoc(
     get_node_ids()
 
@@ -1157,6 +1519,82 @@ const char* dbelems_get_element_stress = R"qddoc(
 
 )qddoc";
 
+const char* dbelems_get_element_stress_invariants = R"qddoc(
+    get_element_stress_invariants(element_filter, timesteps=[])
+
+    Parameters
+    ----------
+    element_filter : Element.type
+        optional type for filtering
+    timesteps : list of int
+        indexes of the timesteps, negative ones count from the end.
+        All timesteps are taken if empty.
+
+    Returns
+    -------
+    field : np.ndarray
+        stress invariants of the elements (nElems x nTimesteps x 7)
+
+    Notes
+    -----
+        The last axis contains in this order: mises stress, pressure
+        (positive in compression), triaxiality, the principal stresses
+        in descending order and the lode parameter (1 in tension, -1 in
+        compression). Triaxiality and lode parameter are 0 if there is
+        no deviatoric stress. Elements without stress are treated as
+        having zero stress. The invariants are computed in one pass
+        from the stress array.
+
+        The invariants are not stored but computed on every call. Pass
+        the timesteps needed instead of computing the full history
+        repeatedly.
+
+    Examples
+    --------
+        >>> d3plot = D3plot("path/to/d3plot", read_states="stress max")
+        >>> invariants = d3plot.get_element_stress_invariants(Element.shell)
+        >>> invariants.shape
+        (4969, 32, 7)
+        >>> triaxiality = invariants[:, -1, 2]
+        >>> # only the last state
+        >>> d3plot.get_element_stress_invariants(Element.shell, [-1]).shape
+        (4969, 1, 7)
+
+)qddoc";
+
+const char* dbelems_get_element_result_envelope_docs = R"qddoc(
+    get_element_result_envelope(result_name, element_filter)
+
+    Get the minimum and maximum of an element result over time.
+
+    Parameters
+    ----------
+    result_name : str
+        energy, stress_mises, plastic_strain, strain, stress or
+        history_vars
+    element_filter : Element.type
+        optional type for filtering
+
+    Returns
+    -------
+    envelope : TimeEnvelope
+        arrays of shape (nElems x nComponents)
+
+    Notes
+    -----
+        The states are reduced element by element, no array with the
+        entire time history is created. Every component is reduced on
+        its own.
+
+    Examples
+    --------
+        >>> d3plot = D3plot("path/to/d3plot", read_states="plastic_strain max")
+        >>> envelope = d3plot.get_element_result_envelope(
+        ...     "plastic_strain", Element.shell)
+        >>> max_plastic_strain = envelope.get_max()[:, 0]
+        >>> time_of_max = d3plot.get_timesteps()[envelope.get_max_state()[:, 0]]
+)qddoc";
+
 const char* dbelems_get_element_strain = R"qddoc(
     get_element_strain(element_filter)
 
@@ -1249,6 +1687,79 @@ const char* dbelems_get_element_history_vars = R"qddoc(
 
 )qddoc";
 
+const char* dbelems_get_element_resultsByID_docs = R"qddoc(
+    get_element_resultsByID(result_name, element_type, ids, timesteps=[])
+
+    Parameters
+    ----------
+    result_name : str
+        one of: energy, stress_mises, plastic_strain, strain, stress,
+        history_vars
+    element_type : Element.type
+        type of the elements
+    ids : np.ndarray or list of int
+        ids of the elements
+    timesteps : list of int
+        indexes of the timesteps, negative ones count from the end.
+        All timesteps are taken if empty.
+
+    Returns
+    -------
+    field : np.ndarray
+        result of the elements (nElems x nTimesteps) for energy,
+        stress_mises and plastic_strain, else always
+        (nElems x nTimesteps x nComponents)
+
+    Notes
+    -----
+        The array is filled in one go, no Element objects are created.
+        If an element does not have the respective result, 0 is set as
+        default value.
+
+    Examples
+    --------
+        >>> d3plot = D3plot("path/to/d3plot", read_states="stress mean")
+        >>> d3plot.get_nTimesteps()
+        32
+        >>> d3plot.get_element_resultsByID("stress", Element.shell,
+        ...                                [1, 5, 7], [0, -1]).shape
+        (3, 2, 6)
+
+)qddoc";
+
+const char* dbelems_get_element_resultsByIndex_docs = R"qddoc(
+    get_element_resultsByIndex(result_name, element_type, indexes, timesteps=[])
+
+    Parameters
+    ----------
+    result_name : str
+        one of: energy, stress_mises, plastic_strain, strain, stress,
+        history_vars
+    element_type : Element.type
+        type of the elements
+    indexes : np.ndarray or list of int
+        indexes of the elements
+    timesteps : list of int
+        indexes of the timesteps, negative ones count from the end.
+        All timesteps are taken if empty.
+
+    Returns
+    -------
+    field : np.ndarray
+        result of the elements (nElems x nTimesteps) for energy,
+        stress_mises and plastic_strain, else always
+        (nElems x nTimesteps x nComponents)
+
+    Examples
+    --------
+        >>> d3plot = D3plot("path/to/d3plot", read_states="plastic_strain")
+        >>> d3plot.get_element_resultsByIndex("plastic_strain",
+        ...                                   Element.shell,
+        ...                                   np.arange(100)).shape
+        (100, 32)
+
+)qddoc";
+
 /* ----------------------- DB_PARTS ---------------------- */
 const char* dbparts_description = R"qddoc(
 
@@ -1482,6 +1993,88 @@ const char* d3plot_get_title_docs = R"qddoc(
         "Barrier Impact"
 )qddoc";
 
+const char* d3plot_get_shell_layer_results_docs = R"qddoc(
+    get_shell_layer_results()
+
+    Get the results of every integration layer of the shells, which
+    are not reduced by a mode.
+
+    Returns
+    -------
+    layer_results : np.ndarray
+        shape (nTimesteps x nShells x nLayers x nLayerVars)
+
+    Raises
+    ------
+    ValueError
+        if the layers were not read with ``read_states("shell_layers")``
+
+    Notes
+    -----
+        The layer variables are in this order the stresses (xx, yy, zz,
+        xy, yz, xz), the plastic strain and the history variables, as
+        far as they are present in the file. Rigid shells have no
+        results and are 0.
+
+        If the layers were read with a compact precision, such as
+        ``read_states("shell_layers int8")``, they are converted to
+        float in a new array on every call.
+
+        The array shares the memory of the file and is read-only,
+        use ``np.array(layers)`` for a writable copy.
+
+    Examples
+    --------
+        >>> d3plot = D3plot("path/to/d3plot", read_states="shell_layers")
+        >>> layers = d3plot.get_shell_layer_results()
+        >>> layers.shape
+        (32, 4696, 3, 7)
+        >>> # max stress xx over layers of the last state
+        >>> layers[-1, :, :, 0].max(axis=1)
+)qddoc";
+
+const char* d3plot_get_result_envelope_docs = R"qddoc(
+    get_result_envelope(result_name, element_type=Element.none)
+
+    Get a result, which was reduced over time during reading.
+
+    Parameters
+    ----------
+    result_name : str
+        disp, vel, accel, stress_mises, stress, plastic_strain, strain
+        or energy
+    element_type : Element.type
+        type of the elements, none for node results
+
+    Returns
+    -------
+    envelope : TimeEnvelope
+        arrays of shape (nNodes x 1) or (nElems x nComponents)
+
+    Raises
+    ------
+    ValueError
+        if the result was not read with ``read_states("<name> envelope")``
+
+    Notes
+    -----
+        The time history of a result read as envelope is never stored,
+        the elements and nodes have no data for it. Node results are
+        reduced to the length of the vector, the displacement is measured
+        from the initial position.
+
+    Examples
+    --------
+        >>> d3plot = D3plot("path/to/d3plot",
+        ...                 read_states=["plastic_strain max envelope",
+        ...                              "disp envelope"])
+        >>> envelope = d3plot.get_result_envelope("plastic_strain",
+        ...                                       Element.shell)
+        >>> envelope.get_max().shape
+        (4696, 1)
+        >>> peak_disp = d3plot.get_result_envelope("disp").get_max()
+)qddoc";
+
 const char* d3plot_get_timesteps_docs = R"qddoc(
     get_timesteps()
 
@@ -1531,6 +2124,8 @@ const char* d3plot_read_states_docs = R"qddoc(
         variables available are:
         
         * disp (displacement)
+        * coords [(optional) precision] (coordinates of all nodes as one
+          block, see get_node_coords)
         * vel (velocity)
         * accel (acceleration)
         * strain [(optional) mode]
@@ -1538,6 +2133,19 @@ const char* d3plot_read_states_docs = R"qddoc(
         * stress_mises [(optional) mode]
         * plastic_strain [(optional) mode]
         * history [id1] [id2] [shell or solid] [(optional) mode]
+        * shell_layers [(optional) precision] (raw layer results, see
+          get_shell_layer_results)
+        
+        The raw layers and the coordinate block can be stored compactly
+        with the precision ``float16`` (half floats) or ``int16`` and
+        ``int8`` (fixed-point with a scale per state and layer variable
+        or axis). They are converted back to float when requested. An
+        unknown precision raises a ValueError.
+        
+        Adding ``envelope`` to disp, vel, accel or an element result
+        except history reduces it to its minimum and maximum over time
+        while reading, see get_result_envelope. The time history is not
+        stored then.
         
         There is an optional mode for the element results. The results are 
         only given at the center of an element. Since shell elements
@@ -1545,7 +2153,7 @@ const char* d3plot_read_states_docs = R"qddoc(
         treatment of these layers:
         
         * inner (first layer)
-        * mid (middle)
+        * mid (middle, mean of the two middle layers if even)
         * outer (last layer)
         * mean
         * max
@@ -1565,6 +2173,10 @@ const char* d3plot_read_states_docs = R"qddoc(
         >>> d3plot.read_states(["disp","vel","stress_mises max","shell history 1 mean"])
         >>> # most efficient way, load the results directly when opening
         >>> D3plot("path/to/d3plot", read_states=["disp","vel","plastic_strain max"])
+        >>> # only the peak over time, saves the memory of the history
+        >>> d3plot.read_states("plastic_strain max envelope")
+        >>> # raw layers with half the memory
+        >>> d3plot.read_states("shell_layers float16")
 )qddoc";
 
 const char* d3plot_clear_docs = R"qddoc(
@@ -1590,7 +2202,9 @@ const char* d3plot_clear_docs = R"qddoc(
         * history [(optional) shell or solid]
         
         The specification of shell or solid for history is optional. Deletes
-        all history variables if none given.
+        all history variables if none given. Adding ``envelope`` deletes
+        the envelope of the result instead, ``envelope`` alone deletes all
+        envelopes.
 
     Examples
     --------
@@ -1783,6 +2397,34 @@ const char* rawd3plot_get_float_data_docs = R"qddoc(
     >>> # 12 timesteps, 4969 elements and 24 variables
 )qddoc";
 
+const char* rawd3plot_get_raw_data_envelope_docs = R"qddoc(
+    get_raw_data_envelope(name)
+
+    Get the minimum and maximum of a state array over time.
+
+    Parameters
+    ----------
+    name : str
+        name of a float array with the states as first axis
+
+    Returns
+    -------
+    envelope : TimeEnvelope
+        arrays of shape (nEntities x nComponents)
+
+    Notes
+    -----
+        The second axis are the entities, e.g. elements, all further
+        axes are flattened into the components. The states are reduced
+        one after another without temporary arrays.
+
+    Examples
+    --------
+    >>> envelope = raw_d3plot.get_raw_data_envelope("elem_shell_results")
+    >>> envelope.get_max().shape
+    (4696, 24)
+)qddoc";
+
 const char* rawd3plot_info_docs = R"qddoc(
     info()
 
@@ -1927,6 +2569,76 @@ const char* keyfile_keys_description = R"qddoc(
         ['*BOUNDARY_SPC_SET_ID', '*PART_CONTACT', '*NODE', ...]
 )qddoc";
 
+const char* keyfile_find_keywords_description = R"qddoc(
+    find_keywords(pattern="*", search_includes=True)
+
+    Parameters
+    ----------
+    pattern : str
+        wildcard pattern for keyword names, '*' matches any chars
+        and '?' a single char. The leading '*' of a keyword name is
+        not treated as wildcard. Matching ignores the case.
+    search_includes : bool
+        whether to search loaded includes too
+
+    Returns
+    -------
+    keywords : list of Keyword
+        matching keywords in the order of the file, keywords of includes
+        are placed behind their include keyword
+
+    Examples
+    --------
+        >>> keyfile = KeyFile("path/to/keyfile.key", load_includes=True)
+        >>> # all materials in the deck
+        >>> keyfile.find_keywords("*MAT_*")
+        [<Keyword: *MAT_ELASTIC>, <Keyword: *MAT_PIECEWISE_LINEAR_PLASTICITY>]
+)qddoc";
+
+const char* keyfile_find_keywords_by_prefix_description = R"qddoc(
+    find_keywords_by_prefix(prefix, search_includes=True)
+
+    Parameters
+    ----------
+    prefix : str
+        start of the keyword names, the case is ignored
+    search_includes : bool
+        whether to search loaded includes too
+
+    Returns
+    -------
+    keywords : list of Keyword
+        matching keywords in the order of the file
+
+    Examples
+    --------
+        >>> keyfile = KeyFile("path/to/keyfile.key")
+        >>> keyfile.find_keywords_by_prefix("*SECTION")
+        [<Keyword: *SECTION_SHELL>, <Keyword: *SECTION_SOLID>]
+)qddoc";
+
+const char* keyfile_find_keywords_by_type_description = R"qddoc(
+    find_keywords_by_type(keyword_type, search_includes=True)
+
+    Parameters
+    ----------
+    keyword_type : Keyword.keyword_type
+        type of the keywords
+    search_includes : bool
+        whether to search loaded includes too
+
+    Returns
+    -------
+    keywords : list of Keyword
+        matching keywords in the order of the file
+
+    Examples
+    --------
+        >>> keyfile = KeyFile("path/to/keyfile.key", parse_mesh=True)
+        >>> keyfile.find_keywords_by_type(Keyword.keyword_type.node)
+        [<Keyword: *NODE>]
+)qddoc";
+
 const char* keyfile_save_description = R"qddoc(
     keys()
 
@@ -1949,6 +2661,47 @@ const char* keyfile_save_description = R"qddoc(
         
 )qddoc";
 
+const char* keyfile_save_incremental_description = R"qddoc(
+    save_incremental(filepath="", save_includes=True)
+
+    Parameters
+    ----------
+    filepath : str
+        path for the output file, overwrites the loaded file if empty
+    save_includes : bool
+        whether to save modified includes (into their own files)
+
+    Raises
+    ------
+    RuntimeError
+        if the output file can not be written
+
+    Notes
+    -----
+        Only keywords which were modified are written again, all
+        others are copied byte by byte from the loaded file. Files
+        without modifications are not touched at all.
+
+    Examples
+    --------
+        >>> keyfile = KeyFile("path/to/keyfile.key", read_keywords=True)
+        >>> keyfile["*PART"][0]["pid"] = 2
+        >>> # rewrites only the part keyword
+        >>> keyfile.save_incremental()
+        
+)qddoc";
+
+const char* keyfile_is_modified_description = R"qddoc(
+    is_modified()
+
+    Returns
+    -------
+    is_modified : bool
+        whether keywords were changed, added or removed since loading
+        or saving (includes are not considered)
+
+)qddoc";
+
 const char* keyfile_remove_keyword_description = R"qddoc(
     remove_keyword(name, index)
 
@@ -2117,6 +2870,20 @@ const char* keyword_enum_align_docs = R"qddoc(
         >>> Keyword.field_alignment = Keyword.align.middle
 )qddoc";
 
+const char* keyword_enum_keyword_type_docs = R"qddoc(
+    Type of a keyword:
+     - generic
+     - node
+     - element
+     - part
+     - include_path
+     - include
+
+    Examples
+    --------
+        >>> keyfile.find_keywords_by_type(Keyword.keyword_type.part)
+)qddoc";
+
 const char* keyword_constructor_docs = R"qddoc(
     Keyword(lines, position=0)
 
@@ -16,6 +16,9 @@
 #include <dyna_cpp/dyna/keyfile/NodeKeyword.hpp>
 #include <dyna_cpp/dyna/keyfile/PartKeyword.hpp>
 #include <dyna_cpp/math/Tensor.hpp>
+#include <dyna_cpp/math/TensorExpression.hpp>
+#include <dyna_cpp/math/TensorView.hpp>
+#include <dyna_cpp/math/TimeEnvelope.hpp>
 #include <dyna_cpp/utility/FileUtility.hpp>
 #include <dyna_cpp/utility/PythonUtility.hpp>
 #include <dyna_cpp/utility/TextUtility.hpp>
@@ -61,6 +64,129 @@ shape_to_strides(const std::vector<size_t>& shape)
   return std::move(strides);
 }
 
+/** Reduces a tensor view along an axis without holding the GIL
+ *
+ * @param view : view to reduce
+ * @param reduction : function reducing the expression of the view
+ * @return array : numpy array of the result
+ */
+template<typename T, typename F>
+pybind11::object
+reduce_tensor_view(const qd::TensorView<T>& view, F reduction)
+{
+  qd::Tensor_ptr<T> tensor;
+  {
+    pybind11::gil_scoped_release release;
+    tensor = reduction(qd::as_expression(view));
+  }
+  return qd::py::tensor_to_nparray(tensor);
+}
+
+/** Binds a strided tensor view of the given type
+ *
+ * @param m : module to add the class to
+ * @param name : python name of the class
+ * @param tensor_py : python class of the viewed tensor
+ *
+ * The buffer protocol hands out the view strides, thus numpy arrays
+ * created from a view share memory with the owning tensor.
+ */
+template<typename T>
+void
+bind_tensor_view(
+  pybind11::module& m,
+  const char* name,
+  pybind11::class_<qd::Tensor<T>, std::shared_ptr<qd::Tensor<T>>>& tensor_py)
+{
+  using qd::TensorView;
+
+  pybind11::class_<TensorView<T>>(m, name, pybind11::buffer_protocol())
+    .def("__init__",
+         [](TensorView<T>& instance,
+            pybind11::array_t<T,
+                              pybind11::array::c_style |
+                                pybind11::array::forcecast> _array) {
+           new (&instance) TensorView<T>(qd::py::nparray_to_tensor<T>(_array));
+         },
+         "array"_a,
+         tensor_view_init_docs)
+    .def_buffer([](TensorView<T>& m) -> pybind11::buffer_info {
+      std::vector<size_t> strides(m.get_strides());
+      for (auto& stride : strides)
+        stride *= sizeof(T);
+
+      return pybind11::buffer_info(
+        m.data(),                                     // Pointer to buffer
+        (pybind11::ssize_t)sizeof(T),                 // Size of one scalar
+        pybind11::format_descriptor<T>::format(),     // Python struct-style
+        static_cast<pybind11::ssize_t>(m.ndim()),     // Number of dims
+        m.get_shape(),                                // Buffer dimensions
+        strides // Strides (in bytes) for each index
+      );
+    })
+    .def("shape", &TensorView<T>::get_shape)
+    .def("strides", &TensorView<T>::get_strides)
+    .def("is_contiguous", &TensorView<T>::is_contiguous)
+    .def("slice",
+         &TensorView<T>::slice,
+         "axis"_a,
+         "start"_a,
+         "stop"_a,
+         "step"_a = 1,
+         tensor_view_slice_docs)
+    .def("select",
+         &TensorView<T>::select,
+         "axis"_a,
+         "index"_a,
+         tensor_view_select_docs)
+    .def("insert_axis",
+         &TensorView<T>::insert_axis,
+         "axis"_a,
+         tensor_view_insert_axis_docs)
+    .def("copy", &TensorView<T>::copy)
+    .def("sum",
+         [](const TensorView<T>& self, size_t axis) {
+           return reduce_tensor_view(
+             self, [axis](const qd::TensorOperand<T>& expression) {
+               return qd::reduce_sum(expression, axis);
+             });
+         },
+         "axis"_a,
+         tensor_view_sum_docs)
+    .def("mean",
+         [](const TensorView<T>& self, size_t axis) {
+           return reduce_tensor_view(
+             self, [axis](const qd::TensorOperand<T>& expression) {
+               return qd::reduce_mean(expression, axis);
+             });
+         },
+         "axis"_a,
+         tensor_view_mean_docs)
+    .def("max",
+         [](const TensorView<T>& self, size_t axis) {
+           return reduce_tensor_view(
+             self, [axis](const qd::TensorOperand<T>& expression) {
+               return qd::reduce_max(expression, axis);
+             });
+         },
+         "axis"_a,
+         tensor_view_max_docs)
+    .def("min",
+         [](const TensorView<T>& self, size_t axis) {
+           return reduce_tensor_view(
+             self, [axis](const qd::TensorOperand<T>& expression) {
+               return qd::reduce_min(expression, axis);
+             });
+         },
+         "axis"_a,
+         tensor_view_min_docs);
+
+  tensor_py.def(
+    "view",
+    [](std::shared_ptr<qd::Tensor<T>> self) { return TensorView<T>(self); },
+    tensor_view_docs);
+}
+
 /*
 namespace pybind11 {
 namespace detail {
@@ -142,6 +268,81 @@ auto cast_kw = [](std::shared_ptr<Keyword> instance) {
   }
 };
 
+/* Locks the results of a file while holding the GIL
+ *
+ * read_states and clear of other threads run without the GIL, thus
+ * result getters must hold the state lock.
+ */
+class StateLock
+{
+private:
+  std::lock_guard<std::recursive_mutex> lock;
+
+public:
+  explicit StateLock(FEMFile* _femfile)
+    : lock(_femfile->get_state_mutex())
+  {}
+};
+
+/* Releases the GIL and locks the results of a file
+ *
+ * The GIL is released first, like read_states does, so that a
+ * thread holding the GIL never waits for a thread waiting for it.
+ */
+class ReleasedStateLock
+{
+private:
+  pybind11::gil_scoped_release release;
+  std::lock_guard<std::recursive_mutex> lock;
+
+public:
+  explicit ReleasedStateLock(FEMFile* _femfile)
+    : lock(_femfile->get_state_mutex())
+  {}
+};
+
+#ifdef QD_USE_C_BINOUT
+/* Read binout data without holding the GIL (reading is thread-safe) */
+template<typename T>
+pybind11::object
+binout_read_variable(std::shared_ptr<Binout> _binout, const std::string& _path)
+{
+  Tensor_ptr<T> tensor;
+  {
+    pybind11::gil_scoped_release release;
+    tensor = _binout->read_variable<T>(_path);
+  }
+  return py::tensor_to_nparray(tensor);
+}
+
+template<typename T>
+pybind11::object
+binout_read_variable_series(std::shared_ptr<Binout> _binout,
+                            const std::string& _path_pattern,
+                            const std::vector<int64_t>& _ids)
+{
+  Tensor_ptr<T> tensor;
+  {
+    pybind11::gil_scoped_release release;
+    tensor = _ids.empty()
+               ? _binout->read_variable_series<T>(_path_pattern)
+               : _binout->read_variable_series<T>(_path_pattern, _ids);
+  }
+  return py::tensor_to_nparray(tensor);
+}
+
+template<typename T>
+size_t
+binout_read_variable_into(std::shared_ptr<Binout> _binout,
+                          const std::string& _path,
+                          const pybind11::buffer_info& _info)
+{
+  pybind11::gil_scoped_release release;
+  return _binout->read_variable<T>(
+    _path, static_cast<T*>(_info.ptr), _info.size);
+}
+#endif
+
 // template<typename T>
 // pybind11::array_t<T> f
 
@@ -359,6 +560,36 @@ PYBIND11_PLUGIN(dyna_cpp)
     .def("print", &Tensor<uint64_t>::print)
     .def("shape", &Tensor<uint64_t>::get_shape);
 
+  // Views
+  bind_tensor_view<float>(m, "TensorView_f32", tensor_f32_py);
+  bind_tensor_view<double>(m, "TensorView_f64", tensor_f64_py);
+  bind_tensor_view<int32_t>(m, "TensorView_int32", tensor_i32_py);
+  bind_tensor_view<int64_t>(m, "TensorView_int64", tensor_i64_py);
+
+  // Reductions over time
+  pybind11::class_<TimeEnvelope<float>, std::shared_ptr<TimeEnvelope<float>>>(
+    m, "TimeEnvelope", time_envelope_docs)
+    .def("get_max",
+         [](std::shared_ptr<TimeEnvelope<float>> self) {
+           return py::tensor_to_nparray_readonly(self->get_max());
+         },
+         time_envelope_get_max_docs)
+    .def("get_min",
+         [](std::shared_ptr<TimeEnvelope<float>> self) {
+           return py::tensor_to_nparray_readonly(self->get_min());
+         },
+         time_envelope_get_min_docs)
+    .def("get_max_state",
+         [](std::shared_ptr<TimeEnvelope<float>> self) {
+           return py::tensor_to_nparray_readonly(self->get_max_state());
+         },
+         time_envelope_get_max_state_docs)
+    .def("get_min_state",
+         [](std::shared_ptr<TimeEnvelope<float>> self) {
+           return py::tensor_to_nparray_readonly(self->get_min_state());
+         },
+         time_envelope_get_min_state_docs);
+
   /*
   pybind11::class_<Tensor<size_t>, std::shared_ptr<Tensor<size_t>>>
     tensor_size_t_py(m, "Tensor_size_t", pybind11::buffer_protocol());
@@ -400,24 +631,34 @@ PYBIND11_PLUGIN(dyna_cpp)
          node_str_docs)
     .def("get_coords",
          [](std::shared_ptr<Node> _node) {
+           StateLock lock(_node->get_db_nodes()->get_femfile());
            return qd::py::vector_to_nparray(_node->get_coords());
          },
          pybind11::return_value_policy::take_ownership,
          node_get_coords_docs)
+    .def("set_coords",
+         &Node::set_coords,
+         "x"_a,
+         "y"_a,
+         "z"_a,
+         node_set_coords_docs)
     .def("get_disp",
          [](std::shared_ptr<Node> _node) {
+           StateLock lock(_node->get_db_nodes()->get_femfile());
            return qd::py::vector_to_nparray(_node->get_disp());
          },
          pybind11::return_value_policy::take_ownership,
          node_get_disp_docs)
     .def("get_vel",
          [](std::shared_ptr<Node> _node) {
+           StateLock lock(_node->get_db_nodes()->get_femfile());
            return qd::py::vector_to_nparray(_node->get_vel());
          },
          pybind11::return_value_policy::take_ownership,
          node_get_vel_docs)
     .def("get_accel",
          [](std::shared_ptr<Node> _node) {
+           StateLock lock(_node->get_db_nodes()->get_femfile());
            return qd::py::vector_to_nparray(_node->get_accel());
          },
          pybind11::return_value_policy::take_ownership,
@@ -479,42 +720,49 @@ PYBIND11_PLUGIN(dyna_cpp)
          element_str_docs)
     .def("get_coords",
          [](std::shared_ptr<Element> _elem) {
+           StateLock lock(_elem->get_db_elements()->get_femfile());
            return qd::py::vector_to_nparray(_elem->get_coords());
          },
          pybind11::return_value_policy::take_ownership,
          element_get_coords_docs)
     .def("get_energy",
          [](std::shared_ptr<Element> _elem) {
+           StateLock lock(_elem->get_db_elements()->get_femfile());
            return qd::py::vector_to_nparray(_elem->get_energy());
          },
          pybind11::return_value_policy::take_ownership,
          element_get_energy_docs)
     .def("get_stress_mises",
          [](std::shared_ptr<Element> _elem) {
+           StateLock lock(_elem->get_db_elements()->get_femfile());
            return qd::py::vector_to_nparray(_elem->get_stress_mises());
          },
          pybind11::return_value_policy::take_ownership,
          element_get_stress_mises_docs)
     .def("get_plastic_strain",
          [](std::shared_ptr<Element> _elem) {
+           StateLock lock(_elem->get_db_elements()->get_femfile());
            return qd::py::vector_to_nparray(_elem->get_plastic_strain());
          },
          pybind11::return_value_policy::take_ownership,
          element_get_plastic_strain_docs)
     .def("get_strain",
          [](std::shared_ptr<Element> _elem) {
+           StateLock lock(_elem->get_db_elements()->get_femfile());
            return qd::py::vector_to_nparray(_elem->get_strain());
          },
          pybind11::return_value_policy::take_ownership,
          element_get_strain_docs)
     .def("get_stress",
          [](std::shared_ptr<Element> _elem) {
+           StateLock lock(_elem->get_db_elements()->get_femfile());
            return qd::py::vector_to_nparray(_elem->get_stress());
          },
          pybind11::return_value_policy::take_ownership,
          element_get_stress_docs)
     .def("get_history_variables",
          [](std::shared_ptr<Element> _elem) {
+           StateLock lock(_elem->get_db_elements()->get_femfile());
            return qd::py::vector_to_nparray(_elem->get_history_vars());
          },
          pybind11::return_value_policy::take_ownership,
@@ -557,6 +805,7 @@ PYBIND11_PLUGIN(dyna_cpp)
          &Part::get_name,
          pybind11::return_value_policy::take_ownership,
          part_get_name_docs)
+    .def("set_name", &Part::set_name, "name"_a, part_set_name_docs)
     .def("get_id",
          &Part::get_partID,
          pybind11::return_value_policy::take_ownership,
@@ -611,7 +860,24 @@ PYBIND11_PLUGIN(dyna_cpp)
            return py::tensor_to_nparray(self->get_element_ids(element_filter));
          },
          "element_filter"_a = Element::ElementType::NONE,
-         part_get_element_ids_docs);
+         part_get_element_ids_docs)
+    .def("get_element_results",
+         [](std::shared_ptr<Part> self,
+            const std::string& result_name,
+            Element::ElementType element_filter,
+            const std::vector<int64_t>& timesteps) {
+           Tensor_ptr<float> tensor;
+           {
+             ReleasedStateLock lock(self->get_femfile());
+             tensor = self->get_element_results(
+               result_name, element_filter, timesteps);
+           }
+           return py::tensor_to_nparray(tensor);
+         },
+         "result_name"_a,
+         "element_filter"_a = Element::ElementType::NONE,
+         "timesteps"_a = std::vector<int64_t>(),
+         part_get_element_results_docs);
 
   // DB_Nodes
   pybind11::class_<DB_Nodes, std::shared_ptr<DB_Nodes>> db_nodes_py(
@@ -680,26 +946,56 @@ PYBIND11_PLUGIN(dyna_cpp)
          "index"_a,
          pybind11::return_value_policy::reference_internal)
     .def("get_node_coords",
-         [](std::shared_ptr<DB_Nodes> db_nodes) {
-           return py::tensor_to_nparray(db_nodes->get_node_coords());
+         [](std::shared_ptr<DB_Nodes> db_nodes,
+            const std::vector<size_t>& states) {
+           Tensor_ptr<float> tensor;
+           {
+             ReleasedStateLock lock(db_nodes->get_femfile());
+             tensor = db_nodes->get_node_coords(states);
+           }
+           return py::tensor_to_nparray(tensor);
          },
+         "states"_a = std::vector<size_t>(),
          pybind11::return_value_policy::take_ownership,
          dbnodes_get_node_coords_docs)
     .def("get_node_velocity",
          [](std::shared_ptr<DB_Nodes> db_nodes) {
-           return py::tensor_to_nparray(db_nodes->get_node_velocity());
+           Tensor_ptr<float> tensor;
+           {
+             ReleasedStateLock lock(db_nodes->get_femfile());
+             tensor = db_nodes->get_node_velocity();
+           }
+           return py::tensor_to_nparray(tensor);
          },
          pybind11::return_value_policy::take_ownership,
          dbnodes_get_node_velocity_docs)
     .def("get_node_acceleration",
          [](std::shared_ptr<DB_Nodes> db_nodes) {
-           return py::tensor_to_nparray(db_nodes->get_node_acceleration());
+           Tensor_ptr<float> tensor;
+           {
+             ReleasedStateLock lock(db_nodes->get_femfile());
+             tensor = db_nodes->get_node_acceleration();
+           }
+           return py::tensor_to_nparray(tensor);
          },
          pybind11::return_value_policy::take_ownership,
          dbnodes_get_node_acceleration_docs)
+    .def("get_node_result_envelope",
+         [](std::shared_ptr<DB_Nodes> db_nodes,
+            const std::string& result_name) {
+           ReleasedStateLock lock(db_nodes->get_femfile());
+           return db_nodes->get_node_result_envelope(result_name);
+         },
+         "result_name"_a,
+         dbnodes_get_node_result_envelope_docs)
     .def("get_node_ids",
          [](std::shared_ptr<DB_Nodes> db_nodes) {
-           return py::tensor_to_nparray(db_nodes->get_node_ids());
+           Tensor_ptr<int32_t> tensor;
+           {
+             pybind11::gil_scoped_release release;
+             tensor = db_nodes->get_node_ids();
+           }
+           return py::tensor_to_nparray(tensor);
          },
          pybind11::return_value_policy::take_ownership,
          dbnodes_get_node_ids_docs);
@@ -790,7 +1086,12 @@ PYBIND11_PLUGIN(dyna_cpp)
     .def("get_element_ids",
          [](std::shared_ptr<DB_Elements> self,
             Element::ElementType element_filter) {
-           return py::tensor_to_nparray(self->get_element_ids());
+           Tensor_ptr<int32_t> tensor;
+           {
+             pybind11::gil_scoped_release release;
+             tensor = self->get_element_ids(element_filter);
+           }
+           return py::tensor_to_nparray(tensor);
          },
          "element_filter"_a = Element::ElementType::NONE,
          dbelems_get_element_ids_docs)
@@ -798,8 +1099,12 @@ PYBIND11_PLUGIN(dyna_cpp)
          [](std::shared_ptr<DB_Elements> self,
             Element::ElementType element_type,
             size_t n_nodes) {
-           return py::tensor_to_nparray(
-             self->get_element_node_ids(element_type, n_nodes));
+           Tensor_ptr<int32_t> tensor;
+           {
+             pybind11::gil_scoped_release release;
+             tensor = self->get_element_node_ids(element_type, n_nodes);
+           }
+           return py::tensor_to_nparray(tensor);
          },
          "element_type"_a = Element::ElementType::NONE,
          "n_nodes"_a,
@@ -807,59 +1112,158 @@ PYBIND11_PLUGIN(dyna_cpp)
     .def("get_element_energy",
          [](std::shared_ptr<DB_Elements> self,
             Element::ElementType element_filter) {
-           return py::tensor_to_nparray(
-             self->get_element_energy(element_filter));
+           Tensor_ptr<float> tensor;
+           {
+             ReleasedStateLock lock(self->get_femfile());
+             tensor = self->get_element_energy(element_filter);
+           }
+           return py::tensor_to_nparray(tensor);
          },
          "element_filter"_a = Element::ElementType::NONE,
          dbelems_get_element_energy)
     .def("get_element_plastic_strain",
          [](std::shared_ptr<DB_Elements> self,
             Element::ElementType element_filter) {
-           return py::tensor_to_nparray(
-             self->get_element_plastic_strain(element_filter));
+           Tensor_ptr<float> tensor;
+           {
+             ReleasedStateLock lock(self->get_femfile());
+             tensor = self->get_element_plastic_strain(element_filter);
+           }
+           return py::tensor_to_nparray(tensor);
          },
          "element_filter"_a = Element::ElementType::NONE,
          dbelems_get_plastic_strain)
     .def("get_element_stress_mises",
          [](std::shared_ptr<DB_Elements> self,
             Element::ElementType element_filter) {
-           return py::tensor_to_nparray(
-             self->get_element_stress_mises(element_filter));
+           Tensor_ptr<float> tensor;
+           {
+             ReleasedStateLock lock(self->get_femfile());
+             tensor = self->get_element_stress_mises(element_filter);
+           }
+           return py::tensor_to_nparray(tensor);
          },
          "element_filter"_a = Element::ElementType::NONE,
          dbelems_get_element_stress_mises)
     .def("get_element_stress",
          [](std::shared_ptr<DB_Elements> self,
             Element::ElementType element_filter) {
-           return py::tensor_to_nparray(
-             self->get_element_stress(element_filter));
+           Tensor_ptr<float> tensor;
+           {
+             ReleasedStateLock lock(self->get_femfile());
+             tensor = self->get_element_stress(element_filter);
+           }
+           return py::tensor_to_nparray(tensor);
          },
          "element_filter"_a = Element::ElementType::NONE,
          dbelems_get_element_stress)
+    .def("get_element_stress_invariants",
+         [](std::shared_ptr<DB_Elements> self,
+            Element::ElementType element_filter,
+            const std::vector<int64_t>& timesteps) {
+           Tensor_ptr<float> tensor;
+           {
+             ReleasedStateLock lock(self->get_femfile());
+             tensor =
+               self->get_element_stress_invariants(element_filter, timesteps);
+           }
+           return py::tensor_to_nparray(tensor);
+         },
+         "element_filter"_a = Element::ElementType::NONE,
+         "timesteps"_a = std::vector<int64_t>(),
+         dbelems_get_element_stress_invariants)
+    .def("get_element_result_envelope",
+         [](std::shared_ptr<DB_Elements> self,
+            const std::string& result_name,
+            Element::ElementType element_filter) {
+           ReleasedStateLock lock(self->get_femfile());
+           return self->get_element_result_envelope(result_name,
+                                                    element_filter);
+         },
+         "result_name"_a,
+         "element_filter"_a = Element::ElementType::NONE,
+         dbelems_get_element_result_envelope_docs)
     .def("get_element_strain",
          [](std::shared_ptr<DB_Elements> self,
             Element::ElementType element_filter) {
-           return py::tensor_to_nparray(
-             self->get_element_strain(element_filter));
+           Tensor_ptr<float> tensor;
+           {
+             ReleasedStateLock lock(self->get_femfile());
+             tensor = self->get_element_strain(element_filter);
+           }
+           return py::tensor_to_nparray(tensor);
          },
          "element_filter"_a = Element::ElementType::NONE,
          dbelems_get_element_strain)
     .def("get_element_coords",
          [](std::shared_ptr<DB_Elements> self,
             Element::ElementType element_filter) {
-           return py::tensor_to_nparray(
-             self->get_element_coords(element_filter));
+           Tensor_ptr<float> tensor;
+           {
+             ReleasedStateLock lock(self->get_femfile());
+             tensor = self->get_element_coords(element_filter);
+           }
+           return py::tensor_to_nparray(tensor);
          },
          "element_filter"_a = Element::ElementType::NONE,
          dbelems_get_element_coords)
     .def(
       "get_element_history_vars",
       [](std::shared_ptr<DB_Elements> self, Element::ElementType element_type) {
-        return py::tensor_to_nparray(
-          self->get_element_history_vars(element_type));
+        Tensor_ptr<float> tensor;
+        {
+          ReleasedStateLock lock(self->get_femfile());
+          tensor = self->get_element_history_vars(element_type);
+        }
+        return py::tensor_to_nparray(tensor);
       },
       "element_type"_a = Element::ElementType::NONE,
-      dbelems_get_element_history_vars);
+      dbelems_get_element_history_vars)
+    .def("get_element_resultsByID",
+         [](std::shared_ptr<DB_Elements> self,
+            const std::string& result_name,
+            Element::ElementType element_type,
+            pybind11::array_t<int32_t, pybind11::array::c_style |
+                                         pybind11::array::forcecast> ids,
+            const std::vector<int64_t>& timesteps) {
+           std::vector<int32_t> tmp(ids.data(), ids.data() + ids.size());
+
+           Tensor_ptr<float> tensor;
+           {
+             ReleasedStateLock lock(self->get_femfile());
+             tensor = self->get_element_resultsByID(
+               result_name, element_type, tmp, timesteps);
+           }
+           return py::tensor_to_nparray(tensor);
+         },
+         "result_name"_a,
+         "element_type"_a,
+         "ids"_a,
+         "timesteps"_a = std::vector<int64_t>(),
+         dbelems_get_element_resultsByID_docs)
+    .def("get_element_resultsByIndex",
+         [](std::shared_ptr<DB_Elements> self,
+            const std::string& result_name,
+            Element::ElementType element_type,
+            pybind11::array_t<int64_t, pybind11::array::c_style |
+                                         pybind11::array::forcecast> indexes,
+            const std::vector<int64_t>& timesteps) {
+           std::vector<size_t> tmp(indexes.data(),
+                                   indexes.data() + indexes.size());
+
+           Tensor_ptr<float> tensor;
+           {
+             ReleasedStateLock lock(self->get_femfile());
+             tensor = self->get_element_resultsByIndex(
+               result_name, element_type, tmp, timesteps);
+           }
+           return py::tensor_to_nparray(tensor);
+         },
+         "result_name"_a,
+         "element_type"_a,
+         "indexes"_a,
+         "timesteps"_a = std::vector<int64_t>(),
+         dbelems_get_element_resultsByIndex_docs);
 
   // DB_Parts
   pybind11::class_<DB_Parts, std::shared_ptr<DB_Parts>> db_parts_py(
@@ -1030,8 +1434,10 @@ PYBIND11_PLUGIN(dyna_cpp)
     // DEPRECATED END
     .def("info", &D3plot::info, d3plot_info_docs)
     .def("read_states",
-         (void (D3plot::*)(const std::string&)) & D3plot::read_states,
-         // pybind11::call_guard<pybind11::gil_scoped_release>(),
+         [](std::shared_ptr<D3plot> _d3plot, const std::string& _variable) {
+           pybind11::gil_scoped_release release;
+           _d3plot->read_states(_variable);
+         },
          d3plot_read_states_docs)
     .def("read_states",
          [](std::shared_ptr<D3plot> _d3plot, pybind11::list _list) {
@@ -1069,11 +1475,14 @@ PYBIND11_PLUGIN(dyna_cpp)
          },
          "variables"_a = pybind11::tuple())
     .def("clear",
-         (void (D3plot::*)(const std::string&)) & D3plot::clear,
-         // pybind11::call_guard<pybind11::gil_scoped_release>(),
+         [](std::shared_ptr<D3plot> _d3plot, const std::string& _variable) {
+           pybind11::gil_scoped_release release;
+           _d3plot->clear(_variable);
+         },
          "variables"_a = pybind11::str())
     .def("get_timesteps",
          [](std::shared_ptr<D3plot> _d3plot) {
+           StateLock lock(_d3plot.get());
            return qd::py::vector_to_nparray(_d3plot->get_timesteps());
          },
          pybind11::return_value_policy::take_ownership,
@@ -1082,6 +1491,22 @@ PYBIND11_PLUGIN(dyna_cpp)
          &D3plot::get_nTimesteps,
          pybind11::return_value_policy::take_ownership,
          d3plot_get_nTimesteps_docs)
+    .def("get_shell_layer_results",
+         [](std::shared_ptr<D3plot> _d3plot) {
+           return py::tensor_to_nparray_readonly(
+             _d3plot->get_shell_layer_results());
+         },
+         d3plot_get_shell_layer_results_docs)
+    .def("get_result_envelope",
+         [](std::shared_ptr<D3plot> _d3plot,
+            const std::string& result_name,
+            Element::ElementType element_type) {
+           pybind11::gil_scoped_release release;
+           return _d3plot->get_result_envelope(result_name, element_type);
+         },
+         "result_name"_a,
+         "element_type"_a = Element::ElementType::NONE,
+         d3plot_get_result_envelope_docs)
     .def("get_title",
          &D3plot::get_title,
          pybind11::return_value_policy::take_ownership,
@@ -1099,10 +1524,13 @@ PYBIND11_PLUGIN(dyna_cpp)
   pybind11::class_<RawD3plot, std::shared_ptr<RawD3plot>> raw_d3plot_py(
     m, "QD_RawD3plot");
   raw_d3plot_py
-    .def(pybind11::init<std::string, bool>(),
+    .def("__init__",
+         [](RawD3plot& instance, std::string _filepath, bool use_femzip) {
+           pybind11::gil_scoped_release release;
+           new (&instance) RawD3plot(_filepath, use_femzip);
+         },
          "filepath"_a,
          "use_femzip"_a = false,
-         // pybind11::call_guard<pybind11::gil_scoped_release>(),
          rawd3plot_constructor_description)
     .def(pybind11::init<>())
     .def("_get_string_names",
@@ -1135,29 +1563,32 @@ PYBIND11_PLUGIN(dyna_cpp)
          },
          "name"_a,
          rawd3plot_get_float_data_docs)
+    .def("get_raw_data_envelope",
+         [](std::shared_ptr<RawD3plot> self, const std::string& name) {
+           pybind11::gil_scoped_release release;
+           return self->get_float_data_envelope(name);
+         },
+         "name"_a,
+         rawd3plot_get_raw_data_envelope_docs)
     .def("_set_float_data",
          [](std::shared_ptr<RawD3plot> _d3plot,
             std::string _entry_name,
-            pybind11::array_t<float> _data) {
-           auto shape_sizet = std::vector<size_t>(_data.ndim());
-           for (size_t ii = 0; ii < _data.ndim(); ++ii)
-             shape_sizet[ii] = _data.shape()[ii];
-
-           pybind11::gil_scoped_release release;
-           _d3plot->set_float_data(_entry_name, shape_sizet, _data.data());
+            pybind11::array_t<float,
+                              pybind11::array::c_style |
+                                pybind11::array::forcecast> _data) {
+           _d3plot->set_float_data(_entry_name,
+                                   qd::py::nparray_to_tensor<float>(_data));
          },
          "name"_a,
          "data"_a)
     .def("_set_int_data",
          [](std::shared_ptr<RawD3plot> _d3plot,
             std::string _entry_name,
-            pybind11::array_t<int> _data) {
-           auto shape_sizet = std::vector<size_t>(_data.ndim());
-           for (size_t ii = 0; ii < _data.ndim(); ++ii)
-             shape_sizet[ii] = _data.shape()[ii];
-
-           pybind11::gil_scoped_release release;
-           _d3plot->set_int_data(_entry_name, shape_sizet, _data.data());
+            pybind11::array_t<int32_t,
+                              pybind11::array::c_style |
+                                pybind11::array::forcecast> _data) {
+           _d3plot->set_int_data(_entry_name,
+                                 qd::py::nparray_to_tensor<int32_t>(_data));
          },
          "name"_a,
          "data"_a)
@@ -1205,6 +1636,16 @@ PYBIND11_PLUGIN(dyna_cpp)
     .value("right", Keyword::Align::RIGHT)
     .export_values();
 
+  pybind11::enum_<Keyword::KeywordType>(
+    keyword_py, "keyword_type", keyword_enum_keyword_type_docs)
+    .value("generic", Keyword::KeywordType::GENERIC)
+    .value("node", Keyword::KeywordType::NODE)
+    .value("element", Keyword::KeywordType::ELEMENT)
+    .value("part", Keyword::KeywordType::PART)
+    .value("include_path", Keyword::KeywordType::INCLUDE_PATH)
+    .value("include", Keyword::KeywordType::INCLUDE)
+    .export_values();
+
   keyword_py
     .def(pybind11::init<std::string, int64_t>(),
          "lines"_a,
@@ -1692,6 +2133,7 @@ PYBIND11_PLUGIN(dyna_cpp)
             bool read_generic_keywords,
             bool parse_mesh,
             bool load_includes) {
+           pybind11::gil_scoped_release release;
            new (&instance) KeyFile(
              _filepath, read_generic_keywords, parse_mesh, load_includes);
            if (!str_has_content(_filepath))
@@ -1701,7 +2143,6 @@ PYBIND11_PLUGIN(dyna_cpp)
          "read_keywords"_a = true,
          "parse_mesh"_a = false,
          "load_includes"_a = false,
-         // pybind11::call_guard<pybind11::gil_scoped_release>(),
          keyfile_constructor)
     .def("__init__",
          [](KeyFile& instance,
@@ -1786,15 +2227,65 @@ PYBIND11_PLUGIN(dyna_cpp)
       "name"_a,
       pybind11::return_value_policy::take_ownership,
       keyfile_getitem_description)
+    .def("find_keywords",
+         [](std::shared_ptr<KeyFile> self,
+            const std::string& pattern,
+            bool search_includes) {
+           pybind11::list ret;
+           for (auto& kw : self->get_keywordsByPattern(pattern, search_includes))
+             ret.append(cast_kw(kw));
+           return ret;
+         },
+         "pattern"_a = "*",
+         "search_includes"_a = true,
+         keyfile_find_keywords_description)
+    .def("find_keywords_by_prefix",
+         [](std::shared_ptr<KeyFile> self,
+            const std::string& prefix,
+            bool search_includes) {
+           pybind11::list ret;
+           for (auto& kw : self->get_keywordsByPrefix(prefix, search_includes))
+             ret.append(cast_kw(kw));
+           return ret;
+         },
+         "prefix"_a,
+         "search_includes"_a = true,
+         keyfile_find_keywords_by_prefix_description)
+    .def("find_keywords_by_type",
+         [](std::shared_ptr<KeyFile> self,
+            Keyword::KeywordType keyword_type,
+            bool search_includes) {
+           pybind11::list ret;
+           for (auto& kw :
+                self->get_keywordsByType(keyword_type, search_includes))
+             ret.append(cast_kw(kw));
+           return ret;
+         },
+         "keyword_type"_a,
+         "search_includes"_a = true,
+         keyfile_find_keywords_by_type_description)
     .def("keys",
          &KeyFile::keys,
          pybind11::return_value_policy::take_ownership,
          keyfile_keys_description)
     .def("save",
-         &KeyFile::save_txt,
+         [](std::shared_ptr<KeyFile> self, const std::string& filepath) {
+           // keywords are edited with the GIL, thus saving keeps it
+           self->save_txt(filepath);
+         },
          "filepath"_a,
-         // pybind11::call_guard<pybind11::gil_scoped_release>(),
          keyfile_save_description)
+    .def("save_incremental",
+         [](std::shared_ptr<KeyFile> self,
+            const std::string& filepath,
+            bool save_includes) {
+           // keywords are edited with the GIL, thus saving keeps it
+           self->save_incremental(filepath, save_includes);
+         },
+         "filepath"_a = std::string(),
+         "save_includes"_a = true,
+         keyfile_save_incremental_description)
+    .def("is_modified", &KeyFile::is_modified, keyfile_is_modified_description)
     .def("remove_keyword",
          [](std::shared_ptr<KeyFile> self,
             const std::string& name,
@@ -1865,7 +2356,14 @@ PYBIND11_PLUGIN(dyna_cpp)
     .value("link", Binout::EntryType::LINK)
     .export_values();
 
-  binout_py.def(pybind11::init<std::string>(), "filepath"_a)
+  binout_py
+    .def("__init__",
+         [](Binout& instance, const std::string& filepath, bool use_index) {
+           pybind11::gil_scoped_release release;
+           new (&instance) Binout(filepath, use_index);
+         },
+         "filepath"_a,
+         "use_index"_a = false)
     .def("cd", &Binout::cd, "path"_a)
     .def("exists", &Binout::exists, "path"_a)
     .def("has_children", &Binout::has_children, "path"_a)
@@ -1884,25 +2382,25 @@ PYBIND11_PLUGIN(dyna_cpp)
             throw(std::invalid_argument(
               "Path points to a directory, not a variable."));
           case Binout::EntryType::INT8:
-            return py::tensor_to_nparray(self->read_variable<int8_t>(path));
+            return binout_read_variable<int8_t>(self, path);
           case Binout::EntryType::INT16:
-            return py::tensor_to_nparray(self->read_variable<int16_t>(path));
+            return binout_read_variable<int16_t>(self, path);
           case Binout::EntryType::INT32:
-            return py::tensor_to_nparray(self->read_variable<int32_t>(path));
+            return binout_read_variable<int32_t>(self, path);
           case Binout::EntryType::INT64:
-            return py::tensor_to_nparray(self->read_variable<int64_t>(path));
+            return binout_read_variable<int64_t>(self, path);
           case Binout::EntryType::UINT8:
-            return py::tensor_to_nparray(self->read_variable<uint8_t>(path));
+            return binout_read_variable<uint8_t>(self, path);
           case Binout::EntryType::UINT16:
-            return py::tensor_to_nparray(self->read_variable<uint16_t>(path));
+            return binout_read_variable<uint16_t>(self, path);
           case Binout::EntryType::UINT32:
-            return py::tensor_to_nparray(self->read_variable<uint32_t>(path));
+            return binout_read_variable<uint32_t>(self, path);
           case Binout::EntryType::UINT64:
-            return py::tensor_to_nparray(self->read_variable<uint64_t>(path));
+            return binout_read_variable<uint64_t>(self, path);
           case Binout::EntryType::FLOAT32:
-            return py::tensor_to_nparray(self->read_variable<float>(path));
+            return binout_read_variable<float>(self, path);
           case Binout::EntryType::FLOAT64:
-            return py::tensor_to_nparray(self->read_variable<double>(path));
+            return binout_read_variable<double>(self, path);
           case Binout::EntryType::LINK:
             throw(
               std::invalid_argument("Path points to a link, not a variable."));
@@ -1911,17 +2409,112 @@ PYBIND11_PLUGIN(dyna_cpp)
                                         "honestly don't know what exactly."));
         }
       },
-      "path"_a);
+      "path"_a)
+    .def(
+      "read_variable_into",
+      [](std::shared_ptr<Binout> self,
+         const std::string& path,
+         pybind11::buffer out) {
+        auto info = out.request(true);
+
+        // the data is written straight into the buffer
+        size_t stride = info.itemsize;
+        for (size_t iDim = info.ndim; iDim-- > 0;) {
+          if (static_cast<size_t>(info.strides[iDim]) != stride)
+            throw(std::invalid_argument("Array must be C contiguous."));
+          stride *= info.shape[iDim];
+        }
+
+        if (info.format == "d")
+          return binout_read_variable_into<double>(self, path, info);
+        else if (info.format == "f")
+          return binout_read_variable_into<float>(self, path, info);
+        else if ((info.format == "i" || info.format == "l") &&
+                 info.itemsize == 4)
+          return binout_read_variable_into<int32_t>(self, path, info);
+        else if ((info.format == "l" || info.format == "q") &&
+                 info.itemsize == 8)
+          return binout_read_variable_into<int64_t>(self, path, info);
+        else
+          throw(std::invalid_argument(
+            "Array must be of type float32, float64, int32 or int64."));
+      },
+      "path"_a,
+      "out"_a)
+    .def("get_series_paths", &Binout::get_series_paths, "path_pattern"_a)
+    .def(
+      "read_variable_series",
+      [](std::shared_ptr<Binout> self,
+         const std::string& path_pattern,
+         const std::vector<int64_t>& ids) {
+        // type of the first variable decides
+        auto paths = self->get_series_paths(path_pattern);
+        if (paths.empty())
+          throw(std::invalid_argument("No variables match the path pattern: " +
+                                      path_pattern));
+        auto type_id = self->get_type_id(paths[0]);
+
+        switch (type_id) {
+          case Binout::EntryType::INT8:
+            return binout_read_variable_series<int8_t>(
+              self, path_pattern, ids);
+          case Binout::EntryType::INT16:
+            return binout_read_variable_series<int16_t>(
+              self, path_pattern, ids);
+          case Binout::EntryType::INT32:
+            return binout_read_variable_series<int32_t>(
+              self, path_pattern, ids);
+          case Binout::EntryType::INT64:
+            return binout_read_variable_series<int64_t>(
+              self, path_pattern, ids);
+          case Binout::EntryType::UINT8:
+            return binout_read_variable_series<uint8_t>(
+              self, path_pattern, ids);
+          case Binout::EntryType::UINT16:
+            return binout_read_variable_series<uint16_t>(
+              self, path_pattern, ids);
+          case Binout::EntryType::UINT32:
+            return binout_read_variable_series<uint32_t>(
+              self, path_pattern, ids);
+          case Binout::EntryType::UINT64:
+            return binout_read_variable_series<uint64_t>(
+              self, path_pattern, ids);
+          case Binout::EntryType::FLOAT32:
+            return binout_read_variable_series<float>(
+              self, path_pattern, ids);
+          case Binout::EntryType::FLOAT64:
+            return binout_read_variable_series<double>(
+              self, path_pattern, ids);
+          default:
+            throw(std::invalid_argument(
+              "Path pattern does not point to variables: " + path_pattern));
+        }
+      },
+      "path_pattern"_a,
+      "ids"_a = std::vector<int64_t>());
+#ifdef QD_USE_HDF5
+  binout_py.def("save_hdf5",
+                [](std::shared_ptr<Binout> self,
+                   const std::string& filepath,
+                   int compression_level,
+                   size_t n_threads) {
+                  pybind11::gil_scoped_release release;
+                  self->save_hdf5(filepath, compression_level, n_threads);
+                },
+                "filepath"_a,
+                "compression_level"_a = 4,
+                "n_threads"_a = 0);
+#endif
 #endif
 
   // module functions
   m.def("get_file_entropy",
         [](std::string _filepath) {
+          pybind11::gil_scoped_release release;
           std::vector<char> buffer = read_binary_file(_filepath);
           return get_entropy(buffer);
         },
         pybind11::return_value_policy::take_ownership,
-        // pybind11::call_guard<pybind11::gil_scoped_release>(),
         module_get_file_entropy_description);
 #ifdef QD_USE_FEMZIP
   m.def("is_femzipped",
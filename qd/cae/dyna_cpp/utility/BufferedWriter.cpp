@@ -0,0 +1,105 @@
+
+#include <stdexcept>
+
+#include <dyna_cpp/utility/BufferedWriter.hpp>
+
+namespace qd {
+
+/** Create an in-memory writer
+ *
+ */
+BufferedWriter::BufferedWriter()
+  : buffer_size(0)
+  , nFlushed(0)
+{}
+
+/** Create a writer for a file
+ *
+ * @param _filepath : path of the file to write
+ * @param _buffer_size : number of chars buffered before flushing
+ */
+BufferedWriter::BufferedWriter(const std::string& _filepath,
+                               size_t _buffer_size)
+  : buffer_size(_buffer_size)
+  , nFlushed(0)
+{
+  fs.open(_filepath, std::ofstream::binary);
+  if (!fs.is_open())
+    throw(std::invalid_argument("Error while opening file " + _filepath));
+
+  buffer.reserve(_buffer_size);
+}
+
+/** Destructor, flushes remaining data
+ *
+ */
+BufferedWriter::~BufferedWriter()
+{
+  try {
+    close();
+  } catch (...) {
+  }
+}
+
+/** Write the buffered data to the file
+ *
+ * Does nothing for in-memory writers.
+ */
+void
+BufferedWriter::flush()
+{
+  if (!fs.is_open())
+    return;
+
+  fs.write(buffer.data(), static_cast<std::streamsize>(buffer.size()));
+  if (fs.bad())
+    throw(std::runtime_error("Error during writing file."));
+  nFlushed += buffer.size();
+  buffer.clear();
+}
+
+/** Copy chars from a stream into the writer
+ *
+ * @param _is : stream to read from (at the current position)
+ * @param _nChars : number of chars to copy
+ *
+ * The data is read in chunks directly into the buffer.
+ */
+void
+BufferedWriter::copy_from(std::istream& _is, size_t _nChars)
+{
+  while (_nChars != 0) {
+
+    const size_t nChunk =
+      buffer_size != 0 ? std::min(_nChars, buffer_size) : _nChars;
+    reserve_space(nChunk);
+
+    const auto offset = buffer.size();
+    buffer.resize(offset + nChunk);
+    _is.read(&buffer[offset], static_cast<std::streamsize>(nChunk));
+
+    if (static_cast<size_t>(_is.gcount()) != nChunk) {
+      buffer.resize(offset + static_cast<size_t>(_is.gcount()));
+      throw(std::runtime_error("Error while copying data, stream ended " +
+                               std::to_string(_nChars - buffer.size() +
+                                              offset) +
+                               " chars early."));
+    }
+    _nChars -= nChunk;
+  }
+}
+
+/** Flush the data and close the file
+ *
+ */
+void
+BufferedWriter::close()
+{
+  if (!fs.is_open())
+    return;
+
+  flush();
+  fs.close();
+}
+
+} // namespace qd
@@ -0,0 +1,278 @@
+
+#ifndef BUFFEREDWRITER_HPP
+#define BUFFEREDWRITER_HPP
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <istream>
+#include <string>
+#include <type_traits>
+
+namespace qd {
+
+/** Buffered text sink for writing large files
+ *
+ * Without a filepath, all data is kept in memory and can be retrieved
+ * with str(). With a filepath, data is flushed to the file as soon as
+ * the buffer is full, so that memory consumption stays constant.
+ *
+ * The formatting functions write fixed-width fields and replace the
+ * (slow) stringstream formatting used before.
+ */
+class BufferedWriter
+{
+private:
+  std::ofstream fs;
+  std::string buffer;
+  size_t buffer_size;
+  size_t nFlushed; // chars already written to the file
+
+  inline void reserve_space(size_t _nChars);
+
+public:
+  BufferedWriter();
+  explicit BufferedWriter(const std::string& _filepath,
+                          size_t _buffer_size = 1 << 20);
+  ~BufferedWriter();
+
+  inline void write(char _c);
+  inline void write(const char* _data, size_t _size);
+  inline void write(const std::string& _data);
+  inline void write_line(const std::string& _line);
+  template<typename T>
+  inline void write_int(T _value, size_t _width, bool _left_aligned = false);
+  inline void write_float(double _value,
+                          size_t _width,
+                          int _precision = 7,
+                          bool _left_aligned = false);
+  inline void write_padded(const std::string& _data,
+                           size_t _width,
+                           bool _left_aligned = false);
+  inline bool pop_back_if(char _c);
+  void copy_from(std::istream& _is, size_t _nChars);
+
+  void flush();
+  void close();
+  inline bool is_file_sink() const;
+  inline size_t get_position() const;
+  inline const std::string& str() const;
+};
+
+/** Check whether the writer writes to a file
+ *
+ * @return is_file_sink
+ */
+bool
+BufferedWriter::is_file_sink() const
+{
+  return fs.is_open();
+}
+
+/** Get the number of chars written in total
+ *
+ * @return position : offset of the next char in the output
+ */
+size_t
+BufferedWriter::get_position() const
+{
+  return nFlushed + buffer.size();
+}
+
+/** Get the data in the buffer
+ *
+ * @return buffer
+ *
+ * For file sinks, this is only the part which was not flushed yet.
+ */
+const std::string&
+BufferedWriter::str() const
+{
+  return buffer;
+}
+
+/** Make sure there is space for the next chars in the buffer
+ *
+ * @param _nChars : number of chars to write next
+ *
+ * The buffer is only flushed before new data arrives, thus it
+ * always contains the last chars written (see pop_back_if).
+ */
+void
+BufferedWriter::reserve_space(size_t _nChars)
+{
+  if (fs.is_open() && !buffer.empty() &&
+      buffer.size() + _nChars > buffer_size)
+    flush();
+}
+
+/** Write a single char
+ *
+ * @param _c
+ */
+void
+BufferedWriter::write(char _c)
+{
+  reserve_space(1);
+  buffer.push_back(_c);
+}
+
+/** Write a chunk of chars
+ *
+ * @param _data
+ * @param _size
+ */
+void
+BufferedWriter::write(const char* _data, size_t _size)
+{
+  reserve_space(_size);
+  buffer.append(_data, _size);
+}
+
+/** Write a string
+ *
+ * @param _data
+ */
+void
+BufferedWriter::write(const std::string& _data)
+{
+  write(_data.data(), _data.size());
+}
+
+/** Write a string and a linebreak
+ *
+ * @param _line
+ */
+void
+BufferedWriter::write_line(const std::string& _line)
+{
+  reserve_space(_line.size() + 1);
+  buffer.append(_line);
+  buffer.push_back('\n');
+}
+
+/** Write a string padded with spaces to a fixed width
+ *
+ * @param _data : string to write
+ * @param _width : width of the field
+ * @param _left_aligned : whether to pad on the right side
+ *
+ * Like std::setw, strings longer than the width are not cropped.
+ */
+void
+BufferedWriter::write_padded(const std::string& _data,
+                             size_t _width,
+                             bool _left_aligned)
+{
+  const size_t nPadding = _data.size() < _width ? _width - _data.size() : 0;
+  reserve_space(_data.size() + nPadding);
+  if (!_left_aligned)
+    buffer.append(nPadding, ' ');
+  buffer.append(_data);
+  if (_left_aligned)
+    buffer.append(nPadding, ' ');
+}
+
+/** Write an integer into a fixed width field
+ *
+ * @param _value : integer to write
+ * @param _width : width of the field
+ * @param _left_aligned : whether to pad on the right side
+ *
+ * Same as "ss << std::setw(width) << value" but without the stream.
+ */
+template<typename T>
+void
+BufferedWriter::write_int(T _value, size_t _width, bool _left_aligned)
+{
+  static_assert(std::is_integral<T>::value, "Integer number required.");
+
+  // convert backwards
+  char tmp[24];
+  char* end = tmp + sizeof(tmp);
+  char* start = end;
+
+  const bool is_negative = _value < 0;
+  auto value = is_negative ? -static_cast<uint64_t>(_value)
+                           : static_cast<uint64_t>(_value);
+  do {
+    *--start = static_cast<char>('0' + value % 10);
+    value /= 10;
+  } while (value != 0);
+  if (is_negative)
+    *--start = '-';
+
+  // write padded
+  const size_t len = static_cast<size_t>(end - start);
+  const size_t nPadding = len < _width ? _width - len : 0;
+  reserve_space(len + nPadding);
+  if (!_left_aligned)
+    buffer.append(nPadding, ' ');
+  buffer.append(start, len);
+  if (_left_aligned)
+    buffer.append(nPadding, ' ');
+}
+
+/** Write a floating point number into a fixed width field
+ *
+ * @param _value : number to write
+ * @param _width : width of the field
+ * @param _precision : significant digits
+ * @param _left_aligned : whether to pad on the right side
+ *
+ * The output is identical to "ss << std::setw(width) << value"
+ * with "ss.precision(precision)". Integral values, which are very common
+ * in keyfiles, skip the printf machinery entirely.
+ */
+void
+BufferedWriter::write_float(double _value,
+                            size_t _width,
+                            int _precision,
+                            bool _left_aligned)
+{
+  static const double powers_of_ten[] = { 1e0,  1e1,  1e2,  1e3,  1e4,
+                                          1e5,  1e6,  1e7,  1e8,  1e9,
+                                          1e10, 1e11, 1e12, 1e13, 1e14,
+                                          1e15 };
+
+  // fast path: integral values are printed without decimal point
+  if (_precision >= 0 && _precision <= 15 && _value == std::floor(_value) &&
+      std::abs(_value) < powers_of_ten[_precision] &&
+      !(_value == 0. && std::signbit(_value))) {
+    write_int(static_cast<int64_t>(_value), _width, _left_aligned);
+    return;
+  }
+
+  char tmp[64];
+  auto len = std::snprintf(tmp,
+                           sizeof(tmp),
+                           _left_aligned ? "%-*.*g" : "%*.*g",
+                           static_cast<int>(_width),
+                           _precision,
+                           _value);
+  if (len < 0)
+    return;
+  write(tmp, std::min(static_cast<size_t>(len), sizeof(tmp) - 1));
+}
+
+/** Remove the last char written, if it matches
+ *
+ * @param _c : char to remove
+ * @return removed : whether a char was removed
+ */
+bool
+BufferedWriter::pop_back_if(char _c)
+{
+  if (!buffer.empty() && buffer.back() == _c) {
+    buffer.pop_back();
+    return true;
+  }
+  return false;
+}
+
+} // namespace qd
+
+#endif
@@ -1,99 +1,113 @@
-
 #ifndef FEM_UTILITY_HPP
+#define FEM_UTILITY_HPP
 
-#include <dyna_cpp/utility/MathUtility.hpp>
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
 #include <stdexcept>
-#include <vector>
-
+#include <string>
 
 namespace qd {
 
-/** Compute a variable for states
+/** Modes for reducing the integration point layers of an element
  *
- * @param _data : data vector
- * @param _mode : computation mode
- *
- * modes are:
- *  > 1 = max
- *  > 2 = min
- *  > 3 = out
- *  > 4 = mid
- *  > 5 = in
- *  > 6 = mean
+ * The values match the codes of D3plot::read_states_parse_readMode.
  */
-template<typename T>
-inline T
-compute_state_var_from_mode(const std::vector<T>& _data, int32_t _mode)
+enum LayerMode : int32_t
 {
-
-#ifdef QD_DEBUG
-  if (_data.size() < 1) {
-    throw std::invalid_argument("Can not compute state var from empty vector.");
-  }
-#endif
-
-  switch (_mode) {
-    case 1: // max
-      return MathUtility::max(_data);
-      break;
-    case 2: // min
-      return MathUtility::min(_data);
-      break;
-    case 3: // out
-      return _data.back();
-      break;
-    case 4: // mid
-      return MathUtility::middle(_data);
-      break;
-    case 5: // in
-      return _data[0];
-      break;
-    case 6: // mean
-      return MathUtility::mean(_data);
-      break;
-  } // end:switch
-
-  return -1;
-}
-
-/** Compute a variable for states
+  LAYER_MAX = 1,
+  LAYER_MIN = 2,
+  LAYER_OUT = 3,
+  LAYER_MID = 4,
+  LAYER_IN = 5,
+  LAYER_MEAN = 6
+};
+
+/** Reduce the layers of a block of elements
  *
- * @param _data : data vector
- * @param _mode : computation mode
+ * @param _data : pointer to the first component of the first element
+ * @param _nElements : number of elements in the block
+ * @param _element_stride : offset between two elements (in entries)
+ * @param _nLayers : number of layers per element
+ * @param _layer_stride : offset between two layers (in entries)
+ * @param _nComponents : number of contiguous components per layer
+ * @param _out : output array (nElements x nComponents)
  *
- * modes are:
- *  > 1 = max
- *  > 2 = min
- *  > 3 = out
- *  > 4 = mid
- *  > 5 = in
- *  > 6 = mean
+ * The mode is a template argument so that the inner loop over the
+ * components has no branches and can be vectorized. For an even number
+ * of layers mid is the mean of the two middle layers.
  */
-template<typename T>
-std::vector<T>
-compute_state_var_from_mode(const std::vector<std::vector<T>>& _data,
-                            int32_t _mode)
+template<int32_t Mode, typename T>
+void
+reduce_layers(const T* _data,
+              size_t _nElements,
+              size_t _element_stride,
+              size_t _nLayers,
+              size_t _layer_stride,
+              size_t _nComponents,
+              T* _out)
 {
+  static_assert(Mode >= LAYER_MAX && Mode <= LAYER_MEAN, "Unknown layer mode");
 
-#ifdef QD_DEBUG
-  if (_data.size() < 1)
-    throw std::invalid_argument(
-      "Can not compute state var from empty matrix vector.");
-#endif
-
-  std::vector<T> ret(_data.size());
-
-  for (size_t ii = 0; ii < _data.size(); ++ii) {
-    ret[ii] = compute_state_var_from_mode(_data[ii], _mode);
+  if (_nLayers == 0) {
+    std::fill(_out, _out + _nElements * _nComponents, static_cast<T>(0));
+    return;
   }
 
-  return ret;
+  for (size_t iElement = 0; iElement < _nElements; ++iElement) {
+    const T* element = _data + iElement * _element_stride;
+    T* out = _out + iElement * _nComponents;
+
+    // initial layer
+    size_t iFirstLayer = 0;
+    if (Mode == LAYER_OUT)
+      iFirstLayer = _nLayers - 1;
+    else if (Mode == LAYER_MID)
+      iFirstLayer = (_nLayers - 1) / 2;
+
+    const T* first = element + iFirstLayer * _layer_stride;
+    for (size_t iComponent = 0; iComponent < _nComponents; ++iComponent)
+      out[iComponent] = first[iComponent];
+
+    // accumulate the others
+    if (Mode == LAYER_MAX) {
+      for (size_t iLayer = 1; iLayer < _nLayers; ++iLayer) {
+        const T* layer = element + iLayer * _layer_stride;
+        for (size_t iComponent = 0; iComponent < _nComponents; ++iComponent)
+          out[iComponent] = std::max(out[iComponent], layer[iComponent]);
+      }
+    } else if (Mode == LAYER_MIN) {
+      for (size_t iLayer = 1; iLayer < _nLayers; ++iLayer) {
+        const T* layer = element + iLayer * _layer_stride;
+        for (size_t iComponent = 0; iComponent < _nComponents; ++iComponent)
+          out[iComponent] = std::min(out[iComponent], layer[iComponent]);
+      }
+    } else if (Mode == LAYER_MID && _nLayers % 2 == 0) {
+      const T* layer = first + _layer_stride;
+      for (size_t iComponent = 0; iComponent < _nComponents; ++iComponent)
+        out[iComponent] = (out[iComponent] + layer[iComponent]) / 2;
+    } else if (Mode == LAYER_MEAN) {
+      for (size_t iLayer = 1; iLayer < _nLayers; ++iLayer) {
+        const T* layer = element + iLayer * _layer_stride;
+        for (size_t iComponent = 0; iComponent < _nComponents; ++iComponent)
+          out[iComponent] += layer[iComponent];
+      }
+      for (size_t iComponent = 0; iComponent < _nComponents; ++iComponent)
+        out[iComponent] /= static_cast<T>(_nLayers);
+    }
+  }
 }
 
-/** Compute a variable for states
+/** Reduce the layers of a block of elements with a mode given at runtime
  *
- * @param _data : data vector
- * @param _modes : computation mode for every row
+ * @param _data : pointer to the first component of the first element
+ * @param _nElements : number of elements in the block
+ * @param _element_stride : offset between two elements (in entries)
+ * @param _nLayers : number of layers per element
+ * @param _layer_stride : offset between two layers (in entries)
+ * @param _nComponents : number of contiguous components per layer
+ * @param _mode : reduction mode, see LayerMode
+ * @param _out : output array (nElements x nComponents)
  *
  * modes are:
  *  > 1 = max
@@ -104,29 +118,77 @@ compute_state_var_from_mode(const std::vector<std::vector<T>>& _data,
  *  > 6 = mean
  */
 template<typename T>
-std::vector<T>
-compute_state_var_from_mode(const std::vector<std::vector<T>>& _data,
-                            const std::vector<int32_t> _modes)
+void
+reduce_layers(const T* _data,
+              size_t _nElements,
+              size_t _element_stride,
+              size_t _nLayers,
+              size_t _layer_stride,
+              size_t _nComponents,
+              int32_t _mode,
+              T* _out)
 {
-
-#ifdef QD_DEBUG
-  if (_data.size() < 1)
-    throw std::invalid_argument(
-      "Can not compute state var from empty matrix vector.");
-  if (_modes.size() != _data.size())
-    throw std::invalid_argument(
-      "Data and computation modes must ahve same shape.");
-#endif
-
-  std::vector<T> ret(_data.size());
-
-  for (size_t ii = 0; ii < _data.size(); ++ii) {
-    ret[ii] = compute_state_var_from_mode(_data[ii], _modes[ii]);
+  switch (_mode) {
+    case LAYER_MAX:
+      reduce_layers<LAYER_MAX>(_data,
+                               _nElements,
+                               _element_stride,
+                               _nLayers,
+                               _layer_stride,
+                               _nComponents,
+                               _out);
+      break;
+    case LAYER_MIN:
+      reduce_layers<LAYER_MIN>(_data,
+                               _nElements,
+                               _element_stride,
+                               _nLayers,
+                               _layer_stride,
+                               _nComponents,
+                               _out);
+      break;
+    case LAYER_OUT:
+      reduce_layers<LAYER_OUT>(_data,
+                               _nElements,
+                               _element_stride,
+                               _nLayers,
+                               _layer_stride,
+                               _nComponents,
+                               _out);
+      break;
+    case LAYER_MID:
+      reduce_layers<LAYER_MID>(_data,
+                               _nElements,
+                               _element_stride,
+                               _nLayers,
+                               _layer_stride,
+                               _nComponents,
+                               _out);
+      break;
+    case LAYER_IN:
+      reduce_layers<LAYER_IN>(_data,
+                              _nElements,
+                              _element_stride,
+                              _nLayers,
+                              _layer_stride,
+                              _nComponents,
+                              _out);
+      break;
+    case LAYER_MEAN:
+      reduce_layers<LAYER_MEAN>(_data,
+                                _nElements,
+                                _element_stride,
+                                _nLayers,
+                                _layer_stride,
+                                _nComponents,
+                                _out);
+      break;
+    default:
+      throw(std::invalid_argument("Unknown layer reduction mode: " +
+                                  std::to_string(_mode)));
   }
-
-  return ret;
 }
 
 } // namespace qd
 
-#endif
\ No newline at end of file
+#endif
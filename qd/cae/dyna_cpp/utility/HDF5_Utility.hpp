@@ -2,7 +2,10 @@
 #ifndef HDF5_UTILITY_HPP
 #define HDF5_UTILITY_HPP
 
+#include <cstdint>
+#include <stdexcept>
 #include <string>
+#include <vector>
 
 #include <H5Cpp.h>
 
@@ -29,6 +32,105 @@ public:
   void write_vector(const std::string& _path, const std::vector<T> _data);
 };
 
+/** Get the native HDF5 type of a C++ type
+ *
+ * @return type : HDF5 type, unknown types fail to link
+ */
+template<typename T>
+H5::PredType
+get_hdf5_type();
+
+template<>
+inline H5::PredType
+get_hdf5_type<int8_t>()
+{
+  return H5::PredType::NATIVE_INT8;
+}
+
+template<>
+inline H5::PredType
+get_hdf5_type<int16_t>()
+{
+  return H5::PredType::NATIVE_INT16;
+}
+
+template<>
+inline H5::PredType
+get_hdf5_type<int32_t>()
+{
+  return H5::PredType::NATIVE_INT32;
+}
+
+template<>
+inline H5::PredType
+get_hdf5_type<int64_t>()
+{
+  return H5::PredType::NATIVE_INT64;
+}
+
+template<>
+inline H5::PredType
+get_hdf5_type<uint8_t>()
+{
+  return H5::PredType::NATIVE_UINT8;
+}
+
+template<>
+inline H5::PredType
+get_hdf5_type<uint16_t>()
+{
+  return H5::PredType::NATIVE_UINT16;
+}
+
+template<>
+inline H5::PredType
+get_hdf5_type<uint32_t>()
+{
+  return H5::PredType::NATIVE_UINT32;
+}
+
+template<>
+inline H5::PredType
+get_hdf5_type<uint64_t>()
+{
+  return H5::PredType::NATIVE_UINT64;
+}
+
+template<>
+inline H5::PredType
+get_hdf5_type<float>()
+{
+  return H5::PredType::NATIVE_FLOAT;
+}
+
+template<>
+inline H5::PredType
+get_hdf5_type<double>()
+{
+  return H5::PredType::NATIVE_DOUBLE;
+}
+
+/** Write a vector as one-dimensional dataset
+ *
+ * @param _path : path of the dataset
+ * @param _data : data to write
+ */
+template<typename T>
+void
+QD_HDF5::write_vector(const std::string& _path, const std::vector<T> _data)
+{
+  if (this->exists(_path)) {
+    throw std::invalid_argument("Data vector " + _path +
+                                " does already exist.");
+  }
+
+  hsize_t dims[] = { _data.size() };
+  H5::DataSpace dataspace(1, dims);
+  auto dataset = this->createDataSet(_path, get_hdf5_type<T>(), dataspace);
+  if (!_data.empty())
+    dataset.write(_data.data(), get_hdf5_type<T>());
+}
+
 } // namespace qd
 
 #endif
\ No newline at end of file
@@ -5,6 +5,7 @@
 #include <algorithm> // sort
 #include <cmath>
 #include <numeric>
+#include <stdexcept>
 #include <vector>
 
 namespace qd {
@@ -13,6 +14,19 @@ class MathUtility
 {
 
 public:
+  // entries computed by stress_invariants
+  enum StressInvariant
+  {
+    MISES,
+    PRESSURE,
+    TRIAXIALITY,
+    PRINCIPAL_1,
+    PRINCIPAL_2,
+    PRINCIPAL_3,
+    LODE_PARAMETER,
+    N_STRESS_INVARIANTS
+  };
+
   // vector
   template<typename T>
   static T v_median(std::vector<T> vec);
@@ -46,6 +60,16 @@ public:
   static T min(const std::vector<T>& _vec);
   template<typename T>
   static T mises_stress(const std::vector<T>& _stress_vector);
+  template<typename T>
+  static T mises_stress(const T* _stress);
+
+  // kernels over contiguous (n x 6) stress arrays
+  template<typename T>
+  static void mises_stress(const T* _stress, size_t _nTensors, T* _mises);
+  template<typename T>
+  static void stress_invariants(const T* _stress,
+                                size_t _nTensors,
+                                T* _invariants);
 };
 
 /*--------------------*/
@@ -282,16 +306,97 @@ template<typename T>
 inline T
 MathUtility::mises_stress(const std::vector<T>& _stress_vector)
 {
+  return mises_stress(_stress_vector.data());
+}
+
+/** Mises stress from a stress vector (xx,yy,zz,xy,yz,xz)
+ *
+ * @param _stress : pointer to the 6 stress components
+ */
+template<typename T>
+inline T
+MathUtility::mises_stress(const T* _stress)
+{
+
+  return std::sqrt(_stress[0] * _stress[0] + _stress[1] * _stress[1] +
+                   _stress[2] * _stress[2] - _stress[0] * _stress[1] -
+                   _stress[0] * _stress[2] - _stress[1] * _stress[2] +
+                   3 * (_stress[3] * _stress[3] + _stress[4] * _stress[4] +
+                        _stress[5] * _stress[5]));
+}
+
+/** Mises stress of many stress vectors (xx,yy,zz,xy,yz,xz)
+ *
+ * @param _stress : contiguous array of shape (nTensors x 6)
+ * @param _nTensors : number of stress vectors
+ * @param _mises : output array of size nTensors
+ *
+ * The loop has no branches, thus the compiler may vectorize it.
+ */
+template<typename T>
+void
+MathUtility::mises_stress(const T* _stress, size_t _nTensors, T* _mises)
+{
+  for (size_t iTensor = 0; iTensor < _nTensors; ++iTensor)
+    _mises[iTensor] = mises_stress(_stress + 6 * iTensor);
+}
 
-  return sqrt(_stress_vector[0] * _stress_vector[0] +
-              _stress_vector[1] * _stress_vector[1] +
-              _stress_vector[2] * _stress_vector[2] -
-              _stress_vector[0] * _stress_vector[1] -
-              _stress_vector[0] * _stress_vector[2] -
-              _stress_vector[1] * _stress_vector[2] +
-              3 * (_stress_vector[3] * _stress_vector[3] +
-                   _stress_vector[4] * _stress_vector[4] +
-                   _stress_vector[5] * _stress_vector[5]));
+/** Compute the stress invariants of many stress vectors (xx,yy,zz,xy,yz,xz)
+ *
+ * @param _stress : contiguous array of shape (nTensors x 6)
+ * @param _nTensors : number of stress vectors
+ * @param _invariants : output array of shape (nTensors x N_STRESS_INVARIANTS)
+ *
+ * The entries per stress vector are ordered as in StressInvariant:
+ * mises, pressure (positive in compression), triaxiality, the principal
+ * stresses in descending order and the lode parameter (normalized third
+ * deviatoric invariant, 1 in tension, -1 in compression). Triaxiality
+ * and lode parameter are 0 for a zero deviatoric stress.
+ */
+template<typename T>
+void
+MathUtility::stress_invariants(const T* _stress,
+                               size_t _nTensors,
+                               T* _invariants)
+{
+  const T third = static_cast<T>(1) / 3;
+  const T two_pi_thirds = static_cast<T>(2.0943951023931957);
+
+  for (size_t iTensor = 0; iTensor < _nTensors; ++iTensor) {
+    const T* stress = _stress + 6 * iTensor;
+    T* invariants = _invariants + N_STRESS_INVARIANTS * iTensor;
+
+    const T mean = (stress[0] + stress[1] + stress[2]) * third;
+    const T mises = mises_stress(stress);
+
+    // third invariant of the deviator
+    const T sxx = stress[0] - mean;
+    const T syy = stress[1] - mean;
+    const T szz = stress[2] - mean;
+    const T sxy = stress[3];
+    const T syz = stress[4];
+    const T sxz = stress[5];
+    const T j3 = sxx * (syy * szz - syz * syz) - sxy * (sxy * szz - syz * sxz) +
+                 sxz * (sxy * syz - syy * sxz);
+
+    const T mises_safe = mises > 0 ? mises : static_cast<T>(1);
+    const T has_mises = mises > 0 ? static_cast<T>(1) : static_cast<T>(0);
+    T lode = has_mises * static_cast<T>(13.5) * j3 /
+             (mises_safe * mises_safe * mises_safe);
+    lode = std::min(std::max(lode, static_cast<T>(-1)), static_cast<T>(1));
+
+    // principal stresses from the lode angle
+    const T angle = std::acos(lode) * third;
+    const T radius = 2 * mises * third;
+
+    invariants[MISES] = mises;
+    invariants[PRESSURE] = -mean;
+    invariants[TRIAXIALITY] = has_mises * mean / mises_safe;
+    invariants[PRINCIPAL_1] = mean + radius * std::cos(angle);
+    invariants[PRINCIPAL_2] = mean + radius * std::cos(angle - two_pi_thirds);
+    invariants[PRINCIPAL_3] = mean + radius * std::cos(angle + two_pi_thirds);
+    invariants[LODE_PARAMETER] = lode;
+  }
 }
 
 /** Converts negative indexes into positive ones python style
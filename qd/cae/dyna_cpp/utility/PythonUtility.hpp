@@ -18,9 +18,11 @@ extern "C"
 #include <stdexcept>
 #include <string>
 #include <type_traits>
+#include <typeinfo>
 #include <vector>
 
 #include <dyna_cpp/math/Tensor.hpp>
+#include <dyna_cpp/math/TensorView.hpp>
 
 // namespaces
 namespace qd {
@@ -216,41 +218,207 @@ vector_to_nparray(const std::vector<std::vector<T>>& _data)
  *
  * @param tensor
  * @return ret : numpy array
+ *
+ * Makes a copy in memory!
  */
 template<typename T>
 pybind11::array_t<T>
 tensor_to_nparray_copy(std::shared_ptr<qd::Tensor<T>> tensor)
 {
 
-  if (tensor.size() == 0) {
+  if (tensor->size() == 0) {
     return std::move(create_empty_array<T>(1));
   }
 
-  auto& data = tensor.get_data();
+  auto& data = tensor->get_data();
 
   pybind11::array_t<T, pybind11::array::c_style> ret;
-  ret.resize(tensor.get_shape());
+  ret.resize(tensor->get_shape());
   std::copy(data.begin(), data.end(), ret.mutable_data());
 
   // do the thing
   return ret;
 }
 
-/** Convert an internal tensor to numpy
+/** Name of the capsules holding a tensor, differs for every type
+ *
+ * @return name
+ */
+template<typename T>
+inline const char*
+tensor_capsule_name()
+{
+  return typeid(qd::Tensor<T>).name();
+}
+
+/** Create a python capsule, which keeps a tensor alive
  *
  * @param tensor
- * @return ret : numpy array
+ * @return capsule : owns a copy of the shared pointer
+ */
+template<typename T>
+pybind11::object
+tensor_to_capsule(std::shared_ptr<qd::Tensor<T>> tensor)
+{
+  auto holder = new std::shared_ptr<qd::Tensor<T>>(std::move(tensor));
+
+  auto capsule =
+    PyCapsule_New(holder, tensor_capsule_name<T>(), [](PyObject* obj) {
+      delete static_cast<std::shared_ptr<qd::Tensor<T>>*>(
+        PyCapsule_GetPointer(obj, tensor_capsule_name<T>()));
+    });
+  if (!capsule) {
+    delete holder;
+    throw pybind11::error_already_set();
+  }
+
+  return pybind11::reinterpret_steal<pybind11::object>(capsule);
+}
+
+/** Create a numpy array on the memory of a tensor
+ *
+ * @param tensor : owner of the memory
+ * @param data : pointer to the first entry
+ * @param shape : shape of the array
+ * @param strides : strides in number of entries
+ * @return ret : numpy array, its base keeps the tensor alive
+ */
+template<typename T>
+pybind11::array_t<T>
+tensor_memory_to_nparray(std::shared_ptr<qd::Tensor<T>> tensor,
+                         const T* data,
+                         const std::vector<size_t>& shape,
+                         std::vector<size_t> strides)
+{
+  for (auto& stride : strides)
+    stride *= sizeof(T);
+
+  // numpy would allocate and copy if there was no base
+  auto base = tensor_to_capsule(tensor);
+  return pybind11::array_t<T>(shape, strides, data, base);
+}
+
+/** Convert an internal tensor to numpy without copying
+ *
+ * @param tensor
+ * @return ret : numpy array sharing memory with the tensor
+ *
+ * The base object of the array is a capsule holding the tensor,
+ * thus the memory stays valid as long as the array lives.
  */
 template<typename T>
 inline pybind11::object
 tensor_to_nparray(std::shared_ptr<qd::Tensor<T>> tensor)
 {
-  auto tensor_py = pybind11::cast(tensor);
-  pybind11::array_t<T> ret(tensor_py);
+  if (tensor == nullptr)
+    throw(std::invalid_argument("Can not convert a null tensor to numpy."));
+
+  const auto& shape = tensor->get_shape();
+
+  std::vector<size_t> strides(shape.size());
+  size_t stride = 1;
+  for (size_t iDim = shape.size(); iDim > 0; --iDim) {
+    strides[iDim - 1] = stride;
+    stride *= shape[iDim - 1];
+  }
+
+  return tensor_memory_to_nparray<T>(
+    tensor, tensor->get_data().data(), shape, strides);
+}
 
+/** Convert an internal tensor to a read-only numpy array without copying
+ *
+ * @param tensor
+ * @return ret : read-only numpy array sharing memory with the tensor
+ *
+ * For tensors kept by the library, which every caller gets the same
+ * memory of. Writing into them would change the results for all.
+ */
+template<typename T>
+inline pybind11::object
+tensor_to_nparray_readonly(std::shared_ptr<qd::Tensor<T>> tensor)
+{
+  auto ret = tensor_to_nparray(tensor);
+  pybind11::detail::array_proxy(ret.ptr())->flags &=
+    ~pybind11::detail::npy_api::NPY_ARRAY_WRITEABLE_;
   return ret;
 }
 
+/** Convert a tensor view to numpy without copying
+ *
+ * @param view
+ * @return ret : numpy array sharing memory with the viewed tensor
+ */
+template<typename T>
+inline pybind11::object
+view_to_nparray(const qd::TensorView<T>& view)
+{
+  return tensor_memory_to_nparray<T>(
+    view.get_owner(), view.data(), view.get_shape(), view.get_strides());
+}
+
+/** Find the tensor owning the memory of a numpy array
+ *
+ * @param array
+ * @return tensor : owner or nullptr if the array has foreign memory
+ *
+ * Only arrays covering the entire tensor in its original shape
+ * are considered, since the tensor is shared as is.
+ */
+template<typename T>
+std::shared_ptr<qd::Tensor<T>>
+nparray_find_tensor(const pybind11::array_t<T, pybind11::array::c_style>& array)
+{
+  // walk down the base objects until we hit a tensor capsule
+  PyObject* base = pybind11::detail::array_proxy(array.ptr())->base;
+  while (base != nullptr &&
+         pybind11::detail::npy_api::get().PyArray_Check_(base))
+    base = pybind11::detail::array_proxy(base)->base;
+
+  if (base == nullptr || !PyCapsule_IsValid(base, tensor_capsule_name<T>()))
+    return nullptr;
+
+  auto tensor = *static_cast<std::shared_ptr<qd::Tensor<T>>*>(
+    PyCapsule_GetPointer(base, tensor_capsule_name<T>()));
+
+  const auto& shape = tensor->get_shape();
+  if (array.data() != tensor->get_data().data() ||
+      static_cast<size_t>(array.ndim()) != shape.size())
+    return nullptr;
+  for (size_t iDim = 0; iDim < shape.size(); ++iDim)
+    if (static_cast<size_t>(array.shape(iDim)) != shape[iDim])
+      return nullptr;
+
+  return tensor;
+}
+
+/** Convert a numpy array into a tensor
+ *
+ * @param array : c-contiguous array
+ * @return tensor
+ *
+ * If the array memory belongs to a tensor (e.g. from tensor_to_nparray)
+ * the tensor is adopted without copying. Memory allocated by numpy
+ * is copied once, since tensors own their buffer.
+ */
+template<typename T>
+std::shared_ptr<qd::Tensor<T>>
+nparray_to_tensor(const pybind11::array_t<T, pybind11::array::c_style>& array)
+{
+  auto tensor = nparray_find_tensor<T>(array);
+  if (tensor != nullptr)
+    return tensor;
+
+  std::vector<size_t> shape(array.ndim());
+  for (size_t iDim = 0; iDim < shape.size(); ++iDim)
+    shape[iDim] = static_cast<size_t>(array.shape(iDim));
+
+  const T* data = array.data();
+
+  pybind11::gil_scoped_release release;
+  return std::make_shared<qd::Tensor<T>>(shape, data);
+}
+
 // template<typename T>
 // inline pybind11::array
 // tensor_to_nparray(std::shared_ptr<qd::Tensor<T>> tensor)
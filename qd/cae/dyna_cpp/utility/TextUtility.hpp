@@ -182,6 +182,39 @@ to_lower_copy(std::string _txt)
   return std::move(_txt);
 }
 
+/** Convert a string to upper-case (creates copy)
+ *
+ * @param _txt
+ */
+inline std::string
+to_upper_copy(std::string _txt)
+{
+  std::transform(_txt.begin(), _txt.end(), _txt.begin(), ::toupper);
+  return std::move(_txt);
+}
+
+/** Check case-insensitively if a string contains a prefix at an offset
+ *
+ * @param _str string to check
+ * @param _offset char index in the string where the prefix starts
+ * @param _prefix_lower prefix in lower-case
+ * @return is_match
+ *
+ * Does not allocate, in contrast to comparing with to_lower_copy.
+ */
+inline bool
+starts_with_icase(const std::string& _str,
+                  size_t _offset,
+                  const char* _prefix_lower)
+{
+  for (; *_prefix_lower != '\0'; ++_prefix_lower, ++_offset)
+    if (_offset >= _str.size() ||
+        std::tolower(static_cast<unsigned char>(_str[_offset])) !=
+          *_prefix_lower)
+      return false;
+  return true;
+}
+
 /** Convert string into some type
  * @param T value : value to convert to string
  * @return string result
@@ -282,6 +315,43 @@ ends_with(std::string const& value, std::string const& ending)
   return std::equal(ending.rbegin(), ending.rend(), value.rbegin());
 }
 
+/** Check if a string matches a wildcard pattern
+ *
+ * @param _str string to check
+ * @param _pattern pattern with '*' (any chars) and '?' (one char)
+ * @return is_match
+ */
+inline bool
+glob_match(const std::string& _str, const std::string& _pattern)
+{
+  size_t iStr = 0;
+  size_t iPattern = 0;
+  size_t iStar = std::string::npos;
+  size_t iStarStr = 0;
+
+  while (iStr < _str.size()) {
+    if (iPattern < _pattern.size() &&
+        (_pattern[iPattern] == '?' || _pattern[iPattern] == _str[iStr])) {
+      ++iStr;
+      ++iPattern;
+    } else if (iPattern < _pattern.size() && _pattern[iPattern] == '*') {
+      iStar = iPattern++;
+      iStarStr = iStr;
+    } else if (iStar != std::string::npos) {
+      // backtrack: let the last star eat one more char
+      iPattern = iStar + 1;
+      iStr = ++iStarStr;
+    } else {
+      return false;
+    }
+  }
+
+  while (iPattern < _pattern.size() && _pattern[iPattern] == '*')
+    ++iPattern;
+
+  return iPattern == _pattern.size();
+}
+
 /** Get a word from a string
  *
  * @param _begin begin iterator
@@ -3,6 +3,7 @@
 import glob
 import os
 import platform
+import re
 import unittest
 
 import numpy as np
@@ -18,6 +19,9 @@ except ImportError:
 # ======= S E T T I N G S ======= #
 femzip_path_windows = "libs/femzip/FEMZIP_10.68_dyna_NO_OMP_Windows_VS2015_mt_x64"  # optional
 femzip_path_linux = "libs/femzip/Linux_10.86"  # optional.
+hdf5_path_windows = "libs/hdf5/windows"  # optional
+hdf5_include_dirs_linux = ["/usr/include/hdf5/serial",
+                           "/usr/include"]  # optional
 # ====== D E V E L O P E R ====== #
 debugging_mode = False
 measure_time = False
@@ -62,6 +66,7 @@ def setup_dyna_cpp():
         "qd/cae/dyna_cpp/dyna/keyfile/PartKeyword.cpp",
         "qd/cae/dyna_cpp/dyna/keyfile/IncludeKeyword.cpp",
         "qd/cae/dyna_cpp/dyna/keyfile/IncludePathKeyword.cpp",
+        "qd/cae/dyna_cpp/utility/BufferedWriter.cpp",
         "qd/cae/dyna_cpp/utility/FileUtility.cpp",
         "qd/cae/dyna_cpp/utility/TextUtility.cpp",
         # "qd/cae/dyna_cpp/parallel/WorkQueue.cpp",
@@ -202,25 +207,74 @@ def setup_dyna_cpp_femzip(srcs, lib_dirs, libs, compiler_args):
     return srcs, lib_dirs, libs, compiler_args
 
 
+def get_hdf5_version(include_dir):
+    ''' Reads the version of an HDF5 installation
+
+    Returns
+    -------
+    version : tuple of int
+        (major, minor, release) or None if no HDF5 headers were found
+    '''
+
+    filepath = os.path.join(include_dir, "H5pubconf.h")
+    if not os.path.isfile(filepath):
+        return None
+
+    with open(filepath, "r") as fp:
+        match = re.search(r'#define H5_VERSION "(\d+)\.(\d+)\.(\d+)',
+                          fp.read())
+    if match is None:
+        return None
+
+    return tuple(int(entry) for entry in match.groups())
+
+
 def setup_dyna_cpp_hdf5(srcs, compiler_args, libs, lib_dirs, include_dirs):
-    ''' Sets up the hdf5 compilation
+    ''' Sets up the hdf5 compilation, iff the hdf5 library is present
+
+    The binout export writes compressed chunks directly, which
+    requires HDF5 1.10.2 or newer.
     '''
 
+    if is_linux:
+        include_dir = next((entry for entry in hdf5_include_dirs_linux
+                            if os.path.isfile(os.path.join(entry, "H5Cpp.h"))),
+                           None)
+    elif is_windows:
+        include_dir = os.path.join(hdf5_path_windows, "include")
+
+    version = get_hdf5_version(include_dir) if include_dir else None
+    if version is None:
+        print("HDF5 library not found. Compiling without HDF5.")
+        return srcs, compiler_args, libs, lib_dirs, include_dirs
+    if version < (1, 10, 2):
+        print("HDF5 %d.%d.%d is older than 1.10.2. Compiling without HDF5."
+              % version)
+        return srcs, compiler_args, libs, lib_dirs, include_dirs
+
     srcs.append("qd/cae/dyna_cpp/utility/HDF5_Utility.cpp")
+    # compression threads of the binout export
+    srcs.append("qd/cae/dyna_cpp/parallel/WorkQueue.cpp")
+    include_dirs.append(include_dir)
 
     if is_linux:
+        # debian names the serial build differently
+        if "serial" in include_dir:
+            libs += ["hdf5_serial_cpp", "hdf5_serial"]
+        else:
+            libs += ["hdf5_cpp", "hdf5"]
+        libs += ["z", "pthread"]
         compiler_args.append("-DQD_USE_HDF5")
-        raise RuntimeError("Linux HDF5 compilation missing.")
 
     if is_windows:
 
+        # the hdf5 distribution ships its own zlib (libzlib.lib)
         import ntpath
-        files = glob.glob("libs/hdf5/windows/lib/lib*.lib")
+        files = glob.glob(os.path.join(hdf5_path_windows, "lib", "lib*.lib"))
         files = [ntpath.basename(entry).replace(".lib", "") for entry in files]
         libs += files
 
-        lib_dirs.append("libs/hdf5/windows/lib")
-        include_dirs.append("libs/hdf5/windows/include")
+        lib_dirs.append(os.path.join(hdf5_path_windows, "lib"))
         compiler_args.append("/DQD_USE_HDF5")
 
     return srcs, compiler_args, libs, lib_dirs, include_dirs
@@ -265,12 +319,11 @@ if __name__ == "__main__":
     srcs_dyna, include_dirs_dyna, compiler_args_dyna, extra_link_args, libs_dyna = setup_dyna_cpp()
 
     # compile binout
-    # srcs_dyna, compiler_args_dyna = setup_dyna_cpp_binout(
-    #     srcs_dyna, compiler_args_dyna)
+    srcs_dyna, compiler_args_dyna = setup_dyna_cpp_binout(
+        srcs_dyna, compiler_args_dyna)
 
-    # setup hdf5
+    # setup hdf5 (if possible)
     # (MUST be before femzip, due to linking)
-    '''
     srcs_dyna, \
     compiler_args_dyna, \
     libs_dyna, \
@@ -280,7 +333,6 @@ if __name__ == "__main__":
                                             libs_dyna,
                                             lib_dirs_dyna,
                                             include_dirs_dyna)
-    '''
 
     # setup femzip (if possible)
     srcs_dyna, lib_dirs_dyna, libs_dyna, compiler_args_dyna = setup_dyna_cpp_femzip(
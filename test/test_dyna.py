@@ -198,6 +198,42 @@ class TestDynaModule(unittest.TestCase):
         self.assertEqual(d3plot.get_element_history_vars(
             Element.tshell).shape, (0, 1, 0))
 
+        # element results by id, index and part
+        elem_ids = [1, 2, 5]
+        elems = d3plot.get_elementByID(Element.shell, elem_ids)
+        plastic_strain = d3plot.get_element_resultsByID(
+            "plastic_strain", Element.shell, elem_ids)
+        self.assertEqual(plastic_strain.shape, (3, 1))
+        np.testing.assert_array_equal(
+            plastic_strain[:, 0], [elem.get_plastic_strain()[0] for elem in elems])
+        stress = d3plot.get_element_resultsByID(
+            "stress", Element.shell, elem_ids, [-1])
+        self.assertEqual(stress.shape, (3, 1, 6))
+        np.testing.assert_array_equal(
+            stress[:, 0], [elem.get_stress()[-1] for elem in elems])
+        # vector results stay 3D with a single or no component
+        self.assertEqual(d3plot.get_element_resultsByID(
+            "history_vars", Element.shell, elem_ids).shape, (3, 1, 1))
+        self.assertEqual(d3plot.get_element_resultsByID(
+            "history_vars", Element.beam, []).shape, (0, 1, 0))
+        self.assertEqual(d3plot.get_element_resultsByIndex(
+            "stress_mises", Element.shell, [0, 1]).shape, (2, 1))
+        self.assertEqual(part.get_element_results(
+            "strain", Element.shell).shape, (4696, 1, 6))
+        self.assertEqual(part.get_element_results(
+            "energy", Element.shell, [0]).shape, (4696, 1))
+        with self.assertRaises(ValueError):
+            d3plot.get_element_resultsByID("stress", Element.shell, elem_ids, [1])
+        with self.assertRaises(ValueError):
+            d3plot.get_element_resultsByID("disp", Element.shell, elem_ids)
+        invariants = d3plot.get_element_stress_invariants(Element.shell)
+        self.assertEqual(invariants.shape, (4696, 1, 7))
+        np.testing.assert_array_equal(
+            d3plot.get_element_stress_invariants(Element.shell, [-1]),
+            invariants)
+        self.assertEqual(
+            d3plot.get_element_stress_invariants(Element.beam).shape, (0, 1, 7))
+
         # D3plot error handling
         # ... TODO
 
@@ -303,6 +339,275 @@ class TestDynaModule(unittest.TestCase):
                 os.remove(export_path)
         '''
 
+    def test_tensor_view(self):
+
+        d3plot = D3plot("test/d3plot", read_states="stress")
+        stress = d3plot.get_element_stress()
+        view = TensorView_f32(stress)
+        self.assertEqual(view.shape(), [4696, 1, 6])
+        self.assertTrue(view.is_contiguous())
+
+        # select removes the axis
+        state = view.select(1, 0)
+        self.assertEqual(state.shape(), [4696, 6])
+        np.testing.assert_array_equal(np.asarray(state), stress[:, 0])
+
+        # slice keeps the memory
+        sliced = state.slice(0, 10, 100, 3)
+        self.assertEqual(sliced.shape(), [30, 6])
+        self.assertFalse(sliced.is_contiguous())
+        np.testing.assert_array_equal(
+            np.asarray(sliced), stress[10:100:3, 0])
+        self.assertTrue(np.shares_memory(np.asarray(sliced), stress))
+        self.assertEqual(state.slice(0, 10, 5).shape(), [0, 6])
+
+        # inserted axes broadcast with stride 0
+        broadcast = sliced.insert_axis(1)
+        self.assertEqual(broadcast.shape(), [30, 1, 6])
+        self.assertEqual(broadcast.strides()[1], 0)
+        np.testing.assert_array_equal(
+            np.asarray(broadcast), stress[10:100:3, 0][:, None])
+        np.testing.assert_array_equal(
+            np.asarray(broadcast.copy()), stress[10:100:3, 0][:, None])
+
+        # reductions are computed from the strided memory directly
+        for axis in range(3):
+            np.testing.assert_allclose(
+                view.sum(axis), stress.sum(axis=axis), rtol=1e-5, atol=1e-3)
+            np.testing.assert_allclose(
+                view.mean(axis), stress.mean(axis=axis), rtol=1e-5, atol=1e-3)
+            np.testing.assert_array_equal(
+                view.max(axis), stress.max(axis=axis))
+            np.testing.assert_array_equal(
+                view.min(axis), stress.min(axis=axis))
+        np.testing.assert_array_equal(
+            sliced.max(0), stress[10:100:3, 0].max(axis=0))
+        np.testing.assert_array_equal(
+            broadcast.sum(1), stress[10:100:3, 0])
+        with self.assertRaises(ValueError):
+            view.sum(3)
+        with self.assertRaises(ValueError):
+            state.slice(0, 10, 5).max(0)
+
+        # error handling
+        with self.assertRaises(ValueError):
+            view.select(3, 0)
+        with self.assertRaises(ValueError):
+            view.select(1, 1)
+        with self.assertRaises(ValueError):
+            view.slice(0, 0, 1, 0)
+        with self.assertRaises(ValueError):
+            view.insert_axis(4)
+
+    def test_shell_layer_modes(self):
+
+        d3plot_filepath = "test/d3plot"
+
+        # raw layers (nTimesteps x nShells x nLayers x nLayerVars)
+        layers = D3plot(d3plot_filepath,
+                        read_states="shell_layers").get_shell_layer_results()
+        self.assertEqual(layers.shape, (1, 4696, 3, 26))
+        # stresses and plastic strain as (nShells x nTimesteps x nLayers x 7)
+        layers = np.transpose(layers[:, :, :, :7], (1, 0, 2, 3))
+        n_layers = layers.shape[2]
+
+        expected_by_mode = {
+            "inner": layers[:, :, 0],
+            "mid": (layers[:, :, (n_layers - 1) // 2] +
+                    layers[:, :, n_layers // 2]) / 2,
+            "outer": layers[:, :, -1],
+            "max": layers.max(axis=2),
+            "min": layers.min(axis=2),
+            "mean": layers.mean(axis=2),
+        }
+
+        for mode, expected in expected_by_mode.items():
+            d3plot = D3plot(d3plot_filepath,
+                            read_states=["stress " + mode,
+                                         "plastic_strain " + mode])
+            np.testing.assert_allclose(
+                d3plot.get_element_stress(Element.shell),
+                expected[:, :, :6], rtol=1e-5, atol=1e-6)
+            np.testing.assert_allclose(
+                d3plot.get_element_plastic_strain(Element.shell),
+                expected[:, :, 6], rtol=1e-5, atol=1e-6)
+
+    def test_result_envelopes(self):
+
+        d3plot_filepath = "test/d3plot"
+        d3plot = D3plot(d3plot_filepath,
+                        read_states=["stress_mises", "stress", "vel"])
+        d3plot_envelope = D3plot(d3plot_filepath,
+                                 read_states=["stress_mises envelope",
+                                              "stress envelope",
+                                              "vel envelope"])
+
+        # element envelopes match the reduced history
+        histories = {
+            "stress_mises": d3plot.get_element_stress_mises(Element.shell)[:, :, None],
+            "stress": d3plot.get_element_stress(Element.shell),
+        }
+        for result_name, history in histories.items():
+            envelope = d3plot.get_element_result_envelope(
+                result_name, Element.shell)
+            np.testing.assert_array_equal(
+                envelope.get_max(), history.max(axis=1))
+            np.testing.assert_array_equal(
+                envelope.get_min(), history.min(axis=1))
+            np.testing.assert_array_equal(
+                envelope.get_max_state(), history.argmax(axis=1))
+            np.testing.assert_array_equal(
+                envelope.get_min_state(), history.argmin(axis=1))
+
+            # reducing during reading gives the same
+            read_envelope = d3plot_envelope.get_result_envelope(
+                result_name, Element.shell)
+            np.testing.assert_array_equal(
+                read_envelope.get_max(), envelope.get_max())
+            np.testing.assert_array_equal(
+                read_envelope.get_min_state(), envelope.get_min_state())
+
+        # node envelopes reduce the vector length
+        vel_history = np.linalg.norm(d3plot.get_node_velocity(), axis=2)
+        envelope = d3plot.get_node_result_envelope("vel")
+        self.assertEqual(envelope.get_max().shape, (4915, 1))
+        np.testing.assert_allclose(
+            envelope.get_max()[:, 0], vel_history.max(axis=1), rtol=1e-6)
+        np.testing.assert_allclose(
+            d3plot_envelope.get_result_envelope("vel").get_max(),
+            envelope.get_max(), rtol=1e-6)
+
+        # the history of envelope results is not stored
+        self.assertEqual(
+            len(d3plot_envelope.get_elementByID(Element.shell, 1).get_stress()), 0)
+        self.assertEqual(d3plot.get_element_result_envelope(
+            "stress", Element.beam).get_max().shape[0], 0)
+        with self.assertRaises(ValueError):
+            d3plot.get_result_envelope("stress", Element.shell)
+
+    def test_node_coords_block(self):
+
+        d3plot_filepath = "test/d3plot"
+
+        d3plot = D3plot(d3plot_filepath, read_states="coords")
+        d3plot_disp = D3plot(d3plot_filepath, read_states="disp")
+
+        # the block matches position + displacement up to rounding
+        coords = d3plot.get_node_coords()
+        self.assertEqual(coords.shape, (4915, 1, 3))
+        np.testing.assert_allclose(
+            coords, d3plot_disp.get_node_coords(), rtol=0, atol=7.6e-6)
+
+        # the nodes do not receive anything from the block
+        node = d3plot.get_nodeByID(1)
+        self.assertEqual(len(node.get_disp()), 0)
+        self.assertEqual(node.get_coords().shape, (1, 3))
+
+        # state subsets, also repeated ones
+        np.testing.assert_array_equal(
+            d3plot.get_node_coords(states=[0]), coords)
+        np.testing.assert_array_equal(
+            d3plot.get_node_coords(states=[0, 0]),
+            np.concatenate([coords, coords], axis=1))
+        np.testing.assert_array_equal(
+            d3plot_disp.get_node_coords(states=[0, 0]),
+            np.concatenate([d3plot_disp.get_node_coords()] * 2, axis=1))
+
+        # states out of range
+        for d3plot_ in (d3plot, d3plot_disp):
+            with self.assertRaises(ValueError):
+                d3plot_.get_node_coords(states=[1])
+
+    def test_compact_precisions(self):
+
+        d3plot_filepath = "test/d3plot"
+
+        coords = D3plot(d3plot_filepath,
+                        read_states="coords").get_node_coords()
+        self.assertEqual(coords.shape, (4915, 1, 3))
+        np.testing.assert_array_equal(
+            D3plot(d3plot_filepath,
+                   read_states="coords float32").get_node_coords(),
+            coords)
+
+        # half floats are off by at most half a unit in the last place
+        np.testing.assert_allclose(
+            D3plot(d3plot_filepath,
+                   read_states="coords float16").get_node_coords(),
+            coords, rtol=2.**-11, atol=1e-7)
+
+        # fixed-point values are off by at most half a step, the step
+        # being the range of an axis in a state divided by the int range
+        value_range = coords.max(axis=0) - coords.min(axis=0)
+        for precision, max_int in (("int16", 32767), ("int8", 127)):
+            compact = D3plot(d3plot_filepath,
+                             read_states="coords " + precision).get_node_coords()
+            self.assertEqual(compact.shape, coords.shape)
+            max_error = np.abs(compact - coords).max(axis=0)
+            self.assertTrue(
+                np.all(max_error <= 0.501 * value_range / (2 * max_int) + 1e-5))
+
+        # raw shell layers, scaled per state and layer variable
+        layers = D3plot(d3plot_filepath,
+                        read_states="shell_layers").get_shell_layer_results()
+        np.testing.assert_allclose(
+            D3plot(d3plot_filepath,
+                   read_states="shell_layers float16").get_shell_layer_results(),
+            layers, rtol=2.**-11, atol=1e-7)
+        value_range = layers.max(axis=(1, 2)) - layers.min(axis=(1, 2))
+        for precision, max_int in (("int16", 32767), ("int8", 127)):
+            compact = D3plot(d3plot_filepath,
+                             read_states="shell_layers " + precision)
+            max_error = np.abs(
+                compact.get_shell_layer_results() - layers).max(axis=(1, 2))
+            self.assertTrue(
+                np.all(max_error <= 0.501 * value_range / (2 * max_int) + 1e-5))
+
+        # typos in the precision are errors
+        for variable in ("shell_layers float8",
+                         "coords int4",
+                         "shell_layers int8 int16"):
+            with self.assertRaises(ValueError):
+                D3plot(d3plot_filepath, read_states=variable)
+
+        # a model without shells has empty layers in every precision
+        for precision in ("float32", "float16", "int16", "int8"):
+            d3plot = D3plot("test/d3plot_solid/d3plot",
+                            read_states=["shell_layers " + precision,
+                                         "coords " + precision])
+            self.assertEqual(
+                d3plot.get_shell_layer_results().shape, (2, 0, 3, 7))
+            self.assertEqual(d3plot.get_node_coords().shape, (8, 2, 3))
+
+    def test_readonly_results(self):
+
+        d3plot = D3plot("test/d3plot",
+                        read_states=["shell_layers", "stress_mises"])
+
+        # arrays sharing memory with the file can not be written
+        layers = d3plot.get_shell_layer_results()
+        self.assertFalse(layers.flags.writeable)
+        with self.assertRaises(ValueError):
+            layers[0] = 1.
+
+        envelope = d3plot.get_element_result_envelope(
+            "stress_mises", Element.shell)
+        for array in (envelope.get_max(),
+                      envelope.get_min(),
+                      envelope.get_max_state(),
+                      envelope.get_min_state()):
+            self.assertFalse(array.flags.writeable)
+            with self.assertRaises(ValueError):
+                array[0] = 0
+
+        # copies are writable and leave the original untouched
+        max_values = np.array(envelope.get_max())
+        max_values[:] = -1.
+        self.assertTrue(np.all(envelope.get_max() != -1.))
+
+        # freshly computed results stay writable
+        self.assertTrue(d3plot.get_element_stress_mises().flags.writeable)
+
     def test_binout(self):
 
         binout_filepath = "test/binout"
@@ -338,6 +643,107 @@ class TestDynaModule(unittest.TestCase):
         self.assertTrue(os.path.isfile("./binout.h5"))
         os.remove("./binout.h5")
 
+    def test_binout_cpp(self):
+
+        binout_filepath = "test/binout"
+        nTimesteps = 321
+        binout_py = Binout(binout_filepath)
+
+        for use_index in (False, True):
+            binout = QD_Binout(binout_filepath, use_index=use_index)
+
+            # directories
+            self.assertEqual(binout.get_children("/"), ["swforc"])
+            self.assertEqual(len(binout.get_children("/swforc")), nTimesteps + 1)
+            self.assertCountEqual(binout.get_children("/swforc/d000001"),
+                                  ['axial', 'failure', 'failure_time', 'length',
+                                   'resultant_moment', 'shear', 'time'])
+            self.assertTrue(binout.has_children("/swforc"))
+            self.assertTrue(binout.is_variable("/swforc/metadata/ids"))
+            self.assertFalse(binout.exists("/swforc/d999999/axial"))
+
+            # single variables
+            ids = binout.read_variable("/swforc/metadata/ids")
+            np.testing.assert_array_equal(ids, binout_py.read("swforc", "ids"))
+            with self.assertRaises(ValueError):
+                binout.read_variable("/swforc/metadata")
+
+            # reading into a buffer with conversion
+            buffer = np.zeros(len(ids) + 2, dtype=np.float32)
+            self.assertEqual(binout.read_variable_into(
+                "/swforc/metadata/ids", buffer), len(ids))
+            np.testing.assert_array_equal(buffer[:len(ids)], ids)
+            with self.assertRaises(ValueError):
+                binout.read_variable_into("/swforc/metadata/ids",
+                                          np.zeros(1, dtype=np.float32))
+
+            # series over all states
+            self.assertEqual(len(binout.get_series_paths("/swforc/d*/axial")),
+                             nTimesteps)
+            axial = binout.read_variable_series("/swforc/d*/axial")
+            np.testing.assert_array_almost_equal(
+                axial, binout_py.read("swforc", "axial"))
+            time = binout.read_variable_series("/swforc/d*/time")
+            self.assertEqual(time.shape, (nTimesteps, 1))
+            np.testing.assert_array_almost_equal(
+                time[:, 0], binout_py.read("swforc", "time"))
+
+            # series of selected entities
+            axial_sub = binout.read_variable_series(
+                "/swforc/d*/axial", ids=[ids[2], ids[0]])
+            np.testing.assert_array_equal(axial_sub, axial[:, [2, 0]])
+            with self.assertRaises(ValueError):
+                binout.read_variable_series("/swforc/d*/axial", ids=[123456])
+            with self.assertRaises(ValueError):
+                binout.read_variable_series("/swforc/axial")
+            with self.assertRaises(ValueError):
+                binout.read_variable_series("/swforc/x*/axial")
+
+            # series read by several threads at once
+            import threading
+            results = [None] * 4
+
+            def read_series(iThread):
+                if iThread % 2:
+                    results[iThread] = binout.read_variable_series(
+                        "/swforc/d*/axial", ids=[ids[2], ids[0]])
+                else:
+                    results[iThread] = binout.read_variable_series(
+                        "/swforc/d*/axial")
+
+            threads = [threading.Thread(target=read_series, args=(iThread,))
+                       for iThread in range(len(results))]
+            for thread in threads:
+                thread.start()
+            for thread in threads:
+                thread.join()
+            for iThread, result in enumerate(results):
+                np.testing.assert_array_equal(
+                    result, axial_sub if iThread % 2 else axial)
+
+            del binout
+
+        # native hdf5 export (only if compiled with hdf5)
+        if hasattr(QD_Binout, "save_hdf5"):
+            import h5py
+            binout = QD_Binout(binout_filepath)
+            binout_py.save_hdf5("./binout_cpp.h5", native=True)
+            with h5py.File("./binout_cpp.h5", "r") as fh:
+                np.testing.assert_array_equal(
+                    fh["swforc/axial"][:],
+                    binout.read_variable_series("/swforc/d*/axial"))
+                np.testing.assert_array_equal(
+                    fh["swforc/metadata/ids"][:],
+                    binout.read_variable("/swforc/metadata/ids"))
+            os.remove("./binout_cpp.h5")
+            with self.assertRaises(ValueError):
+                binout_py.save_hdf5("./binout_cpp.h5", compression="lzf",
+                                    native=True)
+            del binout
+
+        self.assertTrue(os.path.isfile(binout_filepath + ".qdidx"))
+        os.remove(binout_filepath + ".qdidx")
+
     def test_keyfile(self):
 
         # test encryption detection
@@ -380,6 +786,31 @@ class TestDynaModule(unittest.TestCase):
         self.assertEqual(len(kf.get_includes()), 0)
         self.assertEqual(kf.get_nNodes(), 0)
 
+        # keyword search
+        kf = KeyFile("test/keyfile.key", load_includes=True)
+        kwrds = kf.find_keywords_by_prefix("*ELEMENT")
+        self.assertEqual([kw.get_keyword_name() for kw in kwrds],
+                         ["*ELEMENT_BEAM_SCALAR", "*ELEMENT_SHELL"])
+        self.assertEqual(len(kf.find_keywords_by_prefix("*element_")), 2)
+        self.assertEqual(len(kf.find_keywords_by_prefix("*Part")), 1)
+        self.assertEqual(len(kf.find_keywords_by_prefix("*NODEX")), 0)
+        self.assertEqual(len(kf.find_keywords("*element_shel?")), 1)
+        self.assertEqual(len(kf.find_keywords("*control*")), 1)
+        self.assertEqual(len(kf.find_keywords_by_prefix(
+            "*NODE", search_includes=False)), 1)
+        self.assertEqual(len(kf.find_keywords_by_prefix("*NODE")), 3)
+
+        # keyword search after adding and removing keywords
+        kf.add_keyword("*Mat_Elastic")
+        kf.add_keyword("*MAT_ELASTIC")
+        self.assertEqual(len(kf.find_keywords_by_prefix("*mat_")), 2)
+        self.assertEqual(len(kf.find_keywords("*MAT_*")), 2)
+        kf.remove_keyword("*Mat_Elastic")
+        self.assertEqual(len(kf.find_keywords_by_prefix("*MAT")), 1)
+        kf.remove_keyword("*MAT_ELASTIC", 0)
+        self.assertEqual(len(kf.find_keywords_by_prefix("*MAT")), 0)
+        self.assertEqual(len(kf.find_keywords_by_prefix("*ELEMENT")), 2)
+
         with self.assertRaises(ValueError):
             KeyFile("test/invalid.key")
         with self.assertRaises(ValueError):
@@ -402,6 +833,24 @@ class TestDynaModule(unittest.TestCase):
             "test/keyfile_include2.key", "test/tmp.key"))
         os.remove("test/tmp.key")
 
+        # incremental saving of mesh edits
+        kf = KeyFile("test/keyfile.key", read_keywords=True,
+                     parse_mesh=True, load_includes=True)
+        self.assertFalse(kf.is_modified())
+        kf.get_nodeByID(4).set_coords(2., 3., 4.)
+        kf.get_partByID(1).set_name("Iam moved")
+        self.assertTrue(kf.is_modified())
+        kf.save_incremental("test/tmp.key", save_includes=False)
+        self.assertFalse(kf.is_modified())
+        kf2 = KeyFile("test/tmp.key", read_keywords=True,
+                      parse_mesh=True, load_includes=True)
+        self.assertCountEqual(kf2.get_nodeByID(
+            4).get_coords()[0], (2., 3., 4.))
+        self.assertCountEqual(kf2.get_nodeByID(
+            5).get_coords()[0], (1., 0., 0.))
+        self.assertEqual(kf2.get_partByID(1).get_name(), "Iam moved")
+        os.remove("test/tmp.key")
+
         # Generic Keywords
         kf = KeyFile("test/keyfile.key")
         kwrds = kf["*PART"]